@@ -166,6 +166,7 @@ static int restore_tty;
 
 #if HAVE_THREADS
 static void free_input_threads(void);
+static void free_mux_threads(void);
 #endif
 
 /* sub2video hack:
@@ -543,6 +544,10 @@ static void ffmpeg_cleanup(int ret)
 
     av_freep(&subtitle_out);
 
+#if HAVE_THREADS
+    free_mux_threads();
+#endif
+
     /* close files */
     for (i = 0; i < nb_output_files; i++) {
         OutputFile *of = output_files[i];
@@ -698,6 +703,104 @@ static void close_all_output_streams(OutputStream *ost, OSTFinished this_stream,
     }
 }
 
+#if HAVE_THREADS
+static void *mux_thread(void *arg)
+{
+    OutputFile *of = arg;
+    AVPacket pkt;
+    int ret;
+
+    while (av_thread_message_queue_recv(of->mux_queue, &pkt, 0) >= 0) {
+        ret = av_interleaved_write_frame(of->ctx, &pkt);
+        av_packet_unref(&pkt);
+        atomic_store(&of->mux_size, of->ctx->pb ? avio_tell(of->ctx->pb) : 0);
+        if (ret < 0) {
+            print_error("av_interleaved_write_frame()", ret);
+            of->mux_ret = ret;
+            av_thread_message_queue_set_err_send(of->mux_queue, ret);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void free_mux_thread(int i)
+{
+    OutputFile *of = output_files[i];
+    AVPacket pkt;
+
+    if (!of || !of->mux_queue)
+        return;
+    /* let the thread write out everything queued so far, then stop it */
+    av_thread_message_queue_set_err_recv(of->mux_queue, AVERROR_EOF);
+    pthread_join(of->thread, NULL);
+    while (av_thread_message_queue_recv(of->mux_queue, &pkt,
+                                        AV_THREAD_MESSAGE_NONBLOCK) >= 0)
+        av_packet_unref(&pkt);
+    av_thread_message_queue_free(&of->mux_queue);
+
+    if (of->mux_ret < 0)
+        main_return_code = 1;
+}
+
+static void free_mux_threads(void)
+{
+    int i;
+
+    for (i = 0; i < nb_output_files; i++)
+        free_mux_thread(i);
+}
+
+static int init_mux_thread(OutputFile *of)
+{
+    int ret;
+
+    /* with a single output there is nothing for the main loop to do
+     * while the muxer is busy, so keep writing synchronously */
+    if (nb_output_files == 1)
+        return 0;
+
+    atomic_init(&of->mux_size, of->ctx->pb ? avio_tell(of->ctx->pb) : 0);
+    ret = av_thread_message_queue_alloc(&of->mux_queue,
+                                        of->thread_queue_size, sizeof(AVPacket));
+    if (ret < 0)
+        return ret;
+
+    if ((ret = pthread_create(&of->thread, NULL, mux_thread, of))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        av_thread_message_queue_free(&of->mux_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+static int write_packet_mux_thread(OutputFile *of, AVPacket *pkt)
+{
+    AVPacket tmp_pkt;
+    int ret;
+
+    ret = av_packet_make_refcounted(pkt);
+    if (ret < 0)
+        return ret;
+    av_packet_move_ref(&tmp_pkt, pkt);
+    ret = av_thread_message_queue_send(of->mux_queue, &tmp_pkt, 0);
+    if (ret < 0)
+        av_packet_unref(&tmp_pkt);
+    return ret;
+}
+#endif
+
+static int64_t output_file_tell(OutputFile *of)
+{
+#if HAVE_THREADS
+    if (of->mux_queue)
+        return atomic_load(&of->mux_size);
+#endif
+    return avio_tell(of->ctx->pb);
+}
+
 static void write_packet(OutputFile *of, AVPacket *pkt, OutputStream *ost, int unqueue)
 {
     AVFormatContext *s = of->ctx;
@@ -826,6 +929,19 @@ static void write_packet(OutputFile *of, AVPacket *pkt, OutputStream *ost, int u
               );
     }
 
+#if HAVE_THREADS
+    if (of->mux_queue) {
+        /* errors are reported by the muxing thread itself */
+        ret = write_packet_mux_thread(of, pkt);
+        if (ret < 0) {
+            main_return_code = 1;
+            close_all_output_streams(ost, MUXER_FINISHED | ENCODER_FINISHED, ENCODER_FINISHED);
+        }
+        av_packet_unref(pkt);
+        return;
+    }
+#endif
+
     ret = av_interleaved_write_frame(s, pkt);
     if (ret < 0) {
         print_error("av_interleaved_write_frame()", ret);
@@ -1667,9 +1783,15 @@ static void print_report(int is_last_report, int64_t timer_start, int64_t cur_ti
 
     oc = output_files[0]->ctx;
 
+#if HAVE_THREADS
+    /* the muxing thread owns the AVIOContext, avio_size() may seek */
+    if (output_files[0]->mux_queue)
+        total_size = output_file_tell(output_files[0]);
+    else
+#endif
     total_size = avio_size(oc->pb);
     if (total_size <= 0) // FIXME improve avio_size() so it works with non seekable output too
-        total_size = avio_tell(oc->pb);
+        total_size = output_file_tell(output_files[0]);
 
     vid = 0;
     av_bprint_init(&buf, 0, AV_BPRINT_SIZE_AUTOMATIC);
@@ -2973,6 +3095,12 @@ static int check_init_output_file(OutputFile *of, int file_index)
     if (sdp_filename || want_sdp)
         print_sdp();
 
+#if HAVE_THREADS
+    ret = init_mux_thread(of);
+    if (ret < 0)
+        return ret;
+#endif
+
     /* flush the muxing queues */
     for (i = 0; i < of->ctx->nb_streams; i++) {
         OutputStream *ost = output_streams[of->ost_index + i];
@@ -3804,7 +3932,7 @@ static int need_output(void)
         AVFormatContext *os  = output_files[ost->file_index]->ctx;
 
         if (ost->finished ||
-            (os->pb && avio_tell(os->pb) >= of->limit_filesize))
+            (os->pb && output_file_tell(of) >= of->limit_filesize))
             continue;
         if (ost->frame_number >= ost->max_frames) {
             int j;
@@ -4683,6 +4811,9 @@ static int transcode(void)
         }
     }
     flush_encoders();
+#if HAVE_THREADS
+    free_mux_threads();
+#endif
 
     term_exit();
 
@@ -4742,6 +4873,7 @@ static int transcode(void)
  fail:
 #if HAVE_THREADS
     free_input_threads();
+    free_mux_threads();
 #endif
 
     if (output_streams) {
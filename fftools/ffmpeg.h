@@ -21,6 +21,7 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <signal.h>
@@ -565,6 +566,16 @@ typedef struct OutputFile {
     int shortest;
 
     int header_written;
+
+#if HAVE_THREADS
+    /* Muxing thread, only av_interleaved_write_frame() runs there; encoding
+     * is still done by the main thread. */
+    AVThreadMessageQueue *mux_queue;
+    pthread_t thread;              /* thread writing packets to this file */
+    int thread_queue_size;         /* maximum number of queued packets */
+    int mux_ret;                   /* error returned by the muxer, set by the thread */
+    atomic_int_least64_t mux_size; /* bytes written so far, updated by the thread */
+#endif
 } OutputFile;
 
 extern InputStream **input_streams;
@@ -612,6 +623,7 @@ extern char *videotoolbox_pixfmt;
 
 extern int filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern int filter_complex_branch_threads;
 extern int vstats_version;
 
 extern const AVIOInterruptCB int_cb;
@@ -1057,6 +1057,8 @@ int configure_filtergraph(FilterGraph *fg)
             av_opt_set(fg->graph, "threads", e->value, 0);
     } else {
         fg->graph->nb_threads = filter_complex_nbthreads;
+        if (filter_complex_branch_threads)
+            fg->graph->thread_type |= AVFILTER_THREAD_BRANCH;
     }
 
     if ((ret = avfilter_graph_parse2(fg->graph, graph_desc, &inputs, &outputs)) < 0)
@@ -508,6 +508,53 @@ static int encode_individual_channel(AVCodecContext *avctx, AACEncContext *s,
     return 0;
 }
 
+static int search_for_quantizers_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    AACEncContext *t = s->thread_ctx ? s->thread_ctx[threadnr] : s;
+    AACQuantizerJob *job = &s->quant_jobs[jobnr];
+
+    if (t != s) {
+        /* the psy band data stays shared, only the scratch buffers and
+         * the cost cache are per thread */
+        t->psy         = s->psy;
+        t->lambda      = s->lambda;
+        t->options     = s->options;
+        t->abs_pow34   = s->abs_pow34;
+        t->quant_bands = s->quant_bands;
+    }
+    t->psy.bitres.alloc  = job->bitres_alloc;
+    t->cur_channel       = job->channel;
+    t->cur_type          = job->type;
+    if (s->options.pns && s->coder->mark_pns)
+        s->coder->mark_pns(t, avctx, job->sce);
+    s->coder->search_for_quantizers(avctx, t, job->sce, s->lambda);
+    job->cutoff = t->psy.cutoff;
+
+    return 0;
+}
+
+/**
+ * The psy cutoff the twoloop quantizer search sets; it only depends on
+ * lambda, so it is the same for all elements of a frame.
+ * Keep this in sync with twoloop's cutoff selection.
+ */
+static int twoloop_cutoff(AVCodecContext *avctx, AACEncContext *s)
+{
+    int refbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
+        / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->channels)
+        * (s->lambda / 120.f);
+    float rate_bandwidth_multiplier = 1.5f;
+    int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
+        ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
+        : (avctx->bit_rate / avctx->channels);
+
+    if (s->options.pns || s->options.intensity_stereo)
+        frame_bit_rate *= 1.15f;
+
+    return FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+}
+
 /**
  * Write some auxiliary information about the created AAC file.
  */
@@ -699,8 +746,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             cpe->common_window = 0;
             memset(cpe->is_mask, 0, sizeof(cpe->is_mask));
             memset(cpe->ms_mask, 0, sizeof(cpe->ms_mask));
-            put_bits(&s->pb, 3, tag);
-            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             for (ch = 0; ch < chans; ch++) {
                 sce = &cpe->ch[ch];
                 coeffs[ch] = sce->coeffs;
@@ -722,13 +767,33 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                     * (s->lambda / (avctx->global_quality ? avctx->global_quality : 120));
                 s->psy.bitres.alloc /= chans;
             }
-            s->cur_type = tag;
             for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                if (s->options.pns && s->coder->mark_pns)
-                    s->coder->mark_pns(s, avctx, &cpe->ch[ch]);
-                s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
+                AACQuantizerJob *job = &s->quant_jobs[start_ch + ch];
+                job->sce          = &cpe->ch[ch];
+                job->channel      = start_ch + ch;
+                job->type         = tag;
+                job->bitres_alloc = s->psy.bitres.alloc;
             }
+            /* The analysis of the next element uses the cutoff the search of
+             * this one sets */
+            if (s->options.coder == AAC_CODER_TWOLOOP && avctx->cutoff <= 0)
+                s->psy.cutoff = twoloop_cutoff(avctx, s);
+            start_ch += chans;
+        }
+
+        /* The quantizer searches of all channels are independent */
+        avctx->execute2(avctx, search_for_quantizers_job, NULL, NULL, s->channels);
+        s->psy.cutoff = s->quant_jobs[s->channels - 1].cutoff;
+
+        start_ch = 0;
+        for (i = 0; i < s->chan_map[0]; i++) {
+            FFPsyWindowInfo* wi = windows + start_ch;
+            tag      = s->chan_map[i+1];
+            chans    = tag == TYPE_CPE ? 2 : 1;
+            cpe      = &s->cpe[i];
+            s->cur_type = tag;
+            put_bits(&s->pb, 3, tag);
+            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             if (chans > 1
                 && wi[0].window_type[0] == wi[1].window_type[0]
                 && wi[0].window_shape   == wi[1].window_shape) {
@@ -911,6 +976,10 @@ static av_cold int aac_encode_end(AVCodecContext *avctx)
         ff_psy_preprocess_end(s->psypp);
     av_freep(&s->buffer.samples);
     av_freep(&s->cpe);
+    av_freep(&s->quant_jobs);
+    for (int i = 0; i < s->nb_thread_ctx; i++)
+        av_freep(&s->thread_ctx[i]);
+    av_freep(&s->thread_ctx);
     av_freep(&s->fdsp);
     ff_af_queue_close(&s->afq);
     return 0;
@@ -942,7 +1011,8 @@ static av_cold int alloc_buffers(AVCodecContext *avctx, AACEncContext *s)
 {
     int ch;
     if (!FF_ALLOCZ_TYPED_ARRAY(s->buffer.samples, s->channels * 3 * 1024) ||
-        !FF_ALLOCZ_TYPED_ARRAY(s->cpe,            s->chan_map[0]))
+        !FF_ALLOCZ_TYPED_ARRAY(s->cpe,            s->chan_map[0]) ||
+        !FF_ALLOCZ_TYPED_ARRAY(s->quant_jobs,     s->channels))
         return AVERROR(ENOMEM);
 
     for(ch = 0; ch < s->channels; ch++)
@@ -1112,6 +1182,20 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
 
     ff_af_queue_init(avctx, &s->afq);
 
+    /* Each slice thread searches with its own scratch buffers and cost
+     * cache; the rest is set from this context for each job */
+    if (avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1 &&
+        s->channels > 1) {
+        if (!FF_ALLOCZ_TYPED_ARRAY(s->thread_ctx, avctx->thread_count))
+            return AVERROR(ENOMEM);
+        for (i = 0; i < avctx->thread_count; i++) {
+            s->thread_ctx[i] = av_mallocz(sizeof(*s));
+            if (!s->thread_ctx[i])
+                return AVERROR(ENOMEM);
+            s->nb_thread_ctx++;
+        }
+    }
+
     return 0;
 }
 
@@ -1156,7 +1240,8 @@ AVCodec ff_aac_encoder = {
     .defaults       = aac_encode_defaults,
     .supported_samplerates = mpeg4audio_sample_rates,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_INIT_CLEANUP,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_FLTP,
                                                      AV_SAMPLE_FMT_NONE },
     .priv_class     = &aacenc_class,
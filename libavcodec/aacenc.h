@@ -370,6 +370,17 @@ static const AACPCEInfo aac_pce_configs[] = {
     },
 };
 
+/**
+ * quantizer search of one channel, run as a slice thread job
+ */
+typedef struct AACQuantizerJob {
+    SingleChannelElement *sce;
+    int channel;                                 ///< cur_channel to search with
+    enum RawDataBlockType type;                  ///< cur_type to search with
+    int bitres_alloc;                            ///< psy bit reservoir allocation for the channel
+    int cutoff;                                  ///< psy cutoff as updated by the search
+} AACQuantizerJob;
+
 /**
  * AAC encoder context
  */
@@ -418,6 +429,10 @@ typedef struct AACEncContext {
     struct {
         float *samples;
     } buffer;
+
+    AACQuantizerJob *quant_jobs;                 ///< quantizer searches of all channels of a frame
+    struct AACEncContext **thread_ctx;           ///< per-thread contexts owning the search scratch buffers
+    int nb_thread_ctx;
 } AACEncContext;
 
 void ff_aac_dsp_init_x86(AACEncContext *s);
@@ -163,6 +163,16 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
         }
     }
 
+    if (avctx->codec_id == AV_CODEC_ID_FFV1 &&
+        (avctx->gop_size > 1 || avctx->flags & AV_CODEC_FLAG_PASS1)) {
+        // range coder states and first pass statistics are carried from
+        // frame to frame, only intra-only streams can be frame threaded
+        av_log(avctx, AV_LOG_VERBOSE,
+               "Using slice threading for FFV1 encoding with a GOP size above 1 or first pass\n");
+        avctx->thread_type &= ~FF_THREAD_FRAME;
+        return 0;
+    }
+
     if(!avctx->thread_count) {
         avctx->thread_count = av_cpu_count();
         avctx->thread_count = FFMIN(avctx->thread_count, MAX_THREADS);
@@ -477,6 +477,8 @@ static av_always_inline void FUNC(pred_angular)(uint8_t *_src,
                 POS(0, y) = av_clip_pixel(top[0] + ((left[y] - left[-1]) >> 1));
         }
     } else {
+        pixel block[MAX_TB_SIZE * MAX_TB_SIZE];
+
         ref = left - 1;
         if (angle < 0 && last < -1) {
             for (x = 0; x <= size; x += 4)
@@ -486,18 +488,40 @@ static av_always_inline void FUNC(pred_angular)(uint8_t *_src,
             ref = ref_tmp;
         }
 
-        for (x = 0; x < size; x++) {
-            int idx  = ((x + 1) * angle) >> 5;
-            int fact = ((x + 1) * angle) & 31;
-            if (fact) {
-                for (y = 0; y < size; y++) {
-                    POS(x, y) = ((32 - fact) * ref[y + idx + 1] +
-                                       fact  * ref[y + idx + 2] + 16) >> 5;
+        if (size < 16) {
+            for (x = 0; x < size; x++) {
+                int idx  = ((x + 1) * angle) >> 5;
+                int fact = ((x + 1) * angle) & 31;
+                if (fact) {
+                    for (y = 0; y < size; y++) {
+                        POS(x, y) = ((32 - fact) * ref[y + idx + 1] +
+                                           fact  * ref[y + idx + 2] + 16) >> 5;
+                    }
+                } else {
+                    for (y = 0; y < size; y++)
+                        POS(x, y) = ref[y + idx + 1];
                 }
-            } else {
-                for (y = 0; y < size; y++)
-                    POS(x, y) = ref[y + idx + 1];
             }
+        } else {
+            /* Predict the transposed block row by row, like the vertical
+             * modes, and transpose it into place afterwards. Writing the
+             * columns directly cannot be vectorized. */
+            for (x = 0; x < size; x++) {
+                pixel *col = &block[x * size];
+                int idx  = ((x + 1) * angle) >> 5;
+                int fact = ((x + 1) * angle) & 31;
+                if (fact) {
+                    for (y = 0; y < size; y++)
+                        col[y] = ((32 - fact) * ref[y + idx + 1] +
+                                        fact  * ref[y + idx + 2] + 16) >> 5;
+                } else {
+                    for (y = 0; y < size; y += 4)
+                        AV_WN4P(&col[y], AV_RN4P(&ref[y + idx + 1]));
+                }
+            }
+            for (y = 0; y < size; y++)
+                for (x = 0; x < size; x++)
+                    POS(x, y) = block[x * size + y];
         }
         if (mode == 10 && c_idx == 0 && size < 32) {
             for (x = 0; x < size; x += 4) {
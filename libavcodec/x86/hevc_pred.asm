@@ -0,0 +1,526 @@
+;******************************************************************************
+;* SIMD-optimized HEVC intra prediction
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_planar_x1: dw  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16
+              dw 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32
+
+pb_transpose_4x4: db 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+
+cextern pw_1
+cextern pw_4
+cextern pw_8
+cextern pw_16
+cextern pw_32
+
+SECTION .text
+
+; The planar prediction of row y is computed as
+;   pred[x] = C[x] + left[y] * (size - 1 - x)
+; with
+;   C[x] = (x + 1) * top[size] + (size - 1 - y) * top[x] + (y + 1) * left[size] + size
+; C is updated incrementally for every row by adding left[size] - top[x].
+; All intermediate values fit in 16 bits for 8-bit pixels.
+
+; PLANAR_INIT C, D, W, column offset, size
+%macro PLANAR_INIT 5
+    pmovzxbw       %1, [r1+%4]              ; top[x]
+    mova           %2, m6
+    psubw          %2, %1                   ; left[size] - top[x]
+    pmullw         %1, [pw_%5]
+    paddw          %1, %2                   ; (size - 1) * top[x] + left[size]
+    paddw          %1, [pw_%5]
+    mova           %3, [pw_planar_x1+(%4)*2]
+    pmullw         %3, m7
+    paddw          %1, %3                   ; + (x + 1) * top[size]
+    mova           %3, [pw_%5]
+    psubw          %3, [pw_planar_x1+(%4)*2]  ; size - 1 - x
+%endmacro
+
+; PLANAR_COLUMNS width, size, log2 size, column offset
+%macro PLANAR_COLUMNS 4
+    movzx         r6d, byte [r2+%2]
+    movd           m6, r6d
+    SPLATW         m6, m6, 0                ; left[size]
+    movzx         r6d, byte [r1+%2]
+    movd           m7, r6d
+    SPLATW         m7, m7, 0                ; top[size]
+    PLANAR_INIT    m0, m1, m2, %4, %2
+%if %1 == 16
+    PLANAR_INIT    m3, m4, m5, %4+8, %2
+%endif
+    lea            r5, [r0+%4]
+    xor           r4d, r4d
+.loop_%4:
+    movzx         r6d, byte [r2+r4]
+    movd           m6, r6d
+    SPLATW         m6, m6, 0                ; left[y]
+    pmullw         m7, m6, m2
+    paddw          m7, m0
+    paddw          m0, m1
+    psrlw          m7, %3+1
+%if %1 == 16
+    pmullw         m6, m5
+    paddw          m6, m3
+    paddw          m3, m4
+    psrlw          m6, %3+1
+    packuswb       m7, m6
+    movu         [r5], m7
+%else
+    packuswb       m7, m7
+%if %1 == 8
+    movq         [r5], m7
+%else
+    movd         [r5], m7
+%endif
+%endif
+    add            r5, r3
+    inc           r4d
+    cmp           r4d, %2
+    jl .loop_%4
+%endmacro
+
+; void ff_hevc_pred_planar_<size>_8_<opt>(uint8_t *src, const uint8_t *top,
+;                                        const uint8_t *left, ptrdiff_t stride)
+%macro PRED_PLANAR 3 ; size, log2 size, width of a column block
+cglobal hevc_pred_planar_%1_8, 4, 7, 8, src, top, left, stride
+    PLANAR_COLUMNS %3, %1, %2, 0
+%if %1 == 32
+    PLANAR_COLUMNS %3, %1, %2, 16
+%endif
+    RET
+%endmacro
+
+INIT_XMM sse4
+PRED_PLANAR  4, 2,  4
+PRED_PLANAR  8, 3,  8
+PRED_PLANAR 16, 4, 16
+PRED_PLANAR 32, 5, 16
+
+; The DC functions fill the block with the DC value and return it, the edge
+; filtering of luma blocks is done by the caller.
+
+; int ff_hevc_pred_dc_<size>_8_<opt>(uint8_t *src, const uint8_t *top,
+;                                    const uint8_t *left, ptrdiff_t stride)
+%macro PRED_DC_8 2 ; size, log2 size
+cglobal hevc_pred_dc_%1_8, 4, 6, 3, src, top, left, stride, cnt, dc
+    pxor           m2, m2
+%if %1 == 4
+    movd           m0, [topq]
+    movd           m1, [leftq]
+    punpckldq      m0, m1
+    psadbw         m0, m2
+%elif %1 == 8
+    movq           m0, [topq]
+    movhps         m0, [leftq]
+    psadbw         m0, m2
+%else
+    movu           m0, [topq]
+    movu           m1, [leftq]
+    psadbw         m0, m2
+    psadbw         m1, m2
+    paddw          m0, m1
+%if %1 == 32
+    movu           m1, [topq+16]
+    psadbw         m1, m2
+    paddw          m0, m1
+    movu           m1, [leftq+16]
+    psadbw         m1, m2
+    paddw          m0, m1
+%endif
+%endif
+%if %1 >= 8
+    MOVHL          m1, m0
+    paddw          m0, m1
+%endif
+    movd          dcd, m0
+    add           dcd, %1
+    shr           dcd, %2+1
+    movd           m0, dcd
+    pshufb         m0, m2
+    mov          cntd, %1
+.loop:
+%if %1 == 4
+    movd       [srcq], m0
+%elif %1 == 8
+    movq       [srcq], m0
+%else
+    movu       [srcq], m0
+%if %1 == 32
+    movu    [srcq+16], m0
+%endif
+%endif
+    add          srcq, strideq
+    dec          cntd
+    jg .loop
+    mov           eax, dcd
+    RET
+%endmacro
+
+; int ff_hevc_pred_dc_<size>_10_<opt>(uint8_t *src, const uint8_t *top,
+;                                     const uint8_t *left, ptrdiff_t stride)
+; The stride is in pixels.
+%macro PRED_DC_10 2 ; size, log2 size
+cglobal hevc_pred_dc_%1_10, 4, 6, 3, src, top, left, stride, cnt, dc
+%if %1 == 4
+    movq           m0, [topq]
+    movhps         m0, [leftq]
+    pmaddwd        m0, [pw_1]
+%else
+    pxor           m0, m0
+%assign %%i 0
+%rep %1 / 8
+    movu           m1, [topq+%%i]
+    movu           m2, [leftq+%%i]
+    paddw          m1, m2
+    pmaddwd        m1, [pw_1]
+    paddd          m0, m1
+%assign %%i %%i+16
+%endrep
+%endif
+    HADDD          m0, m1
+    movd          dcd, m0
+    add           dcd, %1
+    shr           dcd, %2+1
+    movd           m0, dcd
+    SPLATW         m0, m0, 0
+    add       strideq, strideq
+    mov          cntd, %1
+.loop:
+%if %1 == 4
+    movq       [srcq], m0
+%else
+%assign %%i 0
+%rep %1 / 8
+    movu  [srcq+%%i], m0
+%assign %%i %%i+16
+%endrep
+%endif
+    add          srcq, strideq
+    dec          cntd
+    jg .loop
+    mov           eax, dcd
+    RET
+%endmacro
+
+INIT_XMM sse4
+PRED_DC_8   4, 2
+PRED_DC_8   8, 3
+PRED_DC_8  16, 4
+PRED_DC_8  32, 5
+PRED_DC_10  4, 2
+PRED_DC_10  8, 3
+PRED_DC_10 16, 4
+PRED_DC_10 32, 5
+
+%if ARCH_X86_64
+; The angular functions predict the rows of a block from a reference array,
+;   dst[x + y * stride] = ((32 - fact) * ref[x + idx + 1] +
+;                                fact  * ref[x + idx + 2] + 16) >> 5
+; with idx = ((y + 1) * angle) >> 5 and fact = ((y + 1) * angle) & 31.
+; The stride is in bytes. Building the reference array, transposing the
+; horizontal modes and the edge filters are done by the caller.
+
+; ANGULAR_ROW_8 width, column offset
+%macro ANGULAR_ROW_8 2
+%if %1 == 4
+    movd           m0, [idxq+%2+1]
+    movd           m1, [idxq+%2+2]
+%elif %1 == 8
+    movq           m0, [idxq+%2+1]
+    movq           m1, [idxq+%2+2]
+%else
+    movu           m0, [idxq+%2+1]
+    movu           m1, [idxq+%2+2]
+    punpckhbw      m2, m0, m1
+    pmaddubsw      m2, m5
+    paddw          m2, m4
+    psrlw          m2, 5
+%endif
+    punpcklbw      m0, m1
+    pmaddubsw      m0, m5
+    paddw          m0, m4
+    psrlw          m0, 5
+%if %1 >= 16
+    packuswb       m0, m2
+    movu  [dstq+%2], m0
+%else
+    packuswb       m0, m0
+%if %1 == 8
+    movq  [dstq+%2], m0
+%else
+    movd  [dstq+%2], m0
+%endif
+%endif
+%endmacro
+
+; ANGULAR_COPY_8 width, column offset
+%macro ANGULAR_COPY_8 2
+%if %1 == 4
+    movd           m0, [idxq+%2+1]
+    movd  [dstq+%2], m0
+%elif %1 == 8
+    movq           m0, [idxq+%2+1]
+    movq  [dstq+%2], m0
+%else
+    movu           m0, [idxq+%2+1]
+    movu  [dstq+%2], m0
+%endif
+%endmacro
+
+; void ff_hevc_pred_angular_rows_<size>_8_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                               const uint8_t *ref, int angle)
+%macro PRED_ANGULAR_ROWS_8 2 ; size, width of a column block
+cglobal hevc_pred_angular_rows_%1_8, 4, 8, 6, dst, stride, ref, angle, pos, idx, fact, cnt
+    VBROADCASTI128 m4, [pw_16]
+    mov          posd, angled
+    mov          cntd, %1
+.loop:
+    mov          idxd, posd
+    sar          idxd, 5
+    movsxd       idxq, idxd
+    add          idxq, refq
+    mov         factd, posd
+    and         factd, 31
+    jz .copy
+    imul        factd, 255
+    add         factd, 32                   ; fact << 8 | (32 - fact)
+    movd          xm5, factd
+    SPLATW         m5, xm5, 0
+    ANGULAR_ROW_8  %2, 0
+%if %1 > %2
+    ANGULAR_ROW_8  %2, 16
+%endif
+    jmp .next
+.copy:
+    ANGULAR_COPY_8 %2, 0
+%if %1 > %2
+    ANGULAR_COPY_8 %2, 16
+%endif
+.next:
+    add          dstq, strideq
+    add          posd, angled
+    dec          cntd
+    jg .loop
+    RET
+%endmacro
+
+; ANGULAR_ROW_10 width, byte offset
+%macro ANGULAR_ROW_10 2
+%if %1 == 4
+    movq           m0, [idxq+%2+2]
+    movq           m1, [idxq+%2+4]
+%else
+    movu           m0, [idxq+%2+2]
+    movu           m1, [idxq+%2+4]
+%endif
+    pmullw         m0, m5
+    pmullw         m1, m6
+    paddw          m0, m1
+    paddw          m0, m4
+    psrlw          m0, 5
+%if %1 == 4
+    movq  [dstq+%2], m0
+%else
+    movu  [dstq+%2], m0
+%endif
+%endmacro
+
+; ANGULAR_COPY_10 width, byte offset
+%macro ANGULAR_COPY_10 2
+%if %1 == 4
+    movq           m0, [idxq+%2+2]
+    movq  [dstq+%2], m0
+%else
+    movu           m0, [idxq+%2+2]
+    movu  [dstq+%2], m0
+%endif
+%endmacro
+
+; void ff_hevc_pred_angular_rows_<size>_10_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                                const uint8_t *ref, int angle)
+%macro PRED_ANGULAR_ROWS_10 1 ; size
+cglobal hevc_pred_angular_rows_%1_10, 4, 8, 7, dst, stride, ref, angle, pos, idx, fact, cnt
+    VBROADCASTI128 m4, [pw_16]
+    mov          posd, angled
+    mov          cntd, %1
+.loop:
+    mov          idxd, posd
+    sar          idxd, 5
+    movsxd       idxq, idxd
+    lea          idxq, [refq+idxq*2]
+    mov         factd, posd
+    and         factd, 31
+    jz .copy
+    movd          xm6, factd
+    SPLATW         m6, xm6, 0               ; fact
+    VBROADCASTI128 m5, [pw_32]
+    psubw          m5, m6                   ; 32 - fact
+%if %1 == 4
+    ANGULAR_ROW_10 4, 0
+%else
+%assign %%i 0
+%rep %1 * 2 / mmsize
+    ANGULAR_ROW_10 8, %%i
+%assign %%i %%i+mmsize
+%endrep
+%endif
+    jmp .next
+.copy:
+%if %1 == 4
+    ANGULAR_COPY_10 4, 0
+%else
+%assign %%i 0
+%rep %1 * 2 / mmsize
+    ANGULAR_COPY_10 8, %%i
+%assign %%i %%i+mmsize
+%endrep
+%endif
+.next:
+    add          dstq, strideq
+    add          posd, angled
+    dec          cntd
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+PRED_ANGULAR_ROWS_8   4,  4
+PRED_ANGULAR_ROWS_8   8,  8
+PRED_ANGULAR_ROWS_8  16, 16
+PRED_ANGULAR_ROWS_8  32, 16
+PRED_ANGULAR_ROWS_10  4
+PRED_ANGULAR_ROWS_10  8
+PRED_ANGULAR_ROWS_10 16
+PRED_ANGULAR_ROWS_10 32
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+PRED_ANGULAR_ROWS_8  32, 32
+PRED_ANGULAR_ROWS_10 16
+PRED_ANGULAR_ROWS_10 32
+%endif
+
+; The transpose functions write the transpose of a contiguous size x size
+; block to dst, this is how the horizontal angular modes are put into place.
+; The stride is in bytes.
+
+; TRANSPOSE_8x8_8 source stride
+%macro TRANSPOSE_8x8_8 1
+    movq           m0, [srcq+0*%1]
+    movq           m1, [srcq+1*%1]
+    movq           m2, [srcq+2*%1]
+    movq           m3, [srcq+3*%1]
+    movq           m4, [srcq+4*%1]
+    movq           m5, [srcq+5*%1]
+    movq           m6, [srcq+6*%1]
+    movq           m7, [srcq+7*%1]
+    punpcklbw      m0, m1
+    punpcklbw      m2, m3
+    punpcklbw      m4, m5
+    punpcklbw      m6, m7
+    SBUTTERFLY     wd, 0, 2, 1
+    SBUTTERFLY     wd, 4, 6, 1
+    SBUTTERFLY     dq, 0, 4, 1
+    SBUTTERFLY     dq, 2, 6, 1
+    lea         dst4q, [tmpq+strideq*4]
+    movq               [tmpq], m0
+    movhps     [tmpq+strideq], m0
+    movq     [tmpq+strideq*2], m4
+    movhps    [tmpq+stride3q], m4
+    movq              [dst4q], m2
+    movhps    [dst4q+strideq], m2
+    movq    [dst4q+strideq*2], m6
+    movhps   [dst4q+stride3q], m6
+%endmacro
+
+; TRANSPOSE_8x8_10 source stride
+%macro TRANSPOSE_8x8_10 1
+%assign %%i 0
+%rep 8
+    movu        m %+ %%i, [srcq+%%i*%1]
+%assign %%i %%i+1
+%endrep
+    TRANSPOSE8x8W   0, 1, 2, 3, 4, 5, 6, 7, 8
+    lea         dst4q, [tmpq+strideq*4]
+    movu               [tmpq], m0
+    movu       [tmpq+strideq], m1
+    movu     [tmpq+strideq*2], m2
+    movu      [tmpq+stride3q], m3
+    movu              [dst4q], m4
+    movu      [dst4q+strideq], m5
+    movu    [dst4q+strideq*2], m6
+    movu     [dst4q+stride3q], m7
+%endmacro
+
+; void ff_hevc_transpose_<size>_<depth>_<opt>(uint8_t *dst, ptrdiff_t stride,
+;                                             const uint8_t *src)
+%macro TRANSPOSE_BLOCK 2 ; size, depth
+%assign %%ps (%2 > 8) + 1
+cglobal hevc_transpose_%1_%2, 3, 8, 9, dst, stride, src, stride3, tmp, dst4, row, col
+    lea      stride3q, [strideq*3]
+%if %1 == 4 && %2 == 8
+    movu           m0, [srcq]
+    pshufb         m0, [pb_transpose_4x4]
+    movd       [dstq], m0
+    pextrd     [dstq+strideq], m0, 1
+    pextrd     [dstq+strideq*2], m0, 2
+    pextrd     [dstq+stride3q], m0, 3
+%elif %1 == 4
+    movu           m0, [srcq]               ; rows 0 and 1
+    movu           m1, [srcq+16]            ; rows 2 and 3
+    SBUTTERFLY     wd, 0, 1, 2
+    SBUTTERFLY     wd, 0, 1, 2
+    movq               [dstq], m0
+    movhps     [dstq+strideq], m0
+    movq     [dstq+strideq*2], m1
+    movhps    [dstq+stride3q], m1
+%else
+    mov          cold, %1 / 8
+.col:
+    mov          tmpq, dstq
+    mov          rowd, %1 / 8
+.row:
+    TRANSPOSE_8x8_%2 %1 * %%ps
+    add          srcq, 8 * %1 * %%ps
+    add          tmpq, 8 * %%ps
+    dec          rowd
+    jg .row
+    sub          srcq, (%1 * %1 - 8) * %%ps
+    lea          dstq, [dstq+strideq*8]
+    dec          cold
+    jg .col
+%endif
+    RET
+%endmacro
+
+INIT_XMM sse4
+TRANSPOSE_BLOCK  4, 8
+TRANSPOSE_BLOCK  8, 8
+TRANSPOSE_BLOCK 16, 8
+TRANSPOSE_BLOCK 32, 8
+TRANSPOSE_BLOCK  4, 10
+TRANSPOSE_BLOCK  8, 10
+TRANSPOSE_BLOCK 16, 10
+TRANSPOSE_BLOCK 32, 10
+%endif
@@ -0,0 +1,272 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/hevcdec.h"
+#include "libavcodec/hevcpred.h"
+
+#define PRED_PLANAR(size, depth, opt)                                          \
+void ff_hevc_pred_planar_ ## size ## _ ## depth ## _ ## opt(uint8_t *src,      \
+                                                            const uint8_t *top, \
+                                                            const uint8_t *left,\
+                                                            ptrdiff_t stride);
+
+PRED_PLANAR( 4, 8, sse4)
+PRED_PLANAR( 8, 8, sse4)
+PRED_PLANAR(16, 8, sse4)
+PRED_PLANAR(32, 8, sse4)
+
+#define PRED_DC(size, depth, opt)                                              \
+int ff_hevc_pred_dc_ ## size ## _ ## depth ## _ ## opt(uint8_t *src,           \
+                                                       const uint8_t *top,     \
+                                                       const uint8_t *left,    \
+                                                       ptrdiff_t stride);
+
+PRED_DC( 4,  8, sse4)
+PRED_DC( 8,  8, sse4)
+PRED_DC(16,  8, sse4)
+PRED_DC(32,  8, sse4)
+PRED_DC( 4, 10, sse4)
+PRED_DC( 8, 10, sse4)
+PRED_DC(16, 10, sse4)
+PRED_DC(32, 10, sse4)
+
+#define PRED_ANGULAR_ROWS(size, depth, opt)                                    \
+void ff_hevc_pred_angular_rows_ ## size ## _ ## depth ## _ ## opt(uint8_t *dst, \
+                                                                  ptrdiff_t stride, \
+                                                                  const uint8_t *ref, \
+                                                                  int angle);
+
+PRED_ANGULAR_ROWS( 4,  8, sse4)
+PRED_ANGULAR_ROWS( 8,  8, sse4)
+PRED_ANGULAR_ROWS(16,  8, sse4)
+PRED_ANGULAR_ROWS(32,  8, sse4)
+PRED_ANGULAR_ROWS( 4, 10, sse4)
+PRED_ANGULAR_ROWS( 8, 10, sse4)
+PRED_ANGULAR_ROWS(16, 10, sse4)
+PRED_ANGULAR_ROWS(32, 10, sse4)
+PRED_ANGULAR_ROWS(32,  8, avx2)
+PRED_ANGULAR_ROWS(16, 10, avx2)
+PRED_ANGULAR_ROWS(32, 10, avx2)
+
+#define TRANSPOSE(size, depth, opt)                                            \
+void ff_hevc_transpose_ ## size ## _ ## depth ## _ ## opt(uint8_t *dst,        \
+                                                          ptrdiff_t stride,    \
+                                                          const uint8_t *src);
+
+TRANSPOSE( 4,  8, sse4)
+TRANSPOSE( 8,  8, sse4)
+TRANSPOSE(16,  8, sse4)
+TRANSPOSE(32,  8, sse4)
+TRANSPOSE( 4, 10, sse4)
+TRANSPOSE( 8, 10, sse4)
+TRANSPOSE(16, 10, sse4)
+TRANSPOSE(32, 10, sse4)
+
+typedef int (*pred_dc_func)(uint8_t *src, const uint8_t *top,
+                            const uint8_t *left, ptrdiff_t stride);
+typedef void (*pred_angular_rows_func)(uint8_t *dst, ptrdiff_t stride,
+                                       const uint8_t *ref, int angle);
+typedef void (*transpose_func)(uint8_t *dst, ptrdiff_t stride,
+                               const uint8_t *src);
+
+static av_always_inline int get_pixel(const uint8_t *buf, int i, int depth)
+{
+    return depth > 8 ? ((const uint16_t *)buf)[i] : buf[i];
+}
+
+static av_always_inline void set_pixel(uint8_t *buf, int i, int v, int depth)
+{
+    if (depth > 8)
+        ((uint16_t *)buf)[i] = v;
+    else
+        buf[i] = v;
+}
+
+/* The asm fills the block and returns the DC value, the edge filter of luma
+ * blocks is applied here. The stride is in pixels. */
+static av_always_inline void pred_dc(uint8_t *src, const uint8_t *top,
+                                     const uint8_t *left, ptrdiff_t stride,
+                                     int log2_size, int c_idx, int depth,
+                                     const pred_dc_func *fill)
+{
+    int size = 1 << log2_size;
+    int dc   = fill[log2_size - 2](src, top, left, stride);
+    int x, y;
+
+    if (c_idx == 0 && size < 32) {
+        set_pixel(src, 0, (get_pixel(left, 0, depth) + 2 * dc +
+                           get_pixel(top, 0, depth) + 2) >> 2, depth);
+        for (x = 1; x < size; x++)
+            set_pixel(src, x, (get_pixel(top, x, depth) + 3 * dc + 2) >> 2, depth);
+        for (y = 1; y < size; y++)
+            set_pixel(src, y * stride,
+                      (get_pixel(left, y, depth) + 3 * dc + 2) >> 2, depth);
+    }
+}
+
+/* The asm predicts the rows of the block from the reference array. The
+ * reference array of the modes with a negative angle and the edge filters
+ * are built here; the horizontal modes are predicted transposed into a
+ * scratch block, like the vertical ones, and transposed into place. */
+static av_always_inline void pred_angular(uint8_t *src, const uint8_t *top,
+                                          const uint8_t *left, ptrdiff_t stride,
+                                          int c_idx, int mode, int log2_size,
+                                          int depth,
+                                          pred_angular_rows_func rows,
+                                          transpose_func transpose)
+{
+    static const int intra_pred_angle[] = {
+         32,  26,  21,  17, 13,  9,  5, 2, 0, -2, -5, -9, -13, -17, -21, -26, -32,
+        -26, -21, -17, -13, -9, -5, -2, 0, 2,  5,  9, 13,  17,  21,  26,  32
+    };
+    static const int inv_angle[] = {
+        -4096, -1638, -910, -630, -482, -390, -315, -256, -315, -390, -482,
+        -630, -910, -1638, -4096
+    };
+    const int ps      = depth > 8;
+    const int size    = 1 << log2_size;
+    const int angle   = intra_pred_angle[mode - 2];
+    const int last    = (size * angle) >> 5;
+    const uint8_t *main = mode >= 18 ? top  : left;
+    const uint8_t *side = mode >= 18 ? left : top;
+    const uint8_t *ref  = main - (1 << ps);
+    LOCAL_ALIGNED_16(uint8_t, ref_array, [(3 * MAX_TB_SIZE + 4) * 2]);
+    LOCAL_ALIGNED_16(uint8_t, block, [MAX_TB_SIZE * MAX_TB_SIZE * 2]);
+    int x, y;
+
+    if (angle < 0 && last < -1) {
+        uint8_t *ref_tmp = ref_array + (size << ps);
+        memcpy(ref_tmp, main - (1 << ps), (size + 1) << ps);
+        for (x = last; x <= -1; x++)
+            set_pixel(ref_tmp, x,
+                      get_pixel(side, -1 + ((x * inv_angle[mode - 11] + 128) >> 8),
+                                depth), depth);
+        ref = ref_tmp;
+    }
+
+    if (mode >= 18) {
+        rows(src, stride << ps, ref, angle);
+        if (mode == 26 && c_idx == 0 && size < 32) {
+            for (y = 0; y < size; y++)
+                set_pixel(src, y * stride,
+                          av_clip_uintp2(get_pixel(top, 0, depth) +
+                                         ((get_pixel(left, y, depth) -
+                                           get_pixel(left, -1, depth)) >> 1),
+                                         depth), depth);
+        }
+    } else {
+        rows(block, size << ps, ref, angle);
+        transpose(src, stride << ps, block);
+        if (mode == 10 && c_idx == 0 && size < 32) {
+            for (x = 0; x < size; x++)
+                set_pixel(src, x,
+                          av_clip_uintp2(get_pixel(left, 0, depth) +
+                                         ((get_pixel(top, x, depth) -
+                                           get_pixel(top, -1, depth)) >> 1),
+                                         depth), depth);
+        }
+    }
+}
+
+#define PRED_FUNCS(depth, opt)                                                 \
+static const pred_dc_func pred_dc_ ## depth ## _ ## opt ## _tab[4] = {         \
+    ff_hevc_pred_dc_4_  ## depth ## _ ## opt,                                  \
+    ff_hevc_pred_dc_8_  ## depth ## _ ## opt,                                  \
+    ff_hevc_pred_dc_16_ ## depth ## _ ## opt,                                  \
+    ff_hevc_pred_dc_32_ ## depth ## _ ## opt,                                  \
+};                                                                             \
+                                                                               \
+static void pred_dc_ ## depth ## _ ## opt(uint8_t *src, const uint8_t *top,    \
+                                          const uint8_t *left,                 \
+                                          ptrdiff_t stride, int log2_size,     \
+                                          int c_idx)                           \
+{                                                                              \
+    pred_dc(src, top, left, stride, log2_size, c_idx, depth,                   \
+            pred_dc_ ## depth ## _ ## opt ## _tab);                            \
+}                                                                              \
+                                                                               \
+PRED_ANGULAR(2,  4, depth, opt)                                                \
+PRED_ANGULAR(3,  8, depth, opt)                                                \
+PRED_ANGULAR(4, 16, depth, opt)                                                \
+PRED_ANGULAR(5, 32, depth, opt)
+
+#define PRED_ANGULAR(log2_size, size, depth, opt)                              \
+static void pred_angular_ ## size ## _ ## depth ## _ ## opt(uint8_t *src,      \
+                                                            const uint8_t *top, \
+                                                            const uint8_t *left, \
+                                                            ptrdiff_t stride,  \
+                                                            int c_idx, int mode) \
+{                                                                              \
+    pred_angular(src, top, left, stride, c_idx, mode, log2_size, depth,        \
+                 ff_hevc_pred_angular_rows_ ## size ## _ ## depth ## _ ## opt, \
+                 ff_hevc_transpose_ ## size ## _ ## depth ## _sse4);           \
+}
+
+#if HAVE_X86ASM
+PRED_FUNCS( 8, sse4)
+PRED_FUNCS(10, sse4)
+PRED_ANGULAR(5, 32,  8, avx2)
+PRED_ANGULAR(4, 16, 10, avx2)
+PRED_ANGULAR(5, 32, 10, avx2)
+#endif /* HAVE_X86ASM */
+
+av_cold void ff_hevc_pred_init_x86(HEVCPredContext *hpc, int bit_depth)
+{
+#if HAVE_X86ASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (bit_depth == 8) {
+        if (EXTERNAL_SSE4(cpu_flags)) {
+            hpc->pred_planar[0] = ff_hevc_pred_planar_4_8_sse4;
+            hpc->pred_planar[1] = ff_hevc_pred_planar_8_8_sse4;
+            hpc->pred_planar[2] = ff_hevc_pred_planar_16_8_sse4;
+            hpc->pred_planar[3] = ff_hevc_pred_planar_32_8_sse4;
+            hpc->pred_dc        = pred_dc_8_sse4;
+        }
+        if (ARCH_X86_64 && EXTERNAL_SSE4(cpu_flags)) {
+            hpc->pred_angular[0] = pred_angular_4_8_sse4;
+            hpc->pred_angular[1] = pred_angular_8_8_sse4;
+            hpc->pred_angular[2] = pred_angular_16_8_sse4;
+            hpc->pred_angular[3] = pred_angular_32_8_sse4;
+        }
+        if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(cpu_flags))
+            hpc->pred_angular[3] = pred_angular_32_8_avx2;
+    } else if (bit_depth == 10) {
+        if (EXTERNAL_SSE4(cpu_flags))
+            hpc->pred_dc = pred_dc_10_sse4;
+        if (ARCH_X86_64 && EXTERNAL_SSE4(cpu_flags)) {
+            hpc->pred_angular[0] = pred_angular_4_10_sse4;
+            hpc->pred_angular[1] = pred_angular_8_10_sse4;
+            hpc->pred_angular[2] = pred_angular_16_10_sse4;
+            hpc->pred_angular[3] = pred_angular_32_10_sse4;
+        }
+        if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(cpu_flags)) {
+            hpc->pred_angular[2] = pred_angular_16_10_avx2;
+            hpc->pred_angular[3] = pred_angular_32_10_avx2;
+        }
+    }
+#endif /* HAVE_X86ASM */
+}
@@ -154,6 +154,10 @@ static int config_output(AVFilterLink *outlink)
         av_opt_set_int(aresample->swr, "ich", inlink->channels, 0);
     if (!outlink->channel_layout)
         av_opt_set_int(aresample->swr, "och", outlink->channels, 0);
+    /* "threads" is an option of the filter itself, only use more threads
+     * if it was set for this instance, not for auto-inserted filters */
+    if (ctx->nb_threads > 0)
+        av_opt_set_int(aresample->swr, "threads", ff_filter_get_nb_threads(ctx), 0);
 
     ret = swr_init(aresample->swr);
     if (ret < 0)
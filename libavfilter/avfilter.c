@@ -192,19 +192,28 @@ int avfilter_link_get_channels(AVFilterLink *link)
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    ff_filter_graph_lock(filter->graph);
+    if (priority > filter->ready) {
+        filter->ready = priority;
+        ff_filter_graph_update_ready(filter);
+    }
+    ff_filter_graph_unlock(filter->graph);
 }
 
 /**
  * Clear frame_blocked_in on all outputs.
  * This is necessary whenever something changes on input.
+ * Filters activated concurrently can share filter as destination, hence
+ * the graph lock.
  */
 static void filter_unblock(AVFilterContext *filter)
 {
     unsigned i;
 
+    ff_filter_graph_lock(filter->graph);
     for (i = 0; i < filter->nb_outputs; i++)
         filter->outputs[i]->frame_blocked_in = 0;
+    ff_filter_graph_unlock(filter->graph);
 }
 
 
@@ -529,11 +538,13 @@ void ff_update_link_current_pts(AVFilterLink *link, int64_t pts)
 {
     if (pts == AV_NOPTS_VALUE)
         return;
+    ff_filter_graph_lock(link->graph);
     link->current_pts = pts;
     link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
     if (link->graph && link->age_index >= 0)
         ff_avfilter_graph_update_heap(link->graph, link);
+    ff_filter_graph_unlock(link->graph);
 }
 
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags)
@@ -694,6 +705,7 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
     if (!ret->internal)
         goto err;
     ret->internal->execute = default_execute;
+    ret->internal->ready_index = -1;
 
     ret->nb_inputs = avfilter_pad_count(filter->inputs);
     if (ret->nb_inputs ) {
@@ -1364,7 +1376,8 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      ff_avfilter_link_set_out_status().
 
    Filters are activated according to the ready field, set using the
-   ff_filter_set_ready(). Eventually, a priority queue will be used.
+   ff_filter_set_ready(). The graph keeps the ready filters in a priority
+   queue, see ff_filter_graph_update_ready().
    ff_filter_set_ready() is called whenever anything could cause progress to
    be possible. Marking a filter ready when it is not is not a problem,
    except for the small overhead it causes.
@@ -1436,7 +1449,10 @@ int ff_filter_activate(AVFilterContext *filter)
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
+    ff_filter_graph_lock(filter->graph);
     filter->ready = 0;
+    ff_filter_graph_update_ready(filter);
+    ff_filter_graph_unlock(filter->graph);
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
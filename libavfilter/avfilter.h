@@ -332,6 +332,13 @@ typedef struct AVFilter {
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Activate independent filters of a graph concurrently, e.g. the branches
+ * following a split. Only meaningful for AVFilterGraph.thread_type, and
+ * must be set before adding any filters to the graph.
+ */
+#define AVFILTER_THREAD_BRANCH (1 << 1)
+
 typedef struct AVFilterInternal AVFilterInternal;
 
 /** An instance of a filter */
@@ -50,6 +50,7 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "branch", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_BRANCH }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads),
         AV_OPT_TYPE_INT,   { .i64 = 0 }, 0, INT_MAX, F|V|A },
     {"scale_sws_opts"       , "default scale filter options"        , OFFSET(scale_sws_opts)        ,
@@ -95,18 +96,125 @@ AVFilterGraph *avfilter_graph_alloc(void)
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
+    ff_mutex_init(&ret->internal->lock, NULL);
 
     return ret;
 }
 
+void ff_filter_graph_lock(AVFilterGraph *graph)
+{
+    if (graph && graph->internal->branch_active)
+        ff_mutex_lock(&graph->internal->lock);
+}
+
+void ff_filter_graph_unlock(AVFilterGraph *graph)
+{
+    if (graph && graph->internal->branch_active)
+        ff_mutex_unlock(&graph->internal->lock);
+}
+
+/* Tell if filter a must be activated before filter b. */
+static int ready_before(const AVFilterContext *a, const AVFilterContext *b)
+{
+    if (a->ready != b->ready)
+        return a->ready > b->ready;
+    return a->internal->graph_index < b->internal->graph_index;
+}
+
+static void ready_heap_set(AVFilterContext **heap, unsigned i,
+                           AVFilterContext *filter)
+{
+    heap[i] = filter;
+    filter->internal->ready_index = i;
+}
+
+static void ready_heap_sift_up(AVFilterContext **heap, unsigned i)
+{
+    AVFilterContext *filter = heap[i];
+
+    while (i) {
+        unsigned parent = (i - 1) / 2;
+        if (!ready_before(filter, heap[parent]))
+            break;
+        ready_heap_set(heap, i, heap[parent]);
+        i = parent;
+    }
+    ready_heap_set(heap, i, filter);
+}
+
+static void ready_heap_sift_down(AVFilterContext **heap, unsigned nb,
+                                 unsigned i)
+{
+    AVFilterContext *filter = heap[i];
+
+    while (2 * i + 1 < nb) {
+        unsigned child = 2 * i + 1;
+        if (child + 1 < nb && ready_before(heap[child + 1], heap[child]))
+            child++;
+        if (!ready_before(heap[child], filter))
+            break;
+        ready_heap_set(heap, i, heap[child]);
+        i = child;
+    }
+    ready_heap_set(heap, i, filter);
+}
+
+static void ready_heap_remove(AVFilterGraphInternal *gi, AVFilterContext *filter)
+{
+    unsigned i = filter->internal->ready_index;
+    AVFilterContext *last;
+
+    filter->internal->ready_index = -1;
+    last = gi->ready_heap[--gi->nb_ready];
+    if (last == filter)
+        return;
+    ready_heap_set(gi->ready_heap, i, last);
+    ready_heap_sift_up(gi->ready_heap, i);
+    ready_heap_sift_down(gi->ready_heap, gi->nb_ready,
+                         last->internal->ready_index);
+}
+
+void ff_filter_graph_update_ready(AVFilterContext *filter)
+{
+    AVFilterGraphInternal *gi;
+    int i = filter->internal->ready_index;
+
+    if (!filter->graph)
+        return;
+    gi = filter->graph->internal;
+
+    if (!filter->ready) {
+        if (i >= 0)
+            ready_heap_remove(gi, filter);
+        return;
+    }
+    if (i < 0) {
+        i = gi->nb_ready++;
+        ready_heap_set(gi->ready_heap, i, filter);
+    }
+    ready_heap_sift_up(gi->ready_heap, i);
+    ready_heap_sift_down(gi->ready_heap, gi->nb_ready,
+                         filter->internal->ready_index);
+}
+
 void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter)
 {
     int i, j;
     for (i = 0; i < graph->nb_filters; i++) {
         if (graph->filters[i] == filter) {
+            AVFilterContext *moved = graph->filters[graph->nb_filters - 1];
+
+            if (filter->internal->ready_index >= 0)
+                ready_heap_remove(graph->internal, filter);
             FFSWAP(AVFilterContext*, graph->filters[i],
                    graph->filters[graph->nb_filters - 1]);
             graph->nb_filters--;
+            /* The last filter took the place of the removed one, which may
+             * move it ahead of other filters with the same ready value. */
+            moved->internal->graph_index = i;
+            if (moved != filter && moved->internal->ready_index >= 0)
+                ready_heap_sift_up(graph->internal->ready_heap,
+                                   moved->internal->ready_index);
             filter->graph = NULL;
             for (j = 0; j<filter->nb_outputs; j++)
                 if (filter->outputs[j])
@@ -135,6 +243,8 @@ void avfilter_graph_free(AVFilterGraph **graph)
     av_freep(&(*graph)->resample_lavr_opts);
 #endif
     av_freep(&(*graph)->filters);
+    av_freep(&(*graph)->internal->ready_heap);
+    ff_mutex_destroy(&(*graph)->internal->lock);
     av_freep(&(*graph)->internal);
     av_freep(graph);
 }
@@ -171,7 +281,7 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
                                              const AVFilter *filter,
                                              const char *name)
 {
-    AVFilterContext **filters, *s;
+    AVFilterContext **filters, **ready_heap, *s;
 
     if (graph->thread_type && !graph->internal->thread_execute) {
         if (graph->execute) {
@@ -196,6 +306,16 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
     }
 
     graph->filters = filters;
+
+    ready_heap = av_realloc_array(graph->internal->ready_heap,
+                                  graph->nb_filters + 1, sizeof(*ready_heap));
+    if (!ready_heap) {
+        avfilter_free(s);
+        return NULL;
+    }
+    graph->internal->ready_heap = ready_heap;
+
+    s->internal->graph_index = graph->nb_filters;
     graph->filters[graph->nb_filters++] = s;
 
     s->graph = graph;
@@ -1441,17 +1561,75 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
-int ff_filter_graph_run_once(AVFilterGraph *graph)
+/*
+ * Mark the filters that must not be activated concurrently with filter:
+ * itself, its neighbours, and the filters two links upstream or downstream.
+ * The latter are excluded because activating a filter clears
+ * frame_blocked_in on the outputs of the filters it sends frames to.
+ * Filters sharing a neighbour may run concurrently, their accesses to the
+ * neighbour's ready value and to the frame_blocked_in flags of its outputs
+ * are protected by the graph lock.
+ */
+static void branch_mark(AVFilterContext *filter, unsigned stamp)
 {
-    AVFilterContext *filter;
-    unsigned i;
+    unsigned i, j;
 
+    filter->internal->branch_stamp = stamp;
+    for (i = 0; i < filter->nb_inputs; i++) {
+        AVFilterContext *src = filter->inputs[i]->src;
+        src->internal->branch_stamp = stamp;
+        for (j = 0; j < src->nb_inputs; j++)
+            src->inputs[j]->src->internal->branch_stamp = stamp;
+    }
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterContext *dst = filter->outputs[i]->dst;
+        dst->internal->branch_stamp = stamp;
+        for (j = 0; j < dst->nb_outputs; j++)
+            dst->outputs[j]->dst->internal->branch_stamp = stamp;
+    }
+}
+
+static int run_branches(AVFilterGraph *graph)
+{
+    AVFilterGraphInternal *gi = graph->internal;
+    AVFilterContext **filters = gi->branch_filters;
+    unsigned stamp = ++gi->branch_stamp;
+    int i, nb_filters = 0, ret = 0;
+
+    if (gi->ready_heap[0]->filter->flags_internal & FF_FILTER_FLAG_SERIAL)
+        return ff_filter_activate(gi->ready_heap[0]);
+
+    /* The heap array is roughly sorted by priority, so walking it picks the
+     * most urgent filters first. */
+    for (i = 0; i < gi->nb_ready && nb_filters < gi->nb_branch_threads; i++) {
+        AVFilterContext *filter = gi->ready_heap[i];
+        if (filter->internal->branch_stamp == stamp ||
+            filter->filter->flags_internal & FF_FILTER_FLAG_SERIAL)
+            continue;
+        branch_mark(filter, stamp);
+        filters[nb_filters++] = filter;
+    }
+    if (nb_filters == 1)
+        return ff_filter_activate(filters[0]);
+
+    gi->branch_active = 1;
+    gi->branch_execute(graph, filters, gi->branch_rets, nb_filters);
+    gi->branch_active = 0;
+
+    for (i = 0; i < nb_filters; i++)
+        if (gi->branch_rets[i] < 0) {
+            ret = gi->branch_rets[i];
+            break;
+        }
+    return ret;
+}
+
+int ff_filter_graph_run_once(AVFilterGraph *graph)
+{
     av_assert0(graph->nb_filters);
-    filter = graph->filters[0];
-    for (i = 1; i < graph->nb_filters; i++)
-        if (graph->filters[i]->ready > filter->ready)
-            filter = graph->filters[i];
-    if (!filter->ready)
+    if (!graph->internal->nb_ready)
         return AVERROR(EAGAIN);
-    return ff_filter_activate(filter);
+    if (graph->internal->branch_execute && graph->internal->nb_ready > 1)
+        return run_branches(graph);
+    return ff_filter_activate(graph->internal->ready_heap[0]);
 }
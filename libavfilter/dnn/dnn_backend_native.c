@@ -109,11 +109,30 @@ static DNNReturnType set_input_output_native(void *model, DNNData *input, const
     return DNN_SUCCESS;
 }
 
+static void native_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    NativeContext *ctx = priv;
+    ctx->job_func(ctx->job_arg, jobnr, nb_jobs);
+}
+
+void dnn_native_execute_jobs(NativeContext *ctx, int (*func)(void *arg, int jobnr, int nb_jobs),
+                             void *arg, int nb_jobs)
+{
+    if (ctx && ctx->slicethread && nb_jobs > 1) {
+        ctx->job_func = func;
+        ctx->job_arg  = arg;
+        avpriv_slicethread_execute(ctx->slicethread, nb_jobs, 0);
+    } else {
+        for (int i = 0; i < nb_jobs; i++)
+            func(arg, i, nb_jobs);
+    }
+}
+
 // Loads model and its parameters that are stored in a binary file with following structure:
 // layers_num,layer_type,layer_parameterss,layer_type,layer_parameters...
 // For CONV layer: activation_function, input_num, output_num, kernel_size, kernel, biases
 // For DEPTH_TO_SPACE layer: block_size
-DNNModel *ff_dnn_load_model_native(const char *model_filename)
+DNNModel *ff_dnn_load_model_native(const char *model_filename, int nb_threads)
 {
     DNNModel *model = NULL;
     char header_expected[] = "FFMPEGDNNNATIVE";
@@ -244,6 +263,16 @@ DNNModel *ff_dnn_load_model_native(const char *model_filename)
     model->set_input_output = &set_input_output_native;
     model->get_input = &get_input_native;
 
+    // run single-threaded if the slice threads are not available
+    network->ctx.nb_threads = 1;
+    if (nb_threads > 1)
+        network->ctx.nb_threads = avpriv_slicethread_create(&network->ctx.slicethread, &network->ctx,
+                                                            native_worker, NULL, nb_threads);
+    if (network->ctx.nb_threads <= 1) {
+        avpriv_slicethread_free(&network->ctx.slicethread);
+        network->ctx.nb_threads = 1;
+    }
+
     return model;
 
 fail:
@@ -268,7 +297,8 @@ DNNReturnType ff_dnn_execute_model_native(const DNNModel *model, DNNData *output
         layer_funcs[layer_type].pf_exec(network->operands,
                                   network->layers[layer].input_operand_indexes,
                                   network->layers[layer].output_operand_index,
-                                  network->layers[layer].params);
+                                  network->layers[layer].params,
+                                  &network->ctx);
     }
 
     for (uint32_t i = 0; i < nb; ++i) {
@@ -327,6 +357,7 @@ void ff_dnn_free_model_native(DNNModel **model)
             }
 
             av_freep(&network->output_indexes);
+            avpriv_slicethread_free(&network->ctx.slicethread);
             av_freep(&network);
         }
         av_freep(model);
@@ -29,6 +29,7 @@
 
 #include "../dnn_interface.h"
 #include "libavformat/avio.h"
+#include "libavutil/slicethread.h"
 
 /**
  * the enum value of DNNLayerType should not be changed,
@@ -100,6 +101,18 @@ typedef struct DnnOperand{
     int32_t usedNumbersLeft;
 }DnnOperand;
 
+/**
+ * Execution state shared by all the layers of a network,
+ * may be NULL, in which case layers run single-threaded.
+ */
+typedef struct NativeContext{
+    AVSliceThread *slicethread;
+    int nb_threads;
+    /* the job currently being run by the slice threads */
+    int (*job_func)(void *arg, int jobnr, int nb_jobs);
+    void *job_arg;
+} NativeContext;
+
 typedef struct InputParams{
     int height, width, channels;
 } InputParams;
@@ -112,14 +125,22 @@ typedef struct ConvolutionalNetwork{
     int32_t operands_num;
     int32_t *output_indexes;
     uint32_t nb_output;
+    NativeContext ctx;
 } ConvolutionalNetwork;
 
-DNNModel *ff_dnn_load_model_native(const char *model_filename);
+DNNModel *ff_dnn_load_model_native(const char *model_filename, int nb_threads);
 
 DNNReturnType ff_dnn_execute_model_native(const DNNModel *model, DNNData *outputs, uint32_t nb_output);
 
 void ff_dnn_free_model_native(DNNModel **model);
 
+/**
+ * Run func(arg, jobnr, nb_jobs) for every jobnr in [0, nb_jobs),
+ * on the slice threads of ctx when there are any.
+ */
+void dnn_native_execute_jobs(NativeContext *ctx, int (*func)(void *arg, int jobnr, int nb_jobs),
+                             void *arg, int nb_jobs);
+
 int32_t calculate_operand_data_length(const DnnOperand *oprd);
 int32_t calculate_operand_dims_count(const DnnOperand *oprd);
 #endif
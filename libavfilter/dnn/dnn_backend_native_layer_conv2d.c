@@ -88,45 +88,39 @@ int dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int fil
     return dnn_size;
 }
 
-int dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_indexes,
-                             int32_t output_operand_index, const void *parameters)
-{
+typedef struct ThreadCommonParam{
+    const ConvolutionalParams *conv_params;
+    const float *input;
     float *output;
-    int32_t input_operand_index = input_operand_indexes[0];
-    int number = operands[input_operand_index].dims[0];
-    int height = operands[input_operand_index].dims[1];
-    int width = operands[input_operand_index].dims[2];
-    int channel = operands[input_operand_index].dims[3];
-    const float *input = operands[input_operand_index].data;
-    const ConvolutionalParams *conv_params = (const ConvolutionalParams *)parameters;
+    int height, width, pad_size;
+} ThreadCommonParam;
+
+static int dnn_execute_layer_conv2d_slice(void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadCommonParam *thread_param = arg;
+    const ConvolutionalParams *conv_params = thread_param->conv_params;
+    const float *input = thread_param->input;
+    int height = thread_param->height;
+    int width = thread_param->width;
+    int pad_size = thread_param->pad_size;
 
     int radius = conv_params->kernel_size >> 1;
     int src_linesize = width * conv_params->input_num;
     int filter_linesize = conv_params->kernel_size * conv_params->input_num;
     int filter_size = conv_params->kernel_size * filter_linesize;
-    int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
-
-    DnnOperand *output_operand = &operands[output_operand_index];
-    output_operand->dims[0] = number;
-    output_operand->dims[1] = height - pad_size * 2;
-    output_operand->dims[2] = width - pad_size * 2;
-    output_operand->dims[3] = conv_params->output_num;
-    output_operand->data_type = operands[input_operand_index].data_type;
-    output_operand->length = calculate_operand_data_length(output_operand);
-    output_operand->data = av_realloc(output_operand->data, output_operand->length);
-    if (!output_operand->data)
-        return -1;
-    output = output_operand->data;
-
-    av_assert0(channel == conv_params->input_num);
-
-    for (int y = pad_size; y < height - pad_size; ++y) {
+    int out_height = height - pad_size * 2;
+    int out_width = width - pad_size * 2;
+    int slice_start = pad_size + out_height *  jobnr      / nb_jobs;
+    int slice_end   = pad_size + out_height * (jobnr + 1) / nb_jobs;
+    float *output = thread_param->output +
+                    (slice_start - pad_size) * out_width * conv_params->output_num;
+
+    for (int y = slice_start; y < slice_end; ++y) {
         for (int x = pad_size; x < width - pad_size; ++x) {
             for (int n_filter = 0; n_filter < conv_params->output_num; ++n_filter) {
-                if (conv_params->has_bias)
-                    output[n_filter] = conv_params->biases[n_filter];
-                else
-                    output[n_filter] = 0.f;
+                const float *kernel = conv_params->kernel + n_filter * filter_size;
+                // accumulate locally, output may alias anything as far as the compiler knows
+                float sum = conv_params->has_bias ? conv_params->biases[n_filter] : 0.f;
 
                 for (int ch = 0; ch < conv_params->input_num; ++ch) {
                     for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
@@ -143,30 +137,70 @@ int dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_
                                                    input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
                             }
 
-
-                            output[n_filter] += input_pel * conv_params->kernel[n_filter * filter_size + kernel_y * filter_linesize +
-                                                                                kernel_x * conv_params->input_num + ch];
+                            sum += input_pel * kernel[kernel_y * filter_linesize +
+                                                      kernel_x * conv_params->input_num + ch];
                         }
                     }
                 }
                 switch (conv_params->activation){
                 case RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0);
+                    sum = FFMAX(sum, 0.0);
                     break;
                 case TANH:
-                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * output[n_filter])) - 1.0f;
+                    sum = 2.0f  / (1.0f + exp(-2.0f * sum)) - 1.0f;
                     break;
                 case SIGMOID:
-                    output[n_filter] = 1.0f / (1.0f + exp(-output[n_filter]));
+                    sum = 1.0f / (1.0f + exp(-sum));
                     break;
                 case NONE:
                     break;
                 case LEAKY_RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0) + 0.2 * FFMIN(output[n_filter], 0.0);
+                    sum = FFMAX(sum, 0.0) + 0.2 * FFMIN(sum, 0.0);
                 }
+                output[n_filter] = sum;
             }
             output += conv_params->output_num;
         }
     }
     return 0;
 }
+
+int dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_indexes,
+                             int32_t output_operand_index, const void *parameters, NativeContext *ctx)
+{
+    ThreadCommonParam thread_param;
+    int32_t input_operand_index = input_operand_indexes[0];
+    int number = operands[input_operand_index].dims[0];
+    int height = operands[input_operand_index].dims[1];
+    int width = operands[input_operand_index].dims[2];
+    int channel = operands[input_operand_index].dims[3];
+    const ConvolutionalParams *conv_params = (const ConvolutionalParams *)parameters;
+    int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
+    int nb_jobs;
+
+    DnnOperand *output_operand = &operands[output_operand_index];
+    output_operand->dims[0] = number;
+    output_operand->dims[1] = height - pad_size * 2;
+    output_operand->dims[2] = width - pad_size * 2;
+    output_operand->dims[3] = conv_params->output_num;
+    output_operand->data_type = operands[input_operand_index].data_type;
+    output_operand->length = calculate_operand_data_length(output_operand);
+    output_operand->data = av_realloc(output_operand->data, output_operand->length);
+    if (!output_operand->data)
+        return -1;
+
+    av_assert0(channel == conv_params->input_num);
+
+    thread_param.conv_params = conv_params;
+    thread_param.input = operands[input_operand_index].data;
+    thread_param.output = output_operand->data;
+    thread_param.height = height;
+    thread_param.width = width;
+    thread_param.pad_size = pad_size;
+
+    // every job computes a band of output rows
+    nb_jobs = FFMIN(height - pad_size * 2, ctx ? ctx->nb_threads : 1);
+    dnn_native_execute_jobs(ctx, dnn_execute_layer_conv2d_slice, &thread_param, nb_jobs);
+
+    return 0;
+}
@@ -155,7 +155,7 @@ err:
     return DNN_ERROR;
 }
 
-DNNModel *ff_dnn_load_model_ov(const char *model_filename)
+DNNModel *ff_dnn_load_model_ov(const char *model_filename, int nb_threads)
 {
     DNNModel *model = NULL;
     OVModel *ov_model = NULL;
@@ -28,6 +28,25 @@
 #include "dnn_backend_tf.h"
 #include "dnn_backend_openvino.h"
 #include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+struct DNNAsyncExecutor {
+    DNNModule *module;
+    DNNModel *model;
+
+    // the execution in progress, protected by mutex when threaded
+    DNNData *outputs;
+    uint32_t nb_output;
+    DNNReturnType result;
+    int busy;
+
+#if HAVE_THREADS
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int quit;
+#endif
+};
 
 DNNModule *ff_get_dnn_module(DNNBackendType backend_type)
 {
@@ -72,3 +91,118 @@ DNNModule *ff_get_dnn_module(DNNBackendType backend_type)
 
     return dnn_module;
 }
+
+#if HAVE_THREADS
+static void *async_worker(void *arg)
+{
+    DNNAsyncExecutor *exec = arg;
+
+    pthread_mutex_lock(&exec->mutex);
+    while (1) {
+        while (!exec->busy && !exec->quit)
+            pthread_cond_wait(&exec->cond, &exec->mutex);
+        if (exec->quit)
+            break;
+
+        pthread_mutex_unlock(&exec->mutex);
+        exec->result = (exec->module->execute_model)(exec->model, exec->outputs, exec->nb_output);
+        pthread_mutex_lock(&exec->mutex);
+
+        exec->busy = 0;
+        pthread_cond_broadcast(&exec->cond);
+    }
+    pthread_mutex_unlock(&exec->mutex);
+
+    return NULL;
+}
+#endif
+
+DNNAsyncExecutor *ff_dnn_async_create(DNNModule *module, DNNModel *model)
+{
+    DNNAsyncExecutor *exec = av_mallocz(sizeof(*exec));
+    if (!exec)
+        return NULL;
+
+    exec->module = module;
+    exec->model = model;
+
+#if HAVE_THREADS
+    if (pthread_mutex_init(&exec->mutex, NULL)) {
+        av_freep(&exec);
+        return NULL;
+    }
+    if (pthread_cond_init(&exec->cond, NULL)) {
+        pthread_mutex_destroy(&exec->mutex);
+        av_freep(&exec);
+        return NULL;
+    }
+    if (pthread_create(&exec->thread, NULL, async_worker, exec)) {
+        pthread_cond_destroy(&exec->cond);
+        pthread_mutex_destroy(&exec->mutex);
+        av_freep(&exec);
+        return NULL;
+    }
+#endif
+
+    return exec;
+}
+
+DNNReturnType ff_dnn_async_start(DNNAsyncExecutor *exec, DNNData *outputs, uint32_t nb_output)
+{
+#if HAVE_THREADS
+    pthread_mutex_lock(&exec->mutex);
+    if (exec->busy) {
+        pthread_mutex_unlock(&exec->mutex);
+        return DNN_ERROR;
+    }
+    exec->outputs = outputs;
+    exec->nb_output = nb_output;
+    exec->busy = 1;
+    pthread_cond_broadcast(&exec->cond);
+    pthread_mutex_unlock(&exec->mutex);
+#else
+    if (exec->busy)
+        return DNN_ERROR;
+    exec->result = (exec->module->execute_model)(exec->model, outputs, nb_output);
+    exec->busy = 1;
+#endif
+
+    return DNN_SUCCESS;
+}
+
+DNNReturnType ff_dnn_async_wait(DNNAsyncExecutor *exec)
+{
+#if HAVE_THREADS
+    pthread_mutex_lock(&exec->mutex);
+    while (exec->busy)
+        pthread_cond_wait(&exec->cond, &exec->mutex);
+    pthread_mutex_unlock(&exec->mutex);
+#else
+    exec->busy = 0;
+#endif
+
+    return exec->result;
+}
+
+void ff_dnn_async_free(DNNAsyncExecutor **pexec)
+{
+    DNNAsyncExecutor *exec = *pexec;
+
+    if (!exec)
+        return;
+
+#if HAVE_THREADS
+    pthread_mutex_lock(&exec->mutex);
+    while (exec->busy)
+        pthread_cond_wait(&exec->cond, &exec->mutex);
+    exec->quit = 1;
+    pthread_cond_broadcast(&exec->cond);
+    pthread_mutex_unlock(&exec->mutex);
+
+    pthread_join(exec->thread, NULL);
+    pthread_cond_destroy(&exec->cond);
+    pthread_mutex_destroy(&exec->mutex);
+#endif
+
+    av_freep(pexec);
+}
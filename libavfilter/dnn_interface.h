@@ -54,7 +54,9 @@ typedef struct DNNModel{
 // Stores pointers to functions for loading, executing, freeing DNN models for one of the backends.
 typedef struct DNNModule{
     // Loads model and parameters from given file. Returns NULL if it is not possible.
-    DNNModel *(*load_model)(const char *model_filename);
+    // nb_threads is the number of threads one execution may use, backends that
+    // manage their own threading ignore it.
+    DNNModel *(*load_model)(const char *model_filename, int nb_threads);
     // Executes model with specified input and output. Returns DNN_ERROR otherwise.
     DNNReturnType (*execute_model)(const DNNModel *model, DNNData *outputs, uint32_t nb_output);
     // Frees memory allocated for model.
@@ -64,4 +66,18 @@ typedef struct DNNModule{
 // Initializes DNNModule depending on chosen backend.
 DNNModule *ff_get_dnn_module(DNNBackendType backend_type);
 
+// Runs execute_model of a module on a dedicated thread, for any backend.
+// Every executor drives its own model, several of them can run concurrently.
+typedef struct DNNAsyncExecutor DNNAsyncExecutor;
+
+// Creates an executor for model, which must stay valid until the executor is freed.
+DNNAsyncExecutor *ff_dnn_async_create(DNNModule *module, DNNModel *model);
+// Starts executing the model with its current input and returns without waiting.
+// outputs must stay valid until ff_dnn_async_wait() returns.
+DNNReturnType ff_dnn_async_start(DNNAsyncExecutor *exec, DNNData *outputs, uint32_t nb_output);
+// Waits for the execution started by ff_dnn_async_start() and returns its result.
+DNNReturnType ff_dnn_async_wait(DNNAsyncExecutor *exec);
+// Waits for any pending execution and frees the executor.
+void ff_dnn_async_free(DNNAsyncExecutor **exec);
+
 #endif
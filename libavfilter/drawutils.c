@@ -602,17 +602,53 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
 {
     int x;
 
+    if (!hsub && !vsub && l2depth == 3) {
+        /* one 8-bit mask value per pixel, nothing to average */
+        mask += xm;
+        if (dst_delta == 1) {
+            for (x = 0; x < w; x++) {
+                const unsigned a = mask[x] * alpha;
+                dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+            }
+        } else {
+            for (x = 0; x < w; x++) {
+                const unsigned a = mask[x] * alpha;
+                *dst = ((0x1010101 - a) * *dst + a * src) >> 24;
+                dst += dst_delta;
+            }
+        }
+        return;
+    }
+
     if (left) {
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
                     left, hband, hsub + vsub, xm);
         dst += dst_delta;
         xm += left;
     }
-    for (x = 0; x < w; x++) {
-        blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
-                    1 << hsub, hband, hsub + vsub, xm);
-        dst += dst_delta;
-        xm += 1 << hsub;
+    if (l2depth == 3) {
+        /* 8-bit mask: sum the block directly, empty blocks leave dst as is */
+        for (x = 0; x < w; x++) {
+            const uint8_t *m = mask + xm;
+            unsigned t = 0, i, j;
+
+            for (j = 0; j < hband; j++, m += mask_linesize)
+                for (i = 0; i < 1 << hsub; i++)
+                    t += m[i];
+            if (t) {
+                const unsigned a = (t >> (hsub + vsub)) * alpha;
+                *dst = ((0x1010101 - a) * *dst + a * src) >> 24;
+            }
+            dst += dst_delta;
+            xm += 1 << hsub;
+        }
+    } else {
+        for (x = 0; x < w; x++) {
+            blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
+                        1 << hsub, hband, hsub + vsub, xm);
+            dst += dst_delta;
+            xm += 1 << hsub;
+        }
     }
     if (right)
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
@@ -25,6 +25,7 @@
  */
 
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "framepool.h"
@@ -134,14 +135,62 @@ struct AVFilterPad {
     int needs_writable;
 };
 
+typedef int (avfilter_branch_execute_func)(AVFilterGraph *graph,
+                                           AVFilterContext **filters,
+                                           int *rets, int nb_filters);
+
 struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Activate the given filters concurrently, set when the graph uses
+     * AVFILTER_THREAD_BRANCH.
+     */
+    avfilter_branch_execute_func *branch_execute;
+    AVFilterContext **branch_filters;
+    int *branch_rets;
+    int nb_branch_threads;
+    unsigned branch_stamp;
+
+    /**
+     * Set while filters are being activated concurrently. The ready heap,
+     * the sink links heap and the frame_blocked_in flags of the outputs of a
+     * filter must then only be modified with lock held.
+     */
+    int branch_active;
+    AVMutex lock;
+
+    /**
+     * Binary heap of the filters with a non-zero ready value, ordered by
+     * decreasing ready value, then by increasing position in the graph.
+     * It has room for graph->nb_filters entries.
+     */
+    AVFilterContext **ready_heap;
+    unsigned nb_ready;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+
+    /**
+     * Position of the filter in graph->filters.
+     */
+    unsigned graph_index;
+
+    /**
+     * Position of the filter in the graph ready heap, or -1 if it is not
+     * in it.
+     */
+    int ready_index;
+
+    /**
+     * Equal to graph->internal->branch_stamp if the filter must not be
+     * activated concurrently with the filters already picked for the current
+     * parallel step.
+     */
+    unsigned branch_stamp;
 };
 
 /**
@@ -368,6 +417,27 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of the graph than its direct neighbours,
+ * so it must not be activated concurrently with any other filter.
+ */
+#define FF_FILTER_FLAG_SERIAL (1 << 1)
+
+/**
+ * Lock the graph state shared between concurrently activated filters.
+ * Does nothing if graph is NULL or no filters are being activated
+ * concurrently.
+ */
+void ff_filter_graph_lock(AVFilterGraph *graph);
+
+void ff_filter_graph_unlock(AVFilterGraph *graph);
+
+/**
+ * Update the position of a filter in the ready heap of its graph after
+ * filter->ready has changed.
+ */
+void ff_filter_graph_update_ready(AVFilterContext *filter);
+
 /**
  * Run one round of processing on a filter graph.
  */
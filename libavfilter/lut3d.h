@@ -0,0 +1,103 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_LUT3D_H
+#define AVFILTER_LUT3D_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "avfilter.h"
+#include "framesync.h"
+
+enum interp_mode {
+    INTERPOLATE_NEAREST,
+    INTERPOLATE_TRILINEAR,
+    INTERPOLATE_TETRAHEDRAL,
+    NB_INTERP_MODE
+};
+
+struct rgbvec {
+    float r, g, b;
+};
+
+/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
+ * of 512x512 (64x64x64) */
+#define MAX_LEVEL 256
+#define PRELUT_SIZE 65536
+
+typedef struct Lut3DPreLut {
+    int size;
+    float min[3];
+    float max[3];
+    float scale[3];
+    float* lut[3];
+} Lut3DPreLut;
+
+/**
+ * Interpolate one line of planar RGB.
+ *
+ * @param dst     output r, g and b planes
+ * @param src     input r, g and b planes
+ * @param lut     lutsize^3 entries, r major
+ * @param scale   per component scale from the normalized input to a LUT
+ *                coordinate for r, g and b, followed by lutsize - 1
+ * @param lutsize number of points per LUT dimension
+ * @param w       number of pixels, SIMD versions are only called with a
+ *                multiple of LUT3DContext.line_block
+ */
+typedef void (*lut3d_interp_line_fn)(uint8_t *const *dst, const uint8_t *const *src,
+                                     const struct rgbvec *lut, const float *scale,
+                                     int lutsize, int w);
+
+typedef struct LUT3DContext {
+    const AVClass *class;
+    int interpolation;          ///<interp_mode
+    char *file;
+    uint8_t rgba_map[4];
+    int step;
+    avfilter_action_func *interp;
+    lut3d_interp_line_fn interp_line;
+    lut3d_interp_line_fn interp_line_c; ///< C version, for the last pixels of a line
+    int line_block;             ///< number of pixels interp_line processes at once
+    struct rgbvec scale;
+    struct rgbvec *lut;
+    int lutsize;
+    int lutsize2;
+    Lut3DPreLut prelut;
+#if CONFIG_HALDCLUT_FILTER
+    uint8_t clut_rgba_map[4];
+    int clut_step;
+    int clut_bits;
+    int clut_planar;
+    int clut_float;
+    int clut_width;
+    FFFrameSync fs;
+#endif
+} LUT3DContext;
+
+/**
+ * Set interp_line, interp_line_c and line_block for the planar format of
+ * the given depth, or interp_line to NULL if there is no line function
+ * for it.
+ */
+void ff_lut3d_init(LUT3DContext *s, int depth, int isfloat);
+void ff_lut3d_init_x86(LUT3DContext *s, int depth, int isfloat);
+
+#endif /* AVFILTER_LUT3D_H */
@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_PALETTEUSE_H
+#define AVFILTER_PALETTEUSE_H
+
+#include <stdint.h>
+
+typedef struct PaletteUseDSPContext {
+    /**
+     * Find the entry of a 256 colors palette nearest to a color.
+     *
+     * @param palette      AVPALETTE_COUNT ARGB colors, entries with an alpha
+     *                     below trans_thresh are ignored
+     * @param argb         the color to look up, as {a, r, g, b}
+     * @param trans_thresh alpha threshold for transparency
+     * @return index of the first nearest entry, 255 if all entries are ignored
+     */
+    int (*nearest_bruteforce)(const uint32_t *palette, const uint8_t *argb,
+                              int trans_thresh);
+} PaletteUseDSPContext;
+
+void ff_paletteuse_init(PaletteUseDSPContext *dsp);
+void ff_paletteuse_init_x86(PaletteUseDSPContext *dsp);
+
+#endif /* AVFILTER_PALETTEUSE_H */
@@ -42,6 +42,15 @@ typedef struct ThreadContext {
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
+
+    /* serializes thread_execute() calls from concurrently activated filters */
+    AVMutex execute_lock;
+
+    AVSliceThread *branch_thread;
+
+    /* per-branch_execute parameters */
+    AVFilterContext **branch_filters;
+    int *branch_rets;
 } ThreadContext;
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
@@ -52,9 +61,17 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
         c->rets[jobnr] = ret;
 }
 
+static void branch_worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ThreadContext *c = priv;
+    c->branch_rets[jobnr] = ff_filter_activate(c->branch_filters[jobnr]);
+}
+
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    avpriv_slicethread_free(&c->branch_thread);
+    ff_mutex_destroy(&c->execute_lock);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -64,12 +81,53 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+    ff_mutex_lock(&c->execute_lock);
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    ff_mutex_unlock(&c->execute_lock);
+    return 0;
+}
+
+static int branch_execute(AVFilterGraph *graph, AVFilterContext **filters,
+                          int *rets, int nb_filters)
+{
+    ThreadContext *c = graph->internal->thread;
+
+    c->branch_filters = filters;
+    c->branch_rets    = rets;
+
+    avpriv_slicethread_execute(c->branch_thread, nb_filters, 0);
+    return 0;
+}
+
+static int branch_thread_init(AVFilterGraph *graph, ThreadContext *c)
+{
+    AVFilterGraphInternal *gi = graph->internal;
+    int nb_threads;
+
+    nb_threads = avpriv_slicethread_create(&c->branch_thread, c,
+                                           branch_worker_func, NULL,
+                                           graph->nb_threads);
+    if (nb_threads <= 1) {
+        avpriv_slicethread_free(&c->branch_thread);
+        return FFMIN(nb_threads, 0);
+    }
+
+    gi->branch_filters = av_malloc_array(nb_threads, sizeof(*gi->branch_filters));
+    gi->branch_rets    = av_malloc_array(nb_threads, sizeof(*gi->branch_rets));
+    if (!gi->branch_filters || !gi->branch_rets) {
+        avpriv_slicethread_free(&c->branch_thread);
+        av_freep(&gi->branch_filters);
+        av_freep(&gi->branch_rets);
+        return AVERROR(ENOMEM);
+    }
+    gi->nb_branch_threads = nb_threads;
+    gi->branch_execute    = branch_execute;
+
     return 0;
 }
 
@@ -83,6 +141,7 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
 
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
+    ThreadContext *c;
     int ret;
 
     if (graph->nb_threads == 1) {
@@ -90,11 +149,11 @@ int ff_graph_thread_init(AVFilterGraph *graph)
         return 0;
     }
 
-    graph->internal->thread = av_mallocz(sizeof(ThreadContext));
-    if (!graph->internal->thread)
+    c = graph->internal->thread = av_mallocz(sizeof(ThreadContext));
+    if (!c)
         return AVERROR(ENOMEM);
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    ret = thread_init_internal(c, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
@@ -103,8 +162,15 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     }
     graph->nb_threads = ret;
 
+    ff_mutex_init(&c->execute_lock, NULL);
     graph->internal->thread_execute = thread_execute;
 
+    if (graph->thread_type & AVFILTER_THREAD_BRANCH) {
+        ret = branch_thread_init(graph, c);
+        if (ret < 0)
+            return ret;
+    }
+
     return 0;
 }
 
@@ -113,4 +179,7 @@ void ff_graph_thread_free(AVFilterGraph *graph)
     if (graph->internal->thread)
         slice_thread_uninit(graph->internal->thread);
     av_freep(&graph->internal->thread);
+    av_freep(&graph->internal->branch_filters);
+    av_freep(&graph->internal->branch_rets);
+    graph->internal->branch_execute = NULL;
 }
@@ -25,6 +25,7 @@
  */
 
 #include <float.h>
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
 #include "avfilter.h"
@@ -44,6 +45,8 @@ typedef struct BlackDetectContext {
     unsigned int pixel_black_th_i;
 
     unsigned int nb_black_pixels;   ///< number of black pixels counted so far
+    unsigned int *counter;          ///< number of black pixels counted by each slice
+    int nb_threads;
 } BlackDetectContext;
 
 #define OFFSET(x) offsetof(BlackDetectContext, x)
@@ -91,6 +94,12 @@ static int config_input(AVFilterLink *inlink)
     AVFilterContext *ctx = inlink->dst;
     BlackDetectContext *blackdetect = ctx->priv;
 
+    blackdetect->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&blackdetect->counter);
+    blackdetect->counter = av_calloc(blackdetect->nb_threads, sizeof(*blackdetect->counter));
+    if (!blackdetect->counter)
+        return AVERROR(ENOMEM);
+
     blackdetect->black_min_duration =
         blackdetect->black_min_duration_time / av_q2d(inlink->time_base);
 
@@ -136,20 +145,43 @@ static int request_frame(AVFilterLink *outlink)
     return ret;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
+static int black_counter(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    AVFilterContext *ctx = inlink->dst;
     BlackDetectContext *blackdetect = ctx->priv;
-    double picture_black_ratio = 0;
-    const uint8_t *p = picref->data[0];
+    AVFrame *picref = arg;
+    const int w = picref->width;
+    const int h = picref->height;
+    const int slice_start = (h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (h * (jobnr+1)) / nb_jobs;
+    const unsigned int threshold = blackdetect->pixel_black_th_i;
+    const uint8_t *p = picref->data[0] + slice_start * picref->linesize[0];
+    unsigned int counter = 0;
     int x, i;
 
-    for (i = 0; i < inlink->h; i++) {
-        for (x = 0; x < inlink->w; x++)
-            blackdetect->nb_black_pixels += p[x] <= blackdetect->pixel_black_th_i;
+    for (i = slice_start; i < slice_end; i++) {
+        for (x = 0; x < w; x++)
+            counter += p[x] <= threshold;
         p += picref->linesize[0];
     }
 
+    blackdetect->counter[jobnr] = counter;
+
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
+{
+    AVFilterContext *ctx = inlink->dst;
+    BlackDetectContext *blackdetect = ctx->priv;
+    double picture_black_ratio = 0;
+    const int nb_jobs = FFMIN(inlink->h, blackdetect->nb_threads);
+    int i;
+
+    ctx->internal->execute(ctx, black_counter, picref, NULL, nb_jobs);
+
+    for (i = 0; i < nb_jobs; i++)
+        blackdetect->nb_black_pixels += blackdetect->counter[i];
+
     picture_black_ratio = (double)blackdetect->nb_black_pixels / (inlink->w * inlink->h);
 
     av_log(ctx, AV_LOG_DEBUG,
@@ -180,6 +212,13 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
     return ff_filter_frame(inlink->dst->outputs[0], picref);
 }
 
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    BlackDetectContext *blackdetect = ctx->priv;
+
+    av_freep(&blackdetect->counter);
+}
+
 static const AVFilterPad blackdetect_inputs[] = {
     {
         .name          = "default",
@@ -204,7 +243,9 @@ AVFilter ff_vf_blackdetect = {
     .description   = NULL_IF_CONFIG_SMALL("Detect video intervals that are (almost) black."),
     .priv_size     = sizeof(BlackDetectContext),
     .query_formats = query_formats,
+    .uninit        = uninit,
     .inputs        = blackdetect_inputs,
     .outputs       = blackdetect_outputs,
     .priv_class    = &blackdetect_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -44,15 +44,24 @@ typedef struct BoxBlurContext {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    uint8_t **temp; ///< pairs of temporary buffers used in blur_power(), one per thread
 } BoxBlurContext;
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int w[4], h[4];
+    int pixsize;
+} ThreadData;
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     BoxBlurContext *s = ctx->priv;
 
-    av_freep(&s->temp[0]);
-    av_freep(&s->temp[1]);
+    for (int i = 0; i < 2 * s->nb_threads; i++)
+        av_freep(&s->temp[i]);
+    av_freep(&s->temp);
+    s->nb_threads = 0;
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -78,11 +87,15 @@ static int config_input(AVFilterLink *inlink)
     AVFilterContext    *ctx = inlink->dst;
     BoxBlurContext *s = ctx->priv;
     int w = inlink->w, h = inlink->h;
-    int ret;
+    int i, ret;
 
-    if (!(s->temp[0] = av_malloc(2*FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(2*FFMAX(w, h))))
+    uninit(ctx);
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    if (!(s->temp = av_calloc(2 * s->nb_threads, sizeof(*s->temp))))
         return AVERROR(ENOMEM);
+    for (i = 0; i < 2 * s->nb_threads; i++)
+        if (!(s->temp[i] = av_malloc(2*FFMAX(w, h))))
+            return AVERROR(ENOMEM);
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
@@ -199,44 +212,81 @@ static inline void blur_power(uint8_t *dst, int dst_step, const uint8_t *src, in
 }
 
 static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+                  int w, int y0, int y1, int radius, int power, uint8_t *temp[2], int pixsize)
 {
     int y;
 
     if (radius == 0 && dst == src)
         return;
 
-    for (y = 0; y < h; y++)
+    for (y = y0; y < y1; y++)
         blur_power(dst + y*dst_linesize, pixsize, src + y*src_linesize, pixsize,
                    w, radius, power, temp, pixsize);
 }
 
 static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+                  int x0, int x1, int h, int radius, int power, uint8_t *temp[2], int pixsize)
 {
     int x;
 
     if (radius == 0 && dst == src)
         return;
 
-    for (x = 0; x < w; x++)
+    for (x = x0; x < x1; x++)
         blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
                    h, radius, power, temp, pixsize);
 }
 
+static int hblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->h[plane] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->h[plane] * (jobnr+1)) / nb_jobs;
+
+        hblur(out->data[plane], out->linesize[plane],
+              in ->data[plane], in ->linesize[plane],
+              td->w[plane], slice_start, slice_end, s->radius[plane], s->power[plane],
+              s->temp + 2 * jobnr, td->pixsize);
+    }
+
+    return 0;
+}
+
+static int vblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->w[plane] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->w[plane] * (jobnr+1)) / nb_jobs;
+
+        vblur(out->data[plane], out->linesize[plane],
+              out->data[plane], out->linesize[plane],
+              slice_start, slice_end, td->h[plane], s->radius[plane], s->power[plane],
+              s->temp + 2 * jobnr, td->pixsize);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     BoxBlurContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
-    int plane;
+    ThreadData td;
     int cw = AV_CEIL_RSHIFT(inlink->w, s->hsub), ch = AV_CEIL_RSHIFT(in->height, s->vsub);
-    int w[4] = { inlink->w, cw, cw, inlink->w };
-    int h[4] = { in->height, ch, ch, in->height };
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     const int depth = desc->comp[0].depth;
-    const int pixsize = (depth+7)/8;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -245,17 +295,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    td.in  = in;
+    td.out = out;
+    td.w[0] = td.w[3] = inlink->w;
+    td.w[1] = td.w[2] = cw;
+    td.h[0] = td.h[3] = in->height;
+    td.h[1] = td.h[2] = ch;
+    td.pixsize = (depth+7)/8;
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    ctx->internal->execute(ctx, hblur_slice, &td, NULL, FFMIN(ch, s->nb_threads));
+    ctx->internal->execute(ctx, vblur_slice, &td, NULL, FFMIN(cw, s->nb_threads));
 
     av_frame_free(&in);
 
@@ -313,5 +362,5 @@ AVFilter ff_vf_boxblur = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_boxblur_inputs,
     .outputs       = avfilter_vf_boxblur_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -37,6 +37,7 @@ typedef struct DRContext {
     int                filter_type;
     char              *model_filename;
     DNNBackendType     backend_type;
+    int                dnn_threads;
     DNNModule         *dnn_module;
     DNNModel          *model;
     DNNData            input;
@@ -56,6 +57,7 @@ static const AVOption derain_options[] = {
     { "tensorflow",  "tensorflow backend flag",     0,                      AV_OPT_TYPE_CONST,  { .i64 = 1 },    0, 0, FLAGS, "backend" },
 #endif
     { "model",       "path to model file",          OFFSET(model_filename), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, FLAGS },
+    { "dnn_threads", "number of threads of the native backend, 0 to use the filter thread count", OFFSET(dnn_threads), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -161,7 +163,10 @@ static av_cold int init(AVFilterContext *ctx)
         return AVERROR(EINVAL);
     }
 
-    dr_context->model = (dr_context->dnn_module->load_model)(dr_context->model_filename);
+    if (!dr_context->dnn_threads)
+        dr_context->dnn_threads = ff_filter_get_nb_threads(ctx);
+    dr_context->model = (dr_context->dnn_module->load_model)(dr_context->model_filename,
+                                                             dr_context->dnn_threads);
     if (!dr_context->model) {
         av_log(ctx, AV_LOG_ERROR, "could not load DNN model\n");
         return AVERROR(EINVAL);
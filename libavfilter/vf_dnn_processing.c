@@ -30,10 +30,20 @@
 #include "libavutil/imgutils.h"
 #include "avfilter.h"
 #include "dnn_interface.h"
+#include "filters.h"
 #include "formats.h"
 #include "internal.h"
 #include "libswscale/swscale.h"
 
+// a frame being processed asynchronously, with its own model instance
+typedef struct DnnRequest {
+    DNNModel *model;
+    DNNAsyncExecutor *exec;
+    DNNData input;
+    DNNData output;
+    AVFrame *in;
+} DnnRequest;
+
 typedef struct DnnProcessingContext {
     const AVClass *class;
 
@@ -41,6 +51,8 @@ typedef struct DnnProcessingContext {
     DNNBackendType backend_type;
     char *model_inputname;
     char *model_outputname;
+    int nireq;
+    int dnn_threads;
 
     DNNModule *dnn_module;
     DNNModel *model;
@@ -49,6 +61,11 @@ typedef struct DnnProcessingContext {
     DNNData input;
     DNNData output;
 
+    // ring of requests when nireq > 1, oldest first
+    DnnRequest *requests;
+    int req_first;
+    int req_inflight;
+
     struct SwsContext *sws_gray8_to_grayf32;
     struct SwsContext *sws_grayf32_to_gray8;
     struct SwsContext *sws_uv_scale;
@@ -69,6 +86,8 @@ static const AVOption dnn_processing_options[] = {
     { "model",       "path to model file",         OFFSET(model_filename),   AV_OPT_TYPE_STRING,    { .str = NULL }, 0, 0, FLAGS },
     { "input",       "input name of the model",    OFFSET(model_inputname),  AV_OPT_TYPE_STRING,    { .str = NULL }, 0, 0, FLAGS },
     { "output",      "output name of the model",   OFFSET(model_outputname), AV_OPT_TYPE_STRING,    { .str = NULL }, 0, 0, FLAGS },
+    { "nireq",       "number of frames processed concurrently", OFFSET(nireq), AV_OPT_TYPE_INT,   { .i64 = 1 },    1, 64, FLAGS },
+    { "dnn_threads", "number of threads of the native backend, 0 to use the filter thread count", OFFSET(dnn_threads), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -101,12 +120,34 @@ static av_cold int init(AVFilterContext *context)
         return AVERROR(EINVAL);
     }
 
-    ctx->model = (ctx->dnn_module->load_model)(ctx->model_filename);
+    if (!ctx->dnn_threads)
+        ctx->dnn_threads = ff_filter_get_nb_threads(context);
+
+    ctx->model = (ctx->dnn_module->load_model)(ctx->model_filename, ctx->dnn_threads);
     if (!ctx->model) {
         av_log(ctx, AV_LOG_ERROR, "could not load DNN model\n");
         return AVERROR(EINVAL);
     }
 
+    if (ctx->nireq > 1) {
+        ctx->requests = av_mallocz_array(ctx->nireq, sizeof(*ctx->requests));
+        if (!ctx->requests)
+            return AVERROR(ENOMEM);
+
+        // every request needs its own model, as the model holds the input and output data
+        for (int i = 0; i < ctx->nireq; i++) {
+            DnnRequest *req = &ctx->requests[i];
+            req->model = i ? (ctx->dnn_module->load_model)(ctx->model_filename, ctx->dnn_threads) : ctx->model;
+            if (!req->model) {
+                av_log(ctx, AV_LOG_ERROR, "could not load DNN model\n");
+                return AVERROR(EINVAL);
+            }
+            req->exec = ff_dnn_async_create(ctx->dnn_module, req->model);
+            if (!req->exec)
+                return AVERROR(ENOMEM);
+        }
+    }
+
     return 0;
 }
 
@@ -224,6 +265,20 @@ static int config_input(AVFilterLink *inlink)
         return AVERROR(EIO);
     }
 
+    for (int i = 0; ctx->requests && i < ctx->nireq; i++) {
+        DnnRequest *req = &ctx->requests[i];
+        req->input = ctx->input;
+        if (req->model != ctx->model) {
+            result = (req->model->set_input_output)(req->model->model,
+                                                    &req->input, ctx->model_inputname,
+                                                    (const char **)&ctx->model_outputname, 1);
+            if (result != DNN_SUCCESS) {
+                av_log(ctx, AV_LOG_ERROR, "could not set input and output for the model\n");
+                return AVERROR(EIO);
+            }
+        }
+    }
+
     return 0;
 }
 
@@ -321,10 +376,9 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
-static int copy_from_frame_to_dnn(DnnProcessingContext *ctx, const AVFrame *frame)
+static int copy_from_frame_to_dnn(DnnProcessingContext *ctx, DNNData *dnn_input, const AVFrame *frame)
 {
     int bytewidth = av_image_get_linesize(frame->format, frame->width, 0);
-    DNNData *dnn_input = &ctx->input;
 
     switch (frame->format) {
     case AV_PIX_FMT_RGB24:
@@ -362,10 +416,9 @@ static int copy_from_frame_to_dnn(DnnProcessingContext *ctx, const AVFrame *fram
     return 0;
 }
 
-static int copy_from_dnn_to_frame(DnnProcessingContext *ctx, AVFrame *frame)
+static int copy_from_dnn_to_frame(DnnProcessingContext *ctx, const DNNData *dnn_output, AVFrame *frame)
 {
     int bytewidth = av_image_get_linesize(frame->format, frame->width, 0);
-    DNNData *dnn_output = &ctx->output;
 
     switch (frame->format) {
     case AV_PIX_FMT_RGB24:
@@ -444,15 +497,36 @@ static int copy_uv_planes(DnnProcessingContext *ctx, AVFrame *out, const AVFrame
     return 0;
 }
 
+static int output_frame(AVFilterLink *outlink, AVFrame *in, const DNNData *dnn_output)
+{
+    AVFilterContext *context  = outlink->src;
+    DnnProcessingContext *ctx = context->priv;
+    AVFrame *out;
+
+    out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+    if (!out) {
+        av_frame_free(&in);
+        return AVERROR(ENOMEM);
+    }
+
+    av_frame_copy_props(out, in);
+    copy_from_dnn_to_frame(ctx, dnn_output, out);
+
+    if (isPlanarYUV(in->format))
+        copy_uv_planes(ctx, out, in);
+
+    av_frame_free(&in);
+    return ff_filter_frame(outlink, out);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *context  = inlink->dst;
     AVFilterLink *outlink = context->outputs[0];
     DnnProcessingContext *ctx = context->priv;
     DNNReturnType dnn_result;
-    AVFrame *out;
 
-    copy_from_frame_to_dnn(ctx, in);
+    copy_from_frame_to_dnn(ctx, &ctx->input, in);
 
     dnn_result = (ctx->dnn_module->execute_model)(ctx->model, &ctx->output, 1);
     if (dnn_result != DNN_SUCCESS){
@@ -461,20 +535,94 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         return AVERROR(EIO);
     }
 
-    out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-    if (!out) {
+    return output_frame(outlink, in, &ctx->output);
+}
+
+// waits for the oldest request and outputs its frame
+static int collect_request(AVFilterContext *context)
+{
+    DnnProcessingContext *ctx = context->priv;
+    DnnRequest *req = &ctx->requests[ctx->req_first];
+    AVFrame *in = req->in;
+
+    req->in = NULL;
+    ctx->req_first = (ctx->req_first + 1) % ctx->nireq;
+    ctx->req_inflight--;
+
+    if (ff_dnn_async_wait(req->exec) != DNN_SUCCESS) {
+        av_log(ctx, AV_LOG_ERROR, "failed to execute model\n");
         av_frame_free(&in);
-        return AVERROR(ENOMEM);
+        return AVERROR(EIO);
     }
 
-    av_frame_copy_props(out, in);
-    copy_from_dnn_to_frame(ctx, out);
+    return output_frame(context->outputs[0], in, &req->output);
+}
 
-    if (isPlanarYUV(in->format))
-        copy_uv_planes(ctx, out, in);
+static int submit_request(AVFilterContext *context, AVFrame *in)
+{
+    DnnProcessingContext *ctx = context->priv;
+    DnnRequest *req = &ctx->requests[(ctx->req_first + ctx->req_inflight) % ctx->nireq];
 
-    av_frame_free(&in);
-    return ff_filter_frame(outlink, out);
+    copy_from_frame_to_dnn(ctx, &req->input, in);
+
+    if (ff_dnn_async_start(req->exec, &req->output, 1) != DNN_SUCCESS) {
+        av_log(ctx, AV_LOG_ERROR, "failed to execute model\n");
+        av_frame_free(&in);
+        return AVERROR(EIO);
+    }
+    req->in = in;
+    ctx->req_inflight++;
+
+    return 0;
+}
+
+static int activate(AVFilterContext *context)
+{
+    AVFilterLink *inlink  = context->inputs[0];
+    AVFilterLink *outlink = context->outputs[0];
+    DnnProcessingContext *ctx = context->priv;
+    AVFrame *in;
+    int64_t pts;
+    int ret, status;
+
+    FF_FILTER_FORWARD_STATUS_BACK(outlink, inlink);
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0) {
+        if (!ctx->requests)
+            return filter_frame(inlink, in);
+
+        // only block on the model once every request is busy
+        if (ctx->req_inflight == ctx->nireq) {
+            ret = collect_request(context);
+            if (ret < 0) {
+                av_frame_free(&in);
+                return ret;
+            }
+        }
+        ret = submit_request(context, in);
+        if (ret < 0)
+            return ret;
+        if (ff_inlink_queued_frames(inlink))
+            ff_filter_set_ready(context, 100);
+        return 0;
+    }
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        while (ctx->req_inflight) {
+            ret = collect_request(context);
+            if (ret < 0)
+                return ret;
+        }
+        ff_outlink_set_status(outlink, status, pts);
+        return 0;
+    }
+
+    FF_FILTER_FORWARD_WANTED(outlink, inlink);
+
+    return FFERROR_NOT_READY;
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -485,6 +633,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     sws_freeContext(context->sws_grayf32_to_gray8);
     sws_freeContext(context->sws_uv_scale);
 
+    for (int i = 0; context->requests && i < context->nireq; i++) {
+        DnnRequest *req = &context->requests[i];
+        ff_dnn_async_free(&req->exec);
+        av_frame_free(&req->in);
+        if (req->model && req->model != context->model)
+            (context->dnn_module->free_model)(&req->model);
+    }
+    av_freep(&context->requests);
+
     if (context->dnn_module)
         (context->dnn_module->free_model)(&context->model);
 
@@ -496,7 +653,6 @@ static const AVFilterPad dnn_processing_inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .config_props = config_input,
-        .filter_frame = filter_frame,
     },
     { NULL }
 };
@@ -517,6 +673,7 @@ AVFilter ff_vf_dnn_processing = {
     .init          = init,
     .uninit        = uninit,
     .query_formats = query_formats,
+    .activate      = activate,
     .inputs        = dnn_processing_inputs,
     .outputs       = dnn_processing_outputs,
     .priv_class    = &dnn_processing_class,
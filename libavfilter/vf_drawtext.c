@@ -155,6 +155,15 @@ typedef struct DrawTextContext {
     int ft_load_flags;              ///< flags used for loading fonts, see FT_LOAD_*
     FT_Vector *positions;           ///< positions for each element in the text
     size_t nb_positions;            ///< number of elements of positions array
+    uint8_t *layout_text;           ///< expanded text of the current layout
+    unsigned int layout_text_size;  ///< allocated size of layout_text
+    int layout_text_len;            ///< length of layout_text
+    unsigned int layout_fontsize;   ///< font size of the current layout
+    int layout_valid;               ///< the layout matches layout_text
+    int text_w, text_h;             ///< dimensions of the laid out text
+    struct Glyph **layout_glyphs;   ///< glyph drawn for each element in the text, or NULL
+    int layout_nb_glyphs;           ///< number of elements of the laid out text
+    int glyphs_y0, glyphs_y1;       ///< rows covered by the glyph bitmaps, relative to the text
     char *textfile;                 ///< file with text to be drawn
     int x;                          ///< x position to start drawing text
     int y;                          ///< y position to start drawing text
@@ -812,6 +821,9 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->positions);
     s->nb_positions = 0;
+    av_freep(&s->layout_text);
+    av_freep(&s->layout_glyphs);
+    s->layout_valid = 0;
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
@@ -1213,52 +1225,89 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+/**
+ * Blend the glyphs of the laid out text over the rows [y_start, y_end).
+ * Each glyph is blended on its own, and y_start and y_end are aligned to
+ * the chroma subsampling, so the result is the same as blending the whole
+ * glyphs at once.
+ */
+static void draw_glyphs(DrawTextContext *s, AVFrame *frame, FFDrawColor *color,
+                        int x, int y, int borderw, int y_start, int y_end)
 {
-    char *text = s->expanded_text.str;
-    uint32_t code = 0;
-    int i, x1, y1;
-    uint8_t *p;
-    Glyph *glyph = NULL;
+    int i;
 
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
-continue_on_invalid:
+    for (i = 0; i < s->layout_nb_glyphs; i++) {
+        const Glyph *glyph = s->layout_glyphs[i];
+        const FT_Bitmap *bitmap;
+        int x1, y1, top, bottom;
 
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
+        if (!glyph)
             continue;
 
-        dummy.code = code;
-        dummy.fontsize = s->fontsize;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
-
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
+        bitmap = borderw ? &glyph->border_bitmap : &glyph->bitmap;
 
         x1 = s->positions[i].x+s->x+x - borderw;
         y1 = s->positions[i].y+s->y+y - borderw;
 
+        top    = FFMAX(y1, y_start);
+        bottom = FFMIN(y1 + (int)bitmap->rows, y_end);
+        if (top >= bottom)
+            continue;
+
         ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+                      frame->data, frame->linesize, frame->width, frame->height,
+                      bitmap->buffer + (top - y1) * bitmap->pitch, bitmap->pitch,
+                      bitmap->width, bottom - top,
+                      bitmap->pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
+                      0, x1, top);
+    }
+}
+
+typedef struct ThreadData {
+    AVFrame *frame;
+    FFDrawColor fontcolor;
+    FFDrawColor shadowcolor;
+    FFDrawColor bordercolor;
+    FFDrawColor boxcolor;
+    int y_start, y_end;             ///< rows touched by the text, y_start is aligned to the chroma subsampling
+} ThreadData;
+
+/**
+ * Draw the box and the text passes over a band of rows. The bands start on
+ * chroma row boundaries, so the result does not depend on the slicing.
+ */
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *frame = td->frame;
+    const int align   = 1 << s->dc.vsub_max;
+    const int nb_rows = (td->y_end - td->y_start + align - 1) / align;
+    const int y_start = td->y_start + (nb_rows *  jobnr     / nb_jobs) * align;
+    const int y_end   = FFMIN(td->y_start + (nb_rows * (jobnr + 1) / nb_jobs) * align, td->y_end);
+
+    if (s->draw_box) {
+        const int top    = FFMAX(s->y - s->boxborderw, y_start);
+        const int bottom = FFMIN(s->y + s->text_h + s->boxborderw, y_end);
+
+        if (top < bottom)
+            ff_blend_rectangle(&s->dc, &td->boxcolor,
+                               frame->data, frame->linesize, frame->width, frame->height,
+                               s->x - s->boxborderw, top,
+                               s->text_w + s->boxborderw * 2, bottom - top);
     }
 
+    if (s->shadowx || s->shadowy)
+        draw_glyphs(s, frame, &td->shadowcolor, s->shadowx, s->shadowy, 0,
+                    y_start, y_end);
+    if (s->borderw)
+        draw_glyphs(s, frame, &td->bordercolor, 0, 0, s->borderw,
+                    y_start, y_end);
+    draw_glyphs(s, frame, &td->fontcolor, 0, 0, 0, y_start, y_end);
+
     return 0;
 }
 
-
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
     *color = incolor;
@@ -1281,17 +1330,19 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Lay out the expanded text: the position and the glyph of each element.
+ * The result only depends on the expanded text and the font size, and is
+ * kept as long as they do not change. Text which changes on every frame,
+ * like a timecode, is laid out again on every frame as before.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
-    int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    int max_text_line_w = 0;
+    char *text = s->expanded_text.str;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
@@ -1299,70 +1350,7 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
-
-    FFDrawColor fontcolor;
-    FFDrawColor shadowcolor;
-    FFDrawColor bordercolor;
-    FFDrawColor boxcolor;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
-
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
-
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
-    if ((len = s->expanded_text.len) > s->nb_positions) {
-        if (!(s->positions =
-              av_realloc(s->positions, len*sizeof(*s->positions))))
-            return AVERROR(ENOMEM);
-        s->nb_positions = len;
-    }
-
-    if (s->fontcolor_expr[0]) {
-        /* If expression is set, evaluate and replace the static value */
-        av_bprint_clear(&s->expanded_fontcolor);
-        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
-            return ret;
-        if (!av_bprint_is_complete(&s->expanded_fontcolor))
-            return AVERROR(ENOMEM);
-        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
-        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
-        if (ret)
-            return ret;
-        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
-    }
-
-    x = 0;
-    y = 0;
-
-    if ((ret = update_fontsize(ctx)) < 0)
-        return ret;
+    s->layout_valid = 0;
 
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
@@ -1389,10 +1377,14 @@ continue_on_invalid:
 
     /* compute and save position for each glyph */
     glyph = NULL;
+    s->glyphs_y0 = INT_MAX;
+    s->glyphs_y1 = INT_MIN;
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid2;);
 continue_on_invalid2:
 
+        s->layout_glyphs[i] = NULL;
+
         /* skip the \n in the sequence \r\n */
         if (prev_code == '\r' && code == '\n')
             continue;
@@ -1424,9 +1416,22 @@ continue_on_invalid2:
         s->positions[i].y = y - glyph->bitmap_top + y_max;
         if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
         else              x += glyph->advance;
+
+        if (code != '\t') {
+            int top    = s->positions[i].y - s->borderw;
+            int bottom = s->positions[i].y + glyph->bitmap.rows;
+            if (s->borderw)
+                bottom = FFMAX(bottom, top + (int)glyph->border_bitmap.rows);
+            s->glyphs_y0 = FFMIN(s->glyphs_y0, top);
+            s->glyphs_y1 = FFMAX(s->glyphs_y1, bottom);
+            s->layout_glyphs[i] = glyph;
+        }
     }
+    s->layout_nb_glyphs = i;
 
     max_text_line_w = FFMAX(x, max_text_line_w);
+    s->text_w = max_text_line_w;
+    s->text_h = y + s->max_glyph_h;
 
     s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
     s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
@@ -1438,19 +1443,102 @@ continue_on_invalid2:
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
+    av_fast_malloc(&s->layout_text, &s->layout_text_size, s->expanded_text.len + 1);
+    if (!s->layout_text)
+        return AVERROR(ENOMEM);
+    memcpy(s->layout_text, s->expanded_text.str, s->expanded_text.len + 1);
+    s->layout_text_len = s->expanded_text.len;
+    s->layout_fontsize = s->fontsize;
+    s->layout_valid    = 1;
+
+    return 0;
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    int ret, len, nb_jobs, align;
+    ThreadData td = { .frame = frame, .y_start = INT_MAX, .y_end = INT_MIN };
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+    if ((len = s->expanded_text.len) > s->nb_positions) {
+        if (!(s->positions =
+              av_realloc(s->positions, len*sizeof(*s->positions))))
+            return AVERROR(ENOMEM);
+        if (!(s->layout_glyphs =
+              av_realloc_array(s->layout_glyphs, len, sizeof(*s->layout_glyphs))))
+            return AVERROR(ENOMEM);
+        s->nb_positions = len;
+    }
+
+    if (s->fontcolor_expr[0]) {
+        /* If expression is set, evaluate and replace the static value */
+        av_bprint_clear(&s->expanded_fontcolor);
+        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
+            return ret;
+        if (!av_bprint_is_complete(&s->expanded_fontcolor))
+            return AVERROR(ENOMEM);
+        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
+        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
+        if (ret)
+            return ret;
+        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
+    }
+
+    if ((ret = update_fontsize(ctx)) < 0)
+        return ret;
+
+    if (!s->layout_valid || s->layout_fontsize != s->fontsize ||
+        s->layout_text_len != s->expanded_text.len ||
+        memcmp(s->layout_text, s->expanded_text.str, s->expanded_text.len)) {
+        if ((ret = layout_text(ctx)) < 0)
+            return ret;
+    }
+
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
     s->y = s->var_values[VAR_Y] = av_expr_eval(s->y_pexpr, s->var_values, &s->prng);
     /* It is necessary if x is expressed from y  */
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
 
     update_alpha(s);
-    update_color_with_alpha(s, &fontcolor  , s->fontcolor  );
-    update_color_with_alpha(s, &shadowcolor, s->shadowcolor);
-    update_color_with_alpha(s, &bordercolor, s->bordercolor);
-    update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
-
-    box_w = max_text_line_w;
-    box_h = y + s->max_glyph_h;
+    update_color_with_alpha(s, &td.fontcolor  , s->fontcolor  );
+    update_color_with_alpha(s, &td.shadowcolor, s->shadowcolor);
+    update_color_with_alpha(s, &td.bordercolor, s->bordercolor);
+    update_color_with_alpha(s, &td.boxcolor   , s->boxcolor   );
 
     if (s->fix_bounds) {
 
@@ -1472,33 +1560,34 @@ continue_on_invalid2:
         if (s->x - offsetleft < 0) s->x = offsetleft;
         if (s->y - offsettop < 0)  s->y = offsettop;
 
-        if (s->x + box_w + offsetright > width)
-            s->x = FFMAX(width - box_w - offsetright, 0);
-        if (s->y + box_h + offsetbottom > height)
-            s->y = FFMAX(height - box_h - offsetbottom, 0);
+        if (s->x + s->text_w + offsetright > width)
+            s->x = FFMAX(width - s->text_w - offsetright, 0);
+        if (s->y + s->text_h + offsetbottom > height)
+            s->y = FFMAX(height - s->text_h - offsetbottom, 0);
     }
 
-    /* draw box */
-    if (s->draw_box)
-        ff_blend_rectangle(&s->dc, &boxcolor,
-                           frame->data, frame->linesize, width, height,
-                           s->x - s->boxborderw, s->y - s->boxborderw,
-                           box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
-
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
+    /* rows touched by the box and the text passes */
+    if (s->draw_box) {
+        td.y_start = FFMIN(td.y_start, s->y - s->boxborderw);
+        td.y_end   = FFMAX(td.y_end,   s->y + s->text_h + s->boxborderw);
     }
-
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
+    if (s->glyphs_y0 < s->glyphs_y1) {
+        td.y_start = FFMIN(td.y_start, s->y + s->glyphs_y0);
+        td.y_end   = FFMAX(td.y_end,   s->y + s->glyphs_y1);
+        if (s->shadowx || s->shadowy) {
+            td.y_start = FFMIN(td.y_start, s->y + s->glyphs_y0 + s->shadowy);
+            td.y_end   = FFMAX(td.y_end,   s->y + s->glyphs_y1 + s->shadowy);
+        }
     }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    align      = 1 << s->dc.vsub_max;
+    td.y_start = FFMAX(td.y_start, 0) & ~(align - 1);
+    td.y_end   = FFMIN(td.y_end, height);
+    if (td.y_start >= td.y_end)
+        return 0;
+
+    nb_jobs = FFMIN(ff_filter_get_nb_threads(ctx),
+                    (td.y_end - td.y_start + align - 1) / align);
+    ctx->internal->execute(ctx, draw_text_slice, &td, NULL, nb_jobs);
 
     return 0;
 }
@@ -1574,5 +1663,5 @@ AVFilter ff_vf_drawtext = {
     .inputs        = avfilter_vf_drawtext_inputs,
     .outputs       = avfilter_vf_drawtext_outputs,
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -38,6 +38,7 @@
 #include "formats.h"
 #include "framesync.h"
 #include "internal.h"
+#include "lut3d.h"
 #include "video.h"
 
 #define R 0
@@ -45,53 +46,6 @@
 #define B 2
 #define A 3
 
-enum interp_mode {
-    INTERPOLATE_NEAREST,
-    INTERPOLATE_TRILINEAR,
-    INTERPOLATE_TETRAHEDRAL,
-    NB_INTERP_MODE
-};
-
-struct rgbvec {
-    float r, g, b;
-};
-
-/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
- * of 512x512 (64x64x64) */
-#define MAX_LEVEL 256
-#define PRELUT_SIZE 65536
-
-typedef struct Lut3DPreLut {
-    int size;
-    float min[3];
-    float max[3];
-    float scale[3];
-    float* lut[3];
-} Lut3DPreLut;
-
-typedef struct LUT3DContext {
-    const AVClass *class;
-    int interpolation;          ///<interp_mode
-    char *file;
-    uint8_t rgba_map[4];
-    int step;
-    avfilter_action_func *interp;
-    struct rgbvec scale;
-    struct rgbvec *lut;
-    int lutsize;
-    int lutsize2;
-    Lut3DPreLut prelut;
-#if CONFIG_HALDCLUT_FILTER
-    uint8_t clut_rgba_map[4];
-    int clut_step;
-    int clut_bits;
-    int clut_planar;
-    int clut_float;
-    int clut_width;
-    FFFrameSync fs;
-#endif
-} LUT3DContext;
-
 typedef struct ThreadData {
     AVFrame *in, *out;
 } ThreadData;
@@ -144,37 +98,36 @@ static inline struct rgbvec lerp(const struct rgbvec *v0, const struct rgbvec *v
 
 #define NEAR(x) ((int)((x) + .5))
 #define PREV(x) ((int)(x))
-#define NEXT(x) (FFMIN((int)(x) + 1, lut3d->lutsize - 1))
+#define NEXT(x) (FFMIN((int)(x) + 1, lutsize - 1))
 
 /**
  * Get the nearest defined point
  */
-static inline struct rgbvec interp_nearest(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_nearest(const struct rgbvec *lut, int lutsize,
                                            const struct rgbvec *s)
 {
-    return lut3d->lut[NEAR(s->r) * lut3d->lutsize2 + NEAR(s->g) * lut3d->lutsize + NEAR(s->b)];
+    return lut[NEAR(s->r) * lutsize * lutsize + NEAR(s->g) * lutsize + NEAR(s->b)];
 }
 
 /**
  * Interpolate using the 8 vertices of a cube
  * @see https://en.wikipedia.org/wiki/Trilinear_interpolation
  */
-static inline struct rgbvec interp_trilinear(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_trilinear(const struct rgbvec *lut, int lutsize,
                                              const struct rgbvec *s)
 {
-    const int lutsize2 = lut3d->lutsize2;
-    const int lutsize  = lut3d->lutsize;
+    const int lutsize2 = lutsize * lutsize;
     const int prev[] = {PREV(s->r), PREV(s->g), PREV(s->b)};
     const int next[] = {NEXT(s->r), NEXT(s->g), NEXT(s->b)};
     const struct rgbvec d = {s->r - prev[0], s->g - prev[1], s->b - prev[2]};
-    const struct rgbvec c000 = lut3d->lut[prev[0] * lutsize2 + prev[1] * lutsize + prev[2]];
-    const struct rgbvec c001 = lut3d->lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
-    const struct rgbvec c010 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
-    const struct rgbvec c011 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
-    const struct rgbvec c100 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
-    const struct rgbvec c101 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
-    const struct rgbvec c110 = lut3d->lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
-    const struct rgbvec c111 = lut3d->lut[next[0] * lutsize2 + next[1] * lutsize + next[2]];
+    const struct rgbvec c000 = lut[prev[0] * lutsize2 + prev[1] * lutsize + prev[2]];
+    const struct rgbvec c001 = lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
+    const struct rgbvec c010 = lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
+    const struct rgbvec c011 = lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
+    const struct rgbvec c100 = lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
+    const struct rgbvec c101 = lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
+    const struct rgbvec c110 = lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
+    const struct rgbvec c111 = lut[next[0] * lutsize2 + next[1] * lutsize + next[2]];
     const struct rgbvec c00  = lerp(&c000, &c100, d.r);
     const struct rgbvec c10  = lerp(&c010, &c110, d.r);
     const struct rgbvec c01  = lerp(&c001, &c101, d.r);
@@ -189,53 +142,52 @@ static inline struct rgbvec interp_trilinear(const LUT3DContext *lut3d,
  * Tetrahedral interpolation. Based on code found in Truelight Software Library paper.
  * @see http://www.filmlight.ltd.uk/pdf/whitepapers/FL-TL-TN-0057-SoftwareLib.pdf
  */
-static inline struct rgbvec interp_tetrahedral(const LUT3DContext *lut3d,
+static inline struct rgbvec interp_tetrahedral(const struct rgbvec *lut, int lutsize,
                                                const struct rgbvec *s)
 {
-    const int lutsize2 = lut3d->lutsize2;
-    const int lutsize  = lut3d->lutsize;
+    const int lutsize2 = lutsize * lutsize;
     const int prev[] = {PREV(s->r), PREV(s->g), PREV(s->b)};
     const int next[] = {NEXT(s->r), NEXT(s->g), NEXT(s->b)};
     const struct rgbvec d = {s->r - prev[0], s->g - prev[1], s->b - prev[2]};
-    const struct rgbvec c000 = lut3d->lut[prev[0] * lutsize2 + prev[1] * lutsize + prev[2]];
-    const struct rgbvec c111 = lut3d->lut[next[0] * lutsize2 + next[1] * lutsize + next[2]];
+    const struct rgbvec c000 = lut[prev[0] * lutsize2 + prev[1] * lutsize + prev[2]];
+    const struct rgbvec c111 = lut[next[0] * lutsize2 + next[1] * lutsize + next[2]];
     struct rgbvec c;
     if (d.r > d.g) {
         if (d.g > d.b) {
-            const struct rgbvec c100 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
-            const struct rgbvec c110 = lut3d->lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
+            const struct rgbvec c100 = lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
+            const struct rgbvec c110 = lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
             c.r = (1-d.r) * c000.r + (d.r-d.g) * c100.r + (d.g-d.b) * c110.r + (d.b) * c111.r;
             c.g = (1-d.r) * c000.g + (d.r-d.g) * c100.g + (d.g-d.b) * c110.g + (d.b) * c111.g;
             c.b = (1-d.r) * c000.b + (d.r-d.g) * c100.b + (d.g-d.b) * c110.b + (d.b) * c111.b;
         } else if (d.r > d.b) {
-            const struct rgbvec c100 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
-            const struct rgbvec c101 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
+            const struct rgbvec c100 = lut[next[0] * lutsize2 + prev[1] * lutsize + prev[2]];
+            const struct rgbvec c101 = lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
             c.r = (1-d.r) * c000.r + (d.r-d.b) * c100.r + (d.b-d.g) * c101.r + (d.g) * c111.r;
             c.g = (1-d.r) * c000.g + (d.r-d.b) * c100.g + (d.b-d.g) * c101.g + (d.g) * c111.g;
             c.b = (1-d.r) * c000.b + (d.r-d.b) * c100.b + (d.b-d.g) * c101.b + (d.g) * c111.b;
         } else {
-            const struct rgbvec c001 = lut3d->lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
-            const struct rgbvec c101 = lut3d->lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
+            const struct rgbvec c001 = lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
+            const struct rgbvec c101 = lut[next[0] * lutsize2 + prev[1] * lutsize + next[2]];
             c.r = (1-d.b) * c000.r + (d.b-d.r) * c001.r + (d.r-d.g) * c101.r + (d.g) * c111.r;
             c.g = (1-d.b) * c000.g + (d.b-d.r) * c001.g + (d.r-d.g) * c101.g + (d.g) * c111.g;
             c.b = (1-d.b) * c000.b + (d.b-d.r) * c001.b + (d.r-d.g) * c101.b + (d.g) * c111.b;
         }
     } else {
         if (d.b > d.g) {
-            const struct rgbvec c001 = lut3d->lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
-            const struct rgbvec c011 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
+            const struct rgbvec c001 = lut[prev[0] * lutsize2 + prev[1] * lutsize + next[2]];
+            const struct rgbvec c011 = lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
             c.r = (1-d.b) * c000.r + (d.b-d.g) * c001.r + (d.g-d.r) * c011.r + (d.r) * c111.r;
             c.g = (1-d.b) * c000.g + (d.b-d.g) * c001.g + (d.g-d.r) * c011.g + (d.r) * c111.g;
             c.b = (1-d.b) * c000.b + (d.b-d.g) * c001.b + (d.g-d.r) * c011.b + (d.r) * c111.b;
         } else if (d.b > d.r) {
-            const struct rgbvec c010 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
-            const struct rgbvec c011 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
+            const struct rgbvec c010 = lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
+            const struct rgbvec c011 = lut[prev[0] * lutsize2 + next[1] * lutsize + next[2]];
             c.r = (1-d.g) * c000.r + (d.g-d.b) * c010.r + (d.b-d.r) * c011.r + (d.r) * c111.r;
             c.g = (1-d.g) * c000.g + (d.g-d.b) * c010.g + (d.b-d.r) * c011.g + (d.r) * c111.g;
             c.b = (1-d.g) * c000.b + (d.g-d.b) * c010.b + (d.b-d.r) * c011.b + (d.r) * c111.b;
         } else {
-            const struct rgbvec c010 = lut3d->lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
-            const struct rgbvec c110 = lut3d->lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
+            const struct rgbvec c010 = lut[prev[0] * lutsize2 + next[1] * lutsize + prev[2]];
+            const struct rgbvec c110 = lut[next[0] * lutsize2 + next[1] * lutsize + prev[2]];
             c.r = (1-d.g) * c000.r + (d.g-d.r) * c010.r + (d.r-d.b) * c110.r + (d.b) * c111.r;
             c.g = (1-d.g) * c000.g + (d.g-d.r) * c010.g + (d.r-d.b) * c110.g + (d.b) * c111.g;
             c.b = (1-d.g) * c000.b + (d.g-d.r) * c010.b + (d.r-d.b) * c110.b + (d.b) * c111.b;
@@ -315,7 +267,7 @@ static int interp_##nbits##_##name##_p##depth(AVFilterContext *ctx, void *arg, i
             const struct rgbvec scaled_rgb = {av_clipf(prelut_rgb.r * scale_r, 0, lut_max),            \
                                               av_clipf(prelut_rgb.g * scale_g, 0, lut_max),            \
                                               av_clipf(prelut_rgb.b * scale_b, 0, lut_max)};           \
-            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                     \
+            struct rgbvec vec = interp_##name(lut3d->lut, lut3d->lutsize, &scaled_rgb);                \
             dstr[x] = av_clip_uintp2(vec.r * (float)((1<<depth) - 1), depth);                          \
             dstg[x] = av_clip_uintp2(vec.g * (float)((1<<depth) - 1), depth);                          \
             dstb[x] = av_clip_uintp2(vec.b * (float)((1<<depth) - 1), depth);                          \
@@ -400,7 +352,7 @@ static int interp_##name##_pf##depth(AVFilterContext *ctx, void *arg, int jobnr,
             const struct rgbvec scaled_rgb = {av_clipf(prelut_rgb.r * scale_r, 0, lut_max),            \
                                               av_clipf(prelut_rgb.g * scale_g, 0, lut_max),            \
                                               av_clipf(prelut_rgb.b * scale_b, 0, lut_max)};           \
-            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                     \
+            struct rgbvec vec = interp_##name(lut3d->lut, lut3d->lutsize, &scaled_rgb);                \
             dstr[x] = vec.r;                                                                           \
             dstg[x] = vec.g;                                                                           \
             dstb[x] = vec.b;                                                                           \
@@ -423,6 +375,170 @@ DEFINE_INTERP_FUNC_PLANAR_FLOAT(nearest,     32)
 DEFINE_INTERP_FUNC_PLANAR_FLOAT(trilinear,   32)
 DEFINE_INTERP_FUNC_PLANAR_FLOAT(tetrahedral, 32)
 
+#define DEFINE_INTERP_LINE_PLANAR(name, nbits, depth)                                                  \
+static void interp_line_##nbits##_##name##_p##depth(uint8_t *const *dst, const uint8_t *const *src,   \
+                                                    const struct rgbvec *lut, const float *scale,      \
+                                                    int lutsize, int w)                                \
+{                                                                                                      \
+    int x;                                                                                             \
+    uint##nbits##_t *dstr = (uint##nbits##_t *)dst[R];                                                 \
+    uint##nbits##_t *dstg = (uint##nbits##_t *)dst[G];                                                 \
+    uint##nbits##_t *dstb = (uint##nbits##_t *)dst[B];                                                 \
+    const uint##nbits##_t *srcr = (const uint##nbits##_t *)src[R];                                     \
+    const uint##nbits##_t *srcg = (const uint##nbits##_t *)src[G];                                     \
+    const uint##nbits##_t *srcb = (const uint##nbits##_t *)src[B];                                     \
+    const float lut_max = scale[3];                                                                    \
+    const float scale_f = 1.0f / ((1<<depth) - 1);                                                     \
+                                                                                                       \
+    for (x = 0; x < w; x++) {                                                                          \
+        const struct rgbvec rgb = {srcr[x] * scale_f,                                                  \
+                                   srcg[x] * scale_f,                                                  \
+                                   srcb[x] * scale_f};                                                 \
+        const struct rgbvec scaled_rgb = {av_clipf(rgb.r * scale[R], 0, lut_max),                      \
+                                          av_clipf(rgb.g * scale[G], 0, lut_max),                      \
+                                          av_clipf(rgb.b * scale[B], 0, lut_max)};                     \
+        struct rgbvec vec = interp_##name(lut, lutsize, &scaled_rgb);                                  \
+        dstr[x] = av_clip_uintp2(vec.r * (float)((1<<depth) - 1), depth);                              \
+        dstg[x] = av_clip_uintp2(vec.g * (float)((1<<depth) - 1), depth);                              \
+        dstb[x] = av_clip_uintp2(vec.b * (float)((1<<depth) - 1), depth);                              \
+    }                                                                                                  \
+}
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     8, 8)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   8, 8)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 8, 8)
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     16, 9)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   16, 9)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 16, 9)
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     16, 10)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   16, 10)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 16, 10)
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     16, 12)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   16, 12)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 16, 12)
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     16, 14)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   16, 14)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 16, 14)
+
+DEFINE_INTERP_LINE_PLANAR(nearest,     16, 16)
+DEFINE_INTERP_LINE_PLANAR(trilinear,   16, 16)
+DEFINE_INTERP_LINE_PLANAR(tetrahedral, 16, 16)
+
+#define DEFINE_INTERP_LINE_PLANAR_FLOAT(name, depth)                                                   \
+static void interp_line_##name##_pf##depth(uint8_t *const *dst, const uint8_t *const *src,            \
+                                           const struct rgbvec *lut, const float *scale,               \
+                                           int lutsize, int w)                                         \
+{                                                                                                      \
+    int x;                                                                                             \
+    float *dstr = (float *)dst[R];                                                                     \
+    float *dstg = (float *)dst[G];                                                                     \
+    float *dstb = (float *)dst[B];                                                                     \
+    const float *srcr = (const float *)src[R];                                                         \
+    const float *srcg = (const float *)src[G];                                                         \
+    const float *srcb = (const float *)src[B];                                                         \
+    const float lut_max = scale[3];                                                                    \
+                                                                                                       \
+    for (x = 0; x < w; x++) {                                                                          \
+        const struct rgbvec rgb = {sanitizef(srcr[x]),                                                 \
+                                   sanitizef(srcg[x]),                                                 \
+                                   sanitizef(srcb[x])};                                                \
+        const struct rgbvec scaled_rgb = {av_clipf(rgb.r * scale[R], 0, lut_max),                      \
+                                          av_clipf(rgb.g * scale[G], 0, lut_max),                      \
+                                          av_clipf(rgb.b * scale[B], 0, lut_max)};                     \
+        struct rgbvec vec = interp_##name(lut, lutsize, &scaled_rgb);                                  \
+        dstr[x] = vec.r;                                                                               \
+        dstg[x] = vec.g;                                                                               \
+        dstb[x] = vec.b;                                                                               \
+    }                                                                                                  \
+}
+
+DEFINE_INTERP_LINE_PLANAR_FLOAT(nearest,     32)
+DEFINE_INTERP_LINE_PLANAR_FLOAT(trilinear,   32)
+DEFINE_INTERP_LINE_PLANAR_FLOAT(tetrahedral, 32)
+
+/* Planar formats without a prelut go through interp_line, one call per row. */
+static int interp_planar_line(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    int y;
+    const LUT3DContext *lut3d = ctx->priv;
+    const ThreadData *td = arg;
+    const AVFrame *in  = td->in;
+    const AVFrame *out = td->out;
+    const int direct = out == in;
+    const int slice_start = (in->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;
+    const float lut_max = lut3d->lutsize - 1;
+    const float scale[4] = { lut3d->scale.r * lut_max,
+                             lut3d->scale.g * lut_max,
+                             lut3d->scale.b * lut_max,
+                             lut_max };
+    const int copy_alpha = !direct && in->linesize[3];
+    const int alpha_bytes = copy_alpha ? in->width * av_pix_fmt_desc_get(in->format)->comp[3].step : 0;
+    /* the SIMD versions only process whole blocks, the C version does the rest */
+    const int w = in->width & ~(lut3d->line_block - 1);
+    const int tail_offset = w * av_pix_fmt_desc_get(in->format)->comp[0].step;
+    uint8_t *dst[3];
+    const uint8_t *src[3];
+
+    for (y = slice_start; y < slice_end; y++) {
+        dst[R] = out->data[2] + y * out->linesize[2];
+        dst[G] = out->data[0] + y * out->linesize[0];
+        dst[B] = out->data[1] + y * out->linesize[1];
+        src[R] = in->data[2] + y * in->linesize[2];
+        src[G] = in->data[0] + y * in->linesize[0];
+        src[B] = in->data[1] + y * in->linesize[1];
+        if (w)
+            lut3d->interp_line(dst, src, lut3d->lut, scale, lut3d->lutsize, w);
+        if (w < in->width) {
+            int i;
+            for (i = 0; i < 3; i++) {
+                dst[i] += tail_offset;
+                src[i] += tail_offset;
+            }
+            lut3d->interp_line_c(dst, src, lut3d->lut, scale, lut3d->lutsize,
+                                 in->width - w);
+        }
+        if (copy_alpha)
+            memcpy(out->data[3] + y * out->linesize[3],
+                   in->data[3] + y * in->linesize[3], alpha_bytes);
+    }
+    return 0;
+}
+
+av_cold void ff_lut3d_init(LUT3DContext *s, int depth, int isfloat)
+{
+#define SET_LINE_FUNC(name) do {                                          \
+    if (isfloat) {                                                        \
+        s->interp_line = interp_line_##name##_pf32;                       \
+    } else {                                                              \
+        switch (depth) {                                                  \
+        case  8: s->interp_line = interp_line_8_##name##_p8;   break;     \
+        case  9: s->interp_line = interp_line_16_##name##_p9;  break;     \
+        case 10: s->interp_line = interp_line_16_##name##_p10; break;     \
+        case 12: s->interp_line = interp_line_16_##name##_p12; break;     \
+        case 14: s->interp_line = interp_line_16_##name##_p14; break;     \
+        case 16: s->interp_line = interp_line_16_##name##_p16; break;     \
+        }                                                                 \
+    }                                                                     \
+} while (0)
+
+    s->interp_line = NULL;
+    switch (s->interpolation) {
+    case INTERPOLATE_NEAREST:     SET_LINE_FUNC(nearest);     break;
+    case INTERPOLATE_TRILINEAR:   SET_LINE_FUNC(trilinear);   break;
+    case INTERPOLATE_TETRAHEDRAL: SET_LINE_FUNC(tetrahedral); break;
+    }
+    s->interp_line_c = s->interp_line;
+    s->line_block    = 1;
+
+    if (ARCH_X86)
+        ff_lut3d_init_x86(s, depth, isfloat);
+}
+
 #define DEFINE_INTERP_FUNC(name, nbits)                                                             \
 static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)         \
 {                                                                                                   \
@@ -459,7 +575,7 @@ static int interp_##nbits##_##name(AVFilterContext *ctx, void *arg, int jobnr, i
             const struct rgbvec scaled_rgb = {av_clipf(prelut_rgb.r * scale_r, 0, lut_max),         \
                                               av_clipf(prelut_rgb.g * scale_g, 0, lut_max),         \
                                               av_clipf(prelut_rgb.b * scale_b, 0, lut_max)};        \
-            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                  \
+            struct rgbvec vec = interp_##name(lut3d->lut, lut3d->lutsize, &scaled_rgb);             \
             dst[x + r] = av_clip_uint##nbits(vec.r * (float)((1<<nbits) - 1));                      \
             dst[x + g] = av_clip_uint##nbits(vec.g * (float)((1<<nbits) - 1));                      \
             dst[x + b] = av_clip_uint##nbits(vec.b * (float)((1<<nbits) - 1));                      \
@@ -1092,6 +1208,12 @@ static int config_input(AVFilterLink *inlink)
         av_assert0(0);
     }
 
+    lut3d->interp_line = NULL;
+    if (planar)
+        ff_lut3d_init(lut3d, depth, isfloat);
+    if (lut3d->interp_line && lut3d->prelut.size <= 0)
+        lut3d->interp = interp_planar_line;
+
     return 0;
 }
 
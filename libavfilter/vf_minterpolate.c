@@ -915,16 +915,30 @@ static void bidirectional_obmc(MIContext *mi_ctx, int alpha)
             }
 }
 
-static void set_frame_data(MIContext *mi_ctx, int alpha, AVFrame *avf_out)
+typedef struct ThreadData {
+    AVFrame *out;
+    int alpha;
+} ThreadData;
+
+static int set_frame_data_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *avf_out = td->out;
+    const int alpha = td->alpha;
+    const int width = avf_out->width;
+    const int height = avf_out->height;
+    /* slices start on chroma row boundaries, so that no chroma sample is
+     * written by two jobs */
+    const int nb_rows = AV_CEIL_RSHIFT(height, mi_ctx->log2_chroma_h);
+    const int slice_start = ((nb_rows *  jobnr   ) / nb_jobs) << mi_ctx->log2_chroma_h;
+    const int slice_end   = FFMIN(((nb_rows * (jobnr+1)) / nb_jobs) << mi_ctx->log2_chroma_h, height);
     int x, y, plane;
 
     for (plane = 0; plane < mi_ctx->nb_planes; plane++) {
-        int width = avf_out->width;
-        int height = avf_out->height;
         int chroma = plane == 1 || plane == 2;
 
-        for (y = 0; y < height; y++)
+        for (y = slice_start; y < slice_end; y++)
             for (x = 0; x < width; x++) {
                 int x_mv, y_mv;
                 int weight_sum = 0;
@@ -971,6 +985,50 @@ static void set_frame_data(MIContext *mi_ctx, int alpha, AVFrame *avf_out)
                     avf_out->data[plane][x + y * avf_out->linesize[plane]] = val;
             }
     }
+
+    return 0;
+}
+
+static void set_frame_data(AVFilterContext *ctx, int alpha, AVFrame *avf_out)
+{
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData td = { .out = avf_out, .alpha = alpha };
+
+    ctx->internal->execute(ctx, set_frame_data_slice, &td, NULL,
+                           FFMIN(AV_CEIL_RSHIFT(avf_out->height, mi_ctx->log2_chroma_h),
+                                 ff_filter_get_nb_threads(ctx)));
+}
+
+static int blend_frames_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *avf_out = td->out;
+    const int alpha = td->alpha;
+    int x, y, plane;
+
+    for (plane = 0; plane < mi_ctx->nb_planes; plane++) {
+        int width = avf_out->width;
+        int height = avf_out->height;
+        int slice_start, slice_end;
+
+        if (plane == 1 || plane == 2) {
+            width = AV_CEIL_RSHIFT(width, mi_ctx->log2_chroma_w);
+            height = AV_CEIL_RSHIFT(height, mi_ctx->log2_chroma_h);
+        }
+        slice_start = (height *  jobnr   ) / nb_jobs;
+        slice_end   = (height * (jobnr+1)) / nb_jobs;
+
+        for (y = slice_start; y < slice_end; y++) {
+            for (x = 0; x < width; x++) {
+                avf_out->data[plane][x + y * avf_out->linesize[plane]] =
+                    (alpha  * mi_ctx->frames[2].avf->data[plane][x + y * mi_ctx->frames[2].avf->linesize[plane]] +
+                     (ALPHA_MAX - alpha) * mi_ctx->frames[1].avf->data[plane][x + y * mi_ctx->frames[1].avf->linesize[plane]] + 512) >> 10;
+            }
+        }
+    }
+
+    return 0;
 }
 
 static void var_size_bmc(MIContext *mi_ctx, Block *block, int x_mb, int y_mb, int n, int alpha)
@@ -1082,7 +1140,7 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
     AVFilterLink *outlink = ctx->outputs[0];
     MIContext *mi_ctx = ctx->priv;
     int x, y;
-    int plane, alpha;
+    int alpha;
     int64_t pts;
 
     pts = av_rescale(avf_out->pts, (int64_t) ALPHA_MAX * outlink->time_base.num * inlink->time_base.den,
@@ -1108,30 +1166,18 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
             av_frame_copy(avf_out, alpha > ALPHA_MAX / 2 ? mi_ctx->frames[2].avf : mi_ctx->frames[1].avf);
 
             break;
-        case MI_MODE_BLEND:
-            for (plane = 0; plane < mi_ctx->nb_planes; plane++) {
-                int width = avf_out->width;
-                int height = avf_out->height;
-
-                if (plane == 1 || plane == 2) {
-                    width = AV_CEIL_RSHIFT(width, mi_ctx->log2_chroma_w);
-                    height = AV_CEIL_RSHIFT(height, mi_ctx->log2_chroma_h);
-                }
-
-                for (y = 0; y < height; y++) {
-                    for (x = 0; x < width; x++) {
-                        avf_out->data[plane][x + y * avf_out->linesize[plane]] =
-                            (alpha  * mi_ctx->frames[2].avf->data[plane][x + y * mi_ctx->frames[2].avf->linesize[plane]] +
-                             (ALPHA_MAX - alpha) * mi_ctx->frames[1].avf->data[plane][x + y * mi_ctx->frames[1].avf->linesize[plane]] + 512) >> 10;
-                    }
-                }
-            }
+        case MI_MODE_BLEND: {
+            ThreadData td = { .out = avf_out, .alpha = alpha };
 
+            ctx->internal->execute(ctx, blend_frames_slice, &td, NULL,
+                                   FFMIN(AV_CEIL_RSHIFT(avf_out->height, mi_ctx->log2_chroma_h),
+                                         ff_filter_get_nb_threads(ctx)));
             break;
+        }
         case MI_MODE_MCI:
             if (mi_ctx->me_mode == ME_MODE_BIDIR) {
                 bidirectional_obmc(mi_ctx, alpha);
-                set_frame_data(mi_ctx, alpha, avf_out);
+                set_frame_data(ctx, alpha, avf_out);
 
             } else if (mi_ctx->me_mode == ME_MODE_BILAT) {
                 int mb_x, mb_y;
@@ -1152,7 +1198,7 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
 
                     }
 
-                set_frame_data(mi_ctx, alpha, avf_out);
+                set_frame_data(ctx, alpha, avf_out);
             }
 
             break;
@@ -1268,4 +1314,5 @@ AVFilter ff_vf_minterpolate = {
     .query_formats = query_formats,
     .inputs        = minterpolate_inputs,
     .outputs       = minterpolate_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
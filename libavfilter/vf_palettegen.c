@@ -76,6 +76,10 @@ typedef struct PaletteGenContext {
     int nb_boxes;                           // number of boxes (increase will segmenting them)
     int palette_pushed;                     // if the palette frame is pushed into the outlink or not
     uint8_t transparency_color[4];          // background color for transparency
+
+    struct hist_node *slice_hist;           // per-job histograms for slice threading (nb_jobs * HIST_SIZE)
+    int *slice_ret;                         // per-job return values
+    int nb_jobs;                            // number of slices a frame is split into
 } PaletteGenContext;
 
 #define OFFSET(x) offsetof(PaletteGenContext, x)
@@ -433,11 +437,12 @@ static int color_inc(struct hist_node *hist, uint32_t color)
  * Update histogram when pixels differ from previous frame.
  */
 static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+                                 const AVFrame *f1, const AVFrame *f2,
+                                 int y_start, int y_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
@@ -456,11 +461,12 @@ static int update_histogram_diff(struct hist_node *hist,
 /**
  * Simple histogram of the frame.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int update_histogram_frame(struct hist_node *hist, const AVFrame *f,
+                                  int y_start, int y_end)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
 
         for (x = 0; x < f->width; x++) {
@@ -473,6 +479,90 @@ static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
     return nb_diff_colors;
 }
 
+typedef struct ThreadData {
+    const AVFrame *in, *prev;
+} ThreadData;
+
+/**
+ * Build the histogram of a band of rows into the histogram of the job.
+ */
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    struct hist_node *hist = s->slice_hist + jobnr * HIST_SIZE;
+    const int y_start = (td->in->height *  jobnr   ) / nb_jobs;
+    const int y_end   = (td->in->height * (jobnr+1)) / nb_jobs;
+
+    return td->prev ? update_histogram_diff(hist, td->prev, td->in, y_start, y_end)
+                    : update_histogram_frame(hist, td->in, y_start, y_end);
+}
+
+/**
+ * Merge a range of hash buckets of the job histograms into the main one.
+ * The jobs are merged in slice order, so the colors end up in the main
+ * histogram in the same order a single-threaded scan would have put them.
+ */
+static int merge_histograms_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const int start = (HIST_SIZE *  jobnr   ) / nb_jobs;
+    const int end   = (HIST_SIZE * (jobnr+1)) / nb_jobs;
+    int i, j, k, n, nb_diff_colors = 0;
+
+    for (i = start; i < end; i++) {
+        struct hist_node *node = &s->histogram[i];
+
+        for (j = 0; j < s->nb_jobs; j++) {
+            struct hist_node *src = &s->slice_hist[j * HIST_SIZE + i];
+
+            for (k = 0; k < src->nb_entries; k++) {
+                const struct color_ref *ref = &src->entries[k];
+                struct color_ref *e;
+
+                for (n = 0; n < node->nb_entries; n++) {
+                    if (node->entries[n].color == ref->color)
+                        break;
+                }
+                if (n < node->nb_entries) {
+                    node->entries[n].count += ref->count;
+                    continue;
+                }
+                e = av_dynarray2_add((void**)&node->entries, &node->nb_entries,
+                                     sizeof(*node->entries), (const uint8_t *)ref);
+                if (!e)
+                    return AVERROR(ENOMEM);
+                nb_diff_colors++;
+            }
+            src->nb_entries = 0;
+        }
+    }
+    return nb_diff_colors;
+}
+
+static int update_histogram_threaded(AVFilterContext *ctx, const AVFrame *in,
+                                     const AVFrame *prev)
+{
+    PaletteGenContext *s = ctx->priv;
+    ThreadData td = { .in = in, .prev = prev };
+    int i, ret = 0, nb_diff_colors = 0;
+
+    ctx->internal->execute(ctx, update_histogram_slice, &td, s->slice_ret, s->nb_jobs);
+    for (i = 0; i < s->nb_jobs; i++)
+        if (s->slice_ret[i] < 0)
+            ret = s->slice_ret[i];
+
+    /* merge even on error so that the job histograms are emptied */
+    ctx->internal->execute(ctx, merge_histograms_slice, NULL, s->slice_ret, s->nb_jobs);
+    for (i = 0; i < s->nb_jobs; i++) {
+        if (s->slice_ret[i] < 0)
+            ret = s->slice_ret[i];
+        else
+            nb_diff_colors += s->slice_ret[i];
+    }
+    return ret < 0 ? ret : nb_diff_colors;
+}
+
 /**
  * Update the histogram for each passing frame. No frame will be pushed here.
  */
@@ -480,8 +570,14 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                            : update_histogram_frame(s->histogram, in);
+    int ret;
+
+    if (s->nb_jobs > 1)
+        ret = update_histogram_threaded(ctx, in, s->prev_frame);
+    else
+        ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in,
+                                                    0, in->height)
+                            : update_histogram_frame(s->histogram, in, 0, in->height);
 
     if (ret > 0)
         s->nb_refs += ret;
@@ -530,6 +626,23 @@ static int request_frame(AVFilterLink *outlink)
     return r;
 }
 
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    PaletteGenContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(ff_filter_get_nb_threads(ctx), inlink->h);
+
+    if (nb_jobs <= 1 || s->slice_hist)
+        return 0;
+
+    s->slice_hist = av_calloc(nb_jobs * HIST_SIZE, sizeof(*s->slice_hist));
+    s->slice_ret  = av_calloc(nb_jobs, sizeof(*s->slice_ret));
+    if (!s->slice_hist || !s->slice_ret)
+        return AVERROR(ENOMEM);
+    s->nb_jobs = nb_jobs;
+    return 0;
+}
+
 /**
  * The output is one simple 16x16 squared-pixels palette.
  */
@@ -547,6 +660,12 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
+    if (s->slice_hist) {
+        for (i = 0; i < s->nb_jobs * HIST_SIZE; i++)
+            av_freep(&s->slice_hist[i].entries);
+        av_freep(&s->slice_hist);
+    }
+    av_freep(&s->slice_ret);
     av_freep(&s->refs);
     av_frame_free(&s->prev_frame);
 }
@@ -555,6 +674,7 @@ static const AVFilterPad palettegen_inputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input,
         .filter_frame = filter_frame,
     },
     { NULL }
@@ -579,4 +699,5 @@ AVFilter ff_vf_palettegen = {
     .inputs        = palettegen_inputs,
     .outputs       = palettegen_outputs,
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
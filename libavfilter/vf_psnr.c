@@ -36,11 +36,19 @@
 #include "psnr.h"
 #include "video.h"
 
+typedef struct PSNRScore {
+    double mse, min_mse, max_mse, mse_comp[4];
+    uint64_t nb_frames;
+} PSNRScore;
+
 typedef struct PSNRContext {
     const AVClass *class;
     FFFrameSync fs;
-    double mse, min_mse, max_mse, mse_comp[4];
-    uint64_t nb_frames;
+    int nb_mains;
+    PSNRScore *scores;
+    AVFrame **frames;
+    uint64_t *sse;
+    int nb_threads;
     FILE *stats_file;
     char *stats_file_str;
     int stats_version;
@@ -65,6 +73,7 @@ static const AVOption psnr_options[] = {
     {"f",          "Set file where to store per-frame difference information", OFFSET(stats_file_str), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
     {"stats_version", "Set the format version for the stats file.",               OFFSET(stats_version),  AV_OPT_TYPE_INT,    {.i64=1},    1, 2, FLAGS },
     {"output_max",  "Add raw stats (max values) to the output log.",            OFFSET(stats_add_max), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS},
+    {"inputs",      "Set number of main inputs compared to the reference",      OFFSET(nb_mains), AV_OPT_TYPE_INT, {.i64=1}, 1, INT_MAX, FLAGS},
     { NULL }
 };
 
@@ -104,86 +113,99 @@ static uint64_t sse_line_16bit(const uint8_t *_main_line, const uint8_t *_ref_li
     return m2;
 }
 
-static inline
-void compute_images_mse(PSNRContext *s,
-                        const uint8_t *main_data[4], const int main_linesizes[4],
-                        const uint8_t *ref_data[4], const int ref_linesizes[4],
-                        int w, int h, double mse[4])
+typedef struct ThreadData {
+    AVFrame **mains;
+    const AVFrame *ref;
+} ThreadData;
+
+/* main input k is at input pad 0 for k == 0, after the reference otherwise */
+static inline int main_input_idx(int k)
+{
+    return k ? k + 1 : 0;
+}
+
+static int compute_images_sse(AVFilterContext *ctx, void *arg,
+                              int jobnr, int nb_jobs)
 {
-    int i, c;
+    PSNRContext *s = ctx->priv;
+    ThreadData *td = arg;
+    uint64_t *sse = s->sse + jobnr * s->nb_mains * 4;
+    int i, c, k;
 
     for (c = 0; c < s->nb_components; c++) {
         const int outw = s->planewidth[c];
         const int outh = s->planeheight[c];
-        const uint8_t *main_line = main_data[c];
-        const uint8_t *ref_line = ref_data[c];
-        const int ref_linesize = ref_linesizes[c];
-        const int main_linesize = main_linesizes[c];
-        uint64_t m = 0;
-        for (i = 0; i < outh; i++) {
-            m += s->dsp.sse_line(main_line, ref_line, outw);
+        const int slice_start = (outh *  jobnr   ) / nb_jobs;
+        const int slice_end   = (outh * (jobnr+1)) / nb_jobs;
+        const int ref_linesize = td->ref->linesize[c];
+        const uint8_t *ref_line = td->ref->data[c] + slice_start * ref_linesize;
+
+        for (k = 0; k < s->nb_mains; k++)
+            sse[k * 4 + c] = 0;
+        /* all the main inputs are scored on a line while the reference line
+         * is still in cache */
+        for (i = slice_start; i < slice_end; i++) {
+            for (k = 0; k < s->nb_mains; k++) {
+                const AVFrame *main = td->mains[k];
+
+                if (!main)
+                    continue;
+                sse[k * 4 + c] += s->dsp.sse_line(main->data[c] + i * main->linesize[c],
+                                                  ref_line, outw);
+            }
             ref_line += ref_linesize;
-            main_line += main_linesize;
         }
-        mse[c] = m / (double)(outw * outh);
     }
+
+    return 0;
 }
 
-static void set_meta(AVDictionary **metadata, const char *key, char comp, float d)
+static void set_meta(AVDictionary **metadata, int input, const char *key, char comp, float d)
 {
     char value[128];
+    char key2[128];
     snprintf(value, sizeof(value), "%0.2f", d);
-    if (comp) {
-        char key2[128];
-        snprintf(key2, sizeof(key2), "%s%c", key, comp);
-        av_dict_set(metadata, key2, value, 0);
-    } else {
-        av_dict_set(metadata, key, value, 0);
-    }
+    if (input)
+        snprintf(key2, sizeof(key2), "lavfi.psnr.%d.%s", input, key);
+    else
+        snprintf(key2, sizeof(key2), "lavfi.psnr.%s", key);
+    if (comp)
+        av_strlcatf(key2, sizeof(key2), "%c", comp);
+    av_dict_set(metadata, key2, value, 0);
 }
 
-static int do_psnr(FFFrameSync *fs)
+static void log_frame(AVFilterContext *ctx, AVDictionary **metadata, int input,
+                      const double comp_mse[4])
 {
-    AVFilterContext *ctx = fs->parent;
     PSNRContext *s = ctx->priv;
-    AVFrame *master, *ref;
-    double comp_mse[4], mse = 0;
-    int ret, j, c;
-    AVDictionary **metadata;
-
-    ret = ff_framesync_dualinput_get(fs, &master, &ref);
-    if (ret < 0)
-        return ret;
-    if (!ref)
-        return ff_filter_frame(ctx->outputs[0], master);
-    metadata = &master->metadata;
-
-    compute_images_mse(s, (const uint8_t **)master->data, master->linesize,
-                          (const uint8_t **)ref->data, ref->linesize,
-                          master->width, master->height, comp_mse);
+    PSNRScore *score = &s->scores[input];
+    double mse = 0;
+    int j, c;
 
     for (j = 0; j < s->nb_components; j++)
         mse += comp_mse[j] * s->planeweight[j];
 
-    s->min_mse = FFMIN(s->min_mse, mse);
-    s->max_mse = FFMAX(s->max_mse, mse);
+    score->min_mse = FFMIN(score->min_mse, mse);
+    score->max_mse = FFMAX(score->max_mse, mse);
 
-    s->mse += mse;
+    score->mse += mse;
     for (j = 0; j < s->nb_components; j++)
-        s->mse_comp[j] += comp_mse[j];
-    s->nb_frames++;
+        score->mse_comp[j] += comp_mse[j];
+    score->nb_frames++;
 
     for (j = 0; j < s->nb_components; j++) {
         c = s->is_rgb ? s->rgba_map[j] : j;
-        set_meta(metadata, "lavfi.psnr.mse.", s->comps[j], comp_mse[c]);
-        set_meta(metadata, "lavfi.psnr.psnr.", s->comps[j], get_psnr(comp_mse[c], 1, s->max[c]));
+        set_meta(metadata, input, "mse.", s->comps[j], comp_mse[c]);
+        set_meta(metadata, input, "psnr.", s->comps[j], get_psnr(comp_mse[c], 1, s->max[c]));
     }
-    set_meta(metadata, "lavfi.psnr.mse_avg", 0, mse);
-    set_meta(metadata, "lavfi.psnr.psnr_avg", 0, get_psnr(mse, 1, s->average_max));
+    set_meta(metadata, input, "mse_avg", 0, mse);
+    set_meta(metadata, input, "psnr_avg", 0, get_psnr(mse, 1, s->average_max));
 
     if (s->stats_file) {
         if (s->stats_version == 2 && !s->stats_header_written) {
             fprintf(s->stats_file, "psnr_log_version:2 fields:n");
+            if (s->nb_mains > 1)
+                fprintf(s->stats_file, ",input");
             fprintf(s->stats_file, ",mse_avg");
             for (j = 0; j < s->nb_components; j++) {
                 fprintf(s->stats_file, ",mse_%c", s->comps[j]);
@@ -201,7 +223,10 @@ static int do_psnr(FFFrameSync *fs)
             fprintf(s->stats_file, "\n");
             s->stats_header_written = 1;
         }
-        fprintf(s->stats_file, "n:%"PRId64" mse_avg:%0.2f ", s->nb_frames, mse);
+        fprintf(s->stats_file, "n:%"PRId64" ", score->nb_frames);
+        if (s->nb_mains > 1)
+            fprintf(s->stats_file, "input:%d ", input);
+        fprintf(s->stats_file, "mse_avg:%0.2f ", mse);
         for (j = 0; j < s->nb_components; j++) {
             c = s->is_rgb ? s->rgba_map[j] : j;
             fprintf(s->stats_file, "mse_%c:%0.2f ", s->comps[j], comp_mse[c]);
@@ -221,6 +246,50 @@ static int do_psnr(FFFrameSync *fs)
         }
         fprintf(s->stats_file, "\n");
     }
+}
+
+static int do_psnr(FFFrameSync *fs)
+{
+    AVFilterContext *ctx = fs->parent;
+    PSNRContext *s = ctx->priv;
+    AVFrame *master, *ref, **mains = s->frames;
+    ThreadData td;
+    int ret, j, k, c, nb_jobs;
+
+    ret = ff_framesync_dualinput_get(fs, &master, &ref);
+    if (ret < 0)
+        return ret;
+    if (!ref)
+        return ff_filter_frame(ctx->outputs[0], master);
+
+    mains[0] = master;
+    for (k = 1; k < s->nb_mains; k++) {
+        ret = ff_framesync_get_frame(fs, main_input_idx(k), &mains[k], 0);
+        if (ret < 0) {
+            av_frame_free(&master);
+            return ret;
+        }
+    }
+
+    td.mains = mains;
+    td.ref   = ref;
+    nb_jobs  = FFMIN(s->planeheight[0], s->nb_threads);
+    ctx->internal->execute(ctx, compute_images_sse, &td, NULL, nb_jobs);
+
+    for (k = 0; k < s->nb_mains; k++) {
+        double comp_mse[4];
+
+        if (!mains[k])
+            continue;
+        for (c = 0; c < s->nb_components; c++) {
+            uint64_t m = 0;
+
+            for (j = 0; j < nb_jobs; j++)
+                m += s->sse[(j * s->nb_mains + k) * 4 + c];
+            comp_mse[c] = m / (double)(s->planewidth[c] * s->planeheight[c]);
+        }
+        log_frame(ctx, &master->metadata, k, comp_mse);
+    }
 
     return ff_filter_frame(ctx->outputs[0], master);
 }
@@ -228,9 +297,30 @@ static int do_psnr(FFFrameSync *fs)
 static av_cold int init(AVFilterContext *ctx)
 {
     PSNRContext *s = ctx->priv;
+    int i, ret;
+
+    s->scores = av_calloc(s->nb_mains, sizeof(*s->scores));
+    s->frames = av_calloc(s->nb_mains, sizeof(*s->frames));
+    if (!s->scores || !s->frames)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_mains; i++) {
+        s->scores[i].min_mse = +INFINITY;
+        s->scores[i].max_mse = -INFINITY;
+    }
 
-    s->min_mse = +INFINITY;
-    s->max_mse = -INFINITY;
+    for (i = 1; i < s->nb_mains; i++) {
+        AVFilterPad pad = { 0 };
+
+        pad.type = AVMEDIA_TYPE_VIDEO;
+        pad.name = av_asprintf("main%d", i);
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+
+        if ((ret = ff_insert_inpad(ctx, main_input_idx(i), &pad)) < 0) {
+            av_freep(&pad.name);
+            return ret;
+        }
+    }
 
     if (s->stats_file_str) {
         if (s->stats_version < 2 && s->stats_add_max) {
@@ -329,6 +419,12 @@ static int config_input_ref(AVFilterLink *inlink)
     if (ARCH_X86)
         ff_psnr_init_x86(&s->dsp, desc->comp[0].depth);
 
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&s->sse);
+    s->sse = av_malloc_array(s->nb_threads * s->nb_mains, sizeof(*s->sse) * 4);
+    if (!s->sse)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -337,11 +433,28 @@ static int config_output(AVFilterLink *outlink)
     AVFilterContext *ctx = outlink->src;
     PSNRContext *s = ctx->priv;
     AVFilterLink *mainlink = ctx->inputs[0];
-    int ret;
+    int i, ret;
 
-    ret = ff_framesync_init_dualinput(&s->fs, ctx);
+    for (i = 2; i < ctx->nb_inputs; i++) {
+        if (ctx->inputs[i]->w != mainlink->w || ctx->inputs[i]->h != mainlink->h) {
+            av_log(ctx, AV_LOG_ERROR, "Width and height of input videos must be same.\n");
+            return AVERROR(EINVAL);
+        }
+        if (ctx->inputs[i]->format != mainlink->format) {
+            av_log(ctx, AV_LOG_ERROR, "Inputs must be of same pixel format.\n");
+            return AVERROR(EINVAL);
+        }
+    }
+
+    ret = ff_framesync_init(&s->fs, ctx, ctx->nb_inputs);
     if (ret < 0)
         return ret;
+    for (i = 0; i < ctx->nb_inputs; i++) {
+        s->fs.in[i].time_base = ctx->inputs[i]->time_base;
+        s->fs.in[i].sync      = i ? 1 : 2;
+        s->fs.in[i].before    = i ? EXT_NULL : EXT_STOP;
+        s->fs.in[i].after     = EXT_INFINITY;
+    }
     outlink->w = mainlink->w;
     outlink->h = mainlink->h;
     outlink->time_base = mainlink->time_base;
@@ -370,28 +483,40 @@ static int activate(AVFilterContext *ctx)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     PSNRContext *s = ctx->priv;
+    int i, j;
 
-    if (s->nb_frames > 0) {
-        int j;
+    for (i = 0; s->scores && i < s->nb_mains; i++) {
+        PSNRScore *score = &s->scores[i];
         char buf[256];
 
+        if (!score->nb_frames)
+            continue;
+
         buf[0] = 0;
+        if (s->nb_mains > 1)
+            av_strlcatf(buf, sizeof(buf), " input:%d", i);
         for (j = 0; j < s->nb_components; j++) {
             int c = s->is_rgb ? s->rgba_map[j] : j;
             av_strlcatf(buf, sizeof(buf), " %c:%f", s->comps[j],
-                        get_psnr(s->mse_comp[c], s->nb_frames, s->max[c]));
+                        get_psnr(score->mse_comp[c], score->nb_frames, s->max[c]));
         }
         av_log(ctx, AV_LOG_INFO, "PSNR%s average:%f min:%f max:%f\n",
                buf,
-               get_psnr(s->mse, s->nb_frames, s->average_max),
-               get_psnr(s->max_mse, 1, s->average_max),
-               get_psnr(s->min_mse, 1, s->average_max));
+               get_psnr(score->mse, score->nb_frames, s->average_max),
+               get_psnr(score->max_mse, 1, s->average_max),
+               get_psnr(score->min_mse, 1, s->average_max));
     }
 
     ff_framesync_uninit(&s->fs);
 
     if (s->stats_file && s->stats_file != stdout)
         fclose(s->stats_file);
+
+    av_freep(&s->scores);
+    av_freep(&s->frames);
+    av_freep(&s->sse);
+    for (i = 2; i < ctx->nb_inputs; i++)
+        av_freep(&ctx->input_pads[i].name);
 }
 
 static const AVFilterPad psnr_inputs[] = {
@@ -427,4 +552,5 @@ AVFilter ff_vf_psnr = {
     .priv_class    = &psnr_class,
     .inputs        = psnr_inputs,
     .outputs       = psnr_outputs,
+    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
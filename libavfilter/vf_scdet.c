@@ -29,6 +29,7 @@
 
 #include "avfilter.h"
 #include "filters.h"
+#include "internal.h"
 #include "scene_sad.h"
 
 typedef struct SCDetContext {
@@ -39,6 +40,8 @@ typedef struct SCDetContext {
     int nb_planes;
     int bitdepth;
     ff_scene_sad_fn sad;
+    uint64_t *slice_sad;    ///< sum of absolute differences of each slice
+    int nb_threads;
     double prev_mafd;
     double scene_score;
     AVFrame *prev_picref;
@@ -103,6 +106,12 @@ static int config_input(AVFilterLink *inlink)
     if (!s->sad)
         return AVERROR(EINVAL);
 
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&s->slice_sad);
+    s->slice_sad = av_calloc(s->nb_threads, sizeof(*s->slice_sad));
+    if (!s->slice_sad)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -111,6 +120,37 @@ static av_cold void uninit(AVFilterContext *ctx)
     SCDetContext *s = ctx->priv;
 
     av_frame_free(&s->prev_picref);
+    av_freep(&s->slice_sad);
+}
+
+static int sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SCDetContext *s = ctx->priv;
+    AVFrame *frame = arg;
+    AVFrame *prev_picref = s->prev_picref;
+    uint64_t sad = 0;
+
+    for (int plane = 0; plane < s->nb_planes; plane++) {
+        const int slice_start = (s->height[plane] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (s->height[plane] * (jobnr+1)) / nb_jobs;
+        uint64_t plane_sad;
+
+        /* chroma planes are shorter and may leave this job an empty band */
+        if (slice_end == slice_start)
+            continue;
+
+        s->sad(prev_picref->data[plane] + slice_start * prev_picref->linesize[plane],
+               prev_picref->linesize[plane],
+               frame->data[plane] + slice_start * frame->linesize[plane],
+               frame->linesize[plane],
+               s->width[plane], slice_end - slice_start, &plane_sad);
+        sad += plane_sad;
+    }
+    emms_c();
+
+    s->slice_sad[jobnr] = sad;
+
+    return 0;
 }
 
 static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
@@ -121,20 +161,18 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
 
     if (prev_picref && frame->height == prev_picref->height
                     && frame->width  == prev_picref->width) {
+        const int nb_jobs = FFMIN(s->height[0], s->nb_threads);
         uint64_t sad = 0;
         double mafd, diff;
         uint64_t count = 0;
 
-        for (int plane = 0; plane < s->nb_planes; plane++) {
-            uint64_t plane_sad;
-            s->sad(prev_picref->data[plane], prev_picref->linesize[plane],
-                    frame->data[plane], frame->linesize[plane],
-                    s->width[plane], s->height[plane], &plane_sad);
-            sad += plane_sad;
+        ctx->internal->execute(ctx, sad_slice, frame, NULL, nb_jobs);
+
+        for (int i = 0; i < nb_jobs; i++)
+            sad += s->slice_sad[i];
+        for (int plane = 0; plane < s->nb_planes; plane++)
             count += s->width[plane] * s->height[plane];
-        }
 
-        emms_c();
         mafd = (double)sad * 100. / count / (1ULL << s->bitdepth);
         diff = fabs(mafd - s->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff), 0, 100.);
@@ -221,4 +259,5 @@ AVFilter ff_vf_scdet = {
     .inputs        = scdet_inputs,
     .outputs       = scdet_outputs,
     .activate      = activate,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
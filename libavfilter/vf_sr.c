@@ -39,6 +39,7 @@ typedef struct SRContext {
 
     char *model_filename;
     DNNBackendType backend_type;
+    int dnn_threads;
     DNNModule *dnn_module;
     DNNModel *model;
     DNNData input;
@@ -58,6 +59,7 @@ static const AVOption sr_options[] = {
 #endif
     { "scale_factor", "scale factor for SRCNN model", OFFSET(scale_factor), AV_OPT_TYPE_INT, { .i64 = 2 }, 2, 4, FLAGS },
     { "model", "path to model file specifying network architecture and its parameters", OFFSET(model_filename), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
+    { "dnn_threads", "number of threads of the native backend, 0 to use the filter thread count", OFFSET(dnn_threads), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -81,7 +83,10 @@ static av_cold int init(AVFilterContext *context)
         av_log(context, AV_LOG_ERROR, "load_model for network was not specified\n");
         return AVERROR(EIO);
     }
-    sr_context->model = (sr_context->dnn_module->load_model)(sr_context->model_filename);
+    if (!sr_context->dnn_threads)
+        sr_context->dnn_threads = ff_filter_get_nb_threads(context);
+    sr_context->model = (sr_context->dnn_module->load_model)(sr_context->model_filename,
+                                                             sr_context->dnn_threads);
     if (!sr_context->model){
         av_log(context, AV_LOG_ERROR, "could not load DNN model\n");
         return AVERROR(EIO);
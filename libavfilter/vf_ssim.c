@@ -45,6 +45,11 @@
 #include "ssim.h"
 #include "video.h"
 
+typedef struct SSIMScore {
+    uint64_t nb_frames;
+    double ssim[4], ssim_total;
+} SSIMScore;
+
 typedef struct SSIMContext {
     const AVClass *class;
     FFFrameSync fs;
@@ -52,20 +57,25 @@ typedef struct SSIMContext {
     char *stats_file_str;
     int nb_components;
     int max;
-    uint64_t nb_frames;
-    double ssim[4], ssim_total;
+    int nb_mains;
+    SSIMScore *scores;
+    AVFrame **frames;
+    double *row_ssim;
+    int row_ssim_stride;
+    int nb_threads;
     char comps[4];
     double coefs[4];
     uint8_t rgba_map[4];
     int planewidth[4];
     int planeheight[4];
-    int *temp;
+    uint8_t *temp;
+    int temp_size;
     int is_rgb;
-    double (*ssim_plane)(SSIMDSPContext *dsp,
-                        uint8_t *main, int main_stride,
-                        uint8_t *ref, int ref_stride,
-                        int width, int height, void *temp,
-                        int max);
+    void (*ssim_plane)(SSIMDSPContext *dsp,
+                       const uint8_t *main, int main_stride,
+                       const uint8_t *ref, int ref_stride,
+                       int width, int y_start, int y_end, void *temp,
+                       int max, double *row_ssim);
     SSIMDSPContext dsp;
 } SSIMContext;
 
@@ -75,22 +85,24 @@ typedef struct SSIMContext {
 static const AVOption ssim_options[] = {
     {"stats_file", "Set file where to store per-frame difference information", OFFSET(stats_file_str), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
     {"f",          "Set file where to store per-frame difference information", OFFSET(stats_file_str), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 0, FLAGS },
+    {"inputs",     "Set number of main inputs compared to the reference",      OFFSET(nb_mains), AV_OPT_TYPE_INT, {.i64=1}, 1, INT_MAX, FLAGS },
     { NULL }
 };
 
 FRAMESYNC_DEFINE_CLASS(ssim, SSIMContext, fs);
 
-static void set_meta(AVDictionary **metadata, const char *key, char comp, float d)
+static void set_meta(AVDictionary **metadata, int input, const char *key, char comp, float d)
 {
     char value[128];
+    char key2[128];
     snprintf(value, sizeof(value), "%0.2f", d);
-    if (comp) {
-        char key2[128];
-        snprintf(key2, sizeof(key2), "%s%c", key, comp);
-        av_dict_set(metadata, key2, value, 0);
-    } else {
-        av_dict_set(metadata, key, value, 0);
-    }
+    if (input)
+        snprintf(key2, sizeof(key2), "lavfi.ssim.%d.%s", input, key);
+    else
+        snprintf(key2, sizeof(key2), "lavfi.ssim.%s", key);
+    if (comp)
+        av_strlcatf(key2, sizeof(key2), "%c", comp);
+    av_dict_set(metadata, key2, value, 0);
 }
 
 static void ssim_4x4xn_16bit(const uint8_t *main8, ptrdiff_t main_stride,
@@ -221,21 +233,24 @@ static double ssim_endn_8bit(const int (*sum0)[4], const int (*sum1)[4], int wid
 
 #define SUM_LEN(w) (((w) >> 2) + 3)
 
-static double ssim_plane_16bit(SSIMDSPContext *dsp,
-                              uint8_t *main, int main_stride,
-                              uint8_t *ref, int ref_stride,
-                              int width, int height, void *temp,
-                              int max)
+/*
+ * Compute the scores of the rows of 4x4 blocks y_start to y_end - 1 of a
+ * plane. Each row overlaps the previous one, so row y_start - 1 is summed
+ * again by every slice.
+ */
+static void ssim_plane_16bit(SSIMDSPContext *dsp,
+                             const uint8_t *main, int main_stride,
+                             const uint8_t *ref, int ref_stride,
+                             int width, int y_start, int y_end, void *temp,
+                             int max, double *row_ssim)
 {
-    int z = 0, y;
-    double ssim = 0.0;
+    int z = y_start - 1, y;
     int64_t (*sum0)[4] = temp;
     int64_t (*sum1)[4] = sum0 + SUM_LEN(width);
 
     width >>= 2;
-    height >>= 2;
 
-    for (y = 1; y < height; y++) {
+    for (y = y_start; y < y_end; y++) {
         for (; z <= y; z++) {
             FFSWAP(void*, sum0, sum1);
             ssim_4x4xn_16bit(&main[4 * z * main_stride], main_stride,
@@ -243,27 +258,23 @@ static double ssim_plane_16bit(SSIMDSPContext *dsp,
                              sum0, width);
         }
 
-        ssim += ssim_endn_16bit((const int64_t (*)[4])sum0, (const int64_t (*)[4])sum1, width - 1, max);
+        row_ssim[y] = ssim_endn_16bit((const int64_t (*)[4])sum0, (const int64_t (*)[4])sum1, width - 1, max);
     }
-
-    return ssim / ((height - 1) * (width - 1));
 }
 
-static double ssim_plane(SSIMDSPContext *dsp,
-                        uint8_t *main, int main_stride,
-                        uint8_t *ref, int ref_stride,
-                        int width, int height, void *temp,
-                        int max)
+static void ssim_plane(SSIMDSPContext *dsp,
+                       const uint8_t *main, int main_stride,
+                       const uint8_t *ref, int ref_stride,
+                       int width, int y_start, int y_end, void *temp,
+                       int max, double *row_ssim)
 {
-    int z = 0, y;
-    double ssim = 0.0;
+    int z = y_start - 1, y;
     int (*sum0)[4] = temp;
     int (*sum1)[4] = sum0 + SUM_LEN(width);
 
     width >>= 2;
-    height >>= 2;
 
-    for (y = 1; y < height; y++) {
+    for (y = y_start; y < y_end; y++) {
         for (; z <= y; z++) {
             FFSWAP(void*, sum0, sum1);
             dsp->ssim_4x4_line(&main[4 * z * main_stride], main_stride,
@@ -271,10 +282,56 @@ static double ssim_plane(SSIMDSPContext *dsp,
                                sum0, width);
         }
 
-        ssim += dsp->ssim_end_line((const int (*)[4])sum0, (const int (*)[4])sum1, width - 1);
+        row_ssim[y] = dsp->ssim_end_line((const int (*)[4])sum0, (const int (*)[4])sum1, width - 1);
+    }
+}
+
+typedef struct ThreadData {
+    AVFrame **mains;
+    const AVFrame *ref;
+} ThreadData;
+
+/* main input k is at input pad 0 for k == 0, after the reference otherwise */
+static inline int main_input_idx(int k)
+{
+    return k ? k + 1 : 0;
+}
+
+/* rows of 4x4 blocks scored for all the main inputs at once, so that the
+ * reference rows are still in cache for all but the first one */
+#define SSIM_BAND_ROWS 32
+
+static int ssim_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SSIMContext *s = ctx->priv;
+    ThreadData *td = arg;
+    void *temp = s->temp + jobnr * s->temp_size;
+    int c, k;
+
+    for (c = 0; c < s->nb_components; c++) {
+        const int rows = (s->planeheight[c] >> 2) - 1;
+        const int slice_start = 1 + (rows *  jobnr   ) / nb_jobs;
+        const int slice_end   = 1 + (rows * (jobnr+1)) / nb_jobs;
+        const int band = s->nb_mains > 1 ? SSIM_BAND_ROWS : FFMAX(slice_end - slice_start, 1);
+        int y;
+
+        for (y = slice_start; y < slice_end; y += band) {
+            const int y_end = FFMIN(y + band, slice_end);
+
+            for (k = 0; k < s->nb_mains; k++) {
+                const AVFrame *main = td->mains[k];
+
+                if (!main)
+                    continue;
+                s->ssim_plane(&s->dsp, main->data[c], main->linesize[c],
+                              td->ref->data[c], td->ref->linesize[c],
+                              s->planewidth[c], y, y_end, temp, s->max,
+                              s->row_ssim + (k * 4 + c) * s->row_ssim_stride);
+            }
+        }
     }
 
-    return ssim / ((height - 1) * (width - 1));
+    return 0;
 }
 
 static double ssim_db(double ssim, double weight)
@@ -286,10 +343,10 @@ static int do_ssim(FFFrameSync *fs)
 {
     AVFilterContext *ctx = fs->parent;
     SSIMContext *s = ctx->priv;
-    AVFrame *master, *ref;
+    AVFrame *master, *ref, **mains = s->frames;
     AVDictionary **metadata;
-    double c[4] = { 0 }, ssimv = 0.0;
-    int ret, i;
+    ThreadData td;
+    int ret, i, k, y;
 
     ret = ff_framesync_dualinput_get(fs, &master, &ref);
     if (ret < 0)
@@ -298,34 +355,61 @@ static int do_ssim(FFFrameSync *fs)
         return ff_filter_frame(ctx->outputs[0], master);
     metadata = &master->metadata;
 
-    s->nb_frames++;
-
-    for (i = 0; i < s->nb_components; i++) {
-        c[i] = s->ssim_plane(&s->dsp, master->data[i], master->linesize[i],
-                             ref->data[i], ref->linesize[i],
-                             s->planewidth[i], s->planeheight[i], s->temp,
-                             s->max);
-        ssimv += s->coefs[i] * c[i];
-        s->ssim[i] += c[i];
-    }
-    for (i = 0; i < s->nb_components; i++) {
-        int cidx = s->is_rgb ? s->rgba_map[i] : i;
-        set_meta(metadata, "lavfi.ssim.", s->comps[i], c[cidx]);
+    mains[0] = master;
+    for (k = 1; k < s->nb_mains; k++) {
+        ret = ff_framesync_get_frame(fs, main_input_idx(k), &mains[k], 0);
+        if (ret < 0) {
+            av_frame_free(&master);
+            return ret;
+        }
     }
-    s->ssim_total += ssimv;
 
-    set_meta(metadata, "lavfi.ssim.All", 0, ssimv);
-    set_meta(metadata, "lavfi.ssim.dB", 0, ssim_db(ssimv, 1.0));
+    td.mains = mains;
+    td.ref   = ref;
+    ctx->internal->execute(ctx, ssim_slice, &td, NULL,
+                           av_clip((s->planeheight[0] >> 2) - 1, 1, s->nb_threads));
+
+    for (k = 0; k < s->nb_mains; k++) {
+        SSIMScore *score = &s->scores[k];
+        double c[4] = { 0 }, ssimv = 0.0;
 
-    if (s->stats_file) {
-        fprintf(s->stats_file, "n:%"PRId64" ", s->nb_frames);
+        if (!mains[k])
+            continue;
+
+        score->nb_frames++;
 
+        for (i = 0; i < s->nb_components; i++) {
+            const double *row_ssim = s->row_ssim + (k * 4 + i) * s->row_ssim_stride;
+            const int width  = s->planewidth[i]  >> 2;
+            const int height = s->planeheight[i] >> 2;
+
+            for (y = 1; y < height; y++)
+                c[i] += row_ssim[y];
+            c[i] /= (height - 1) * (width - 1);
+            ssimv += s->coefs[i] * c[i];
+            score->ssim[i] += c[i];
+        }
         for (i = 0; i < s->nb_components; i++) {
             int cidx = s->is_rgb ? s->rgba_map[i] : i;
-            fprintf(s->stats_file, "%c:%f ", s->comps[i], c[cidx]);
+            set_meta(metadata, k, "", s->comps[i], c[cidx]);
         }
+        score->ssim_total += ssimv;
+
+        set_meta(metadata, k, "All", 0, ssimv);
+        set_meta(metadata, k, "dB", 0, ssim_db(ssimv, 1.0));
+
+        if (s->stats_file) {
+            fprintf(s->stats_file, "n:%"PRId64" ", score->nb_frames);
+            if (s->nb_mains > 1)
+                fprintf(s->stats_file, "input:%d ", k);
 
-        fprintf(s->stats_file, "All:%f (%f)\n", ssimv, ssim_db(ssimv, 1.0));
+            for (i = 0; i < s->nb_components; i++) {
+                int cidx = s->is_rgb ? s->rgba_map[i] : i;
+                fprintf(s->stats_file, "%c:%f ", s->comps[i], c[cidx]);
+            }
+
+            fprintf(s->stats_file, "All:%f (%f)\n", ssimv, ssim_db(ssimv, 1.0));
+        }
     }
 
     return ff_filter_frame(ctx->outputs[0], master);
@@ -334,6 +418,26 @@ static int do_ssim(FFFrameSync *fs)
 static av_cold int init(AVFilterContext *ctx)
 {
     SSIMContext *s = ctx->priv;
+    int i, ret;
+
+    s->scores = av_calloc(s->nb_mains, sizeof(*s->scores));
+    s->frames = av_calloc(s->nb_mains, sizeof(*s->frames));
+    if (!s->scores || !s->frames)
+        return AVERROR(ENOMEM);
+
+    for (i = 1; i < s->nb_mains; i++) {
+        AVFilterPad pad = { 0 };
+
+        pad.type = AVMEDIA_TYPE_VIDEO;
+        pad.name = av_asprintf("main%d", i);
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+
+        if ((ret = ff_insert_inpad(ctx, main_input_idx(i), &pad)) < 0) {
+            av_freep(&pad.name);
+            return ret;
+        }
+    }
 
     if (s->stats_file_str) {
         if (!strcmp(s->stats_file_str, "-")) {
@@ -410,9 +514,17 @@ static int config_input_ref(AVFilterLink *inlink)
     for (i = 0; i < s->nb_components; i++)
         s->coefs[i] = (double) s->planeheight[i] * s->planewidth[i] / sum;
 
-    s->temp = av_mallocz_array(2 * SUM_LEN(inlink->w), (desc->comp[0].depth > 8) ? sizeof(int64_t[4]) : sizeof(int[4]));
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->temp_size = 2 * SUM_LEN(inlink->w) * ((desc->comp[0].depth > 8) ? sizeof(int64_t[4]) : sizeof(int[4]));
+    av_freep(&s->temp);
+    s->temp = av_mallocz_array(s->nb_threads, s->temp_size);
     if (!s->temp)
         return AVERROR(ENOMEM);
+    s->row_ssim_stride = inlink->h >> 2;
+    av_freep(&s->row_ssim);
+    s->row_ssim = av_calloc(s->nb_mains * 4 * s->row_ssim_stride, sizeof(*s->row_ssim));
+    if (!s->row_ssim)
+        return AVERROR(ENOMEM);
     s->max = (1 << desc->comp[0].depth) - 1;
 
     s->ssim_plane = desc->comp[0].depth > 8 ? ssim_plane_16bit : ssim_plane;
@@ -429,11 +541,28 @@ static int config_output(AVFilterLink *outlink)
     AVFilterContext *ctx = outlink->src;
     SSIMContext *s = ctx->priv;
     AVFilterLink *mainlink = ctx->inputs[0];
-    int ret;
+    int i, ret;
 
-    ret = ff_framesync_init_dualinput(&s->fs, ctx);
+    for (i = 2; i < ctx->nb_inputs; i++) {
+        if (ctx->inputs[i]->w != mainlink->w || ctx->inputs[i]->h != mainlink->h) {
+            av_log(ctx, AV_LOG_ERROR, "Width and height of input videos must be same.\n");
+            return AVERROR(EINVAL);
+        }
+        if (ctx->inputs[i]->format != mainlink->format) {
+            av_log(ctx, AV_LOG_ERROR, "Inputs must be of same pixel format.\n");
+            return AVERROR(EINVAL);
+        }
+    }
+
+    ret = ff_framesync_init(&s->fs, ctx, ctx->nb_inputs);
     if (ret < 0)
         return ret;
+    for (i = 0; i < ctx->nb_inputs; i++) {
+        s->fs.in[i].time_base = ctx->inputs[i]->time_base;
+        s->fs.in[i].sync      = i ? 1 : 2;
+        s->fs.in[i].before    = i ? EXT_NULL : EXT_STOP;
+        s->fs.in[i].after     = EXT_INFINITY;
+    }
     outlink->w = mainlink->w;
     outlink->h = mainlink->h;
     outlink->time_base = mainlink->time_base;
@@ -463,18 +592,25 @@ static int activate(AVFilterContext *ctx)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     SSIMContext *s = ctx->priv;
+    int i, k;
 
-    if (s->nb_frames > 0) {
+    for (k = 0; s->scores && k < s->nb_mains; k++) {
+        SSIMScore *score = &s->scores[k];
         char buf[256];
-        int i;
+
+        if (!score->nb_frames)
+            continue;
+
         buf[0] = 0;
+        if (s->nb_mains > 1)
+            av_strlcatf(buf, sizeof(buf), " input:%d", k);
         for (i = 0; i < s->nb_components; i++) {
             int c = s->is_rgb ? s->rgba_map[i] : i;
-            av_strlcatf(buf, sizeof(buf), " %c:%f (%f)", s->comps[i], s->ssim[c] / s->nb_frames,
-                        ssim_db(s->ssim[c], s->nb_frames));
+            av_strlcatf(buf, sizeof(buf), " %c:%f (%f)", s->comps[i], score->ssim[c] / score->nb_frames,
+                        ssim_db(score->ssim[c], score->nb_frames));
         }
         av_log(ctx, AV_LOG_INFO, "SSIM%s All:%f (%f)\n", buf,
-               s->ssim_total / s->nb_frames, ssim_db(s->ssim_total, s->nb_frames));
+               score->ssim_total / score->nb_frames, ssim_db(score->ssim_total, score->nb_frames));
     }
 
     ff_framesync_uninit(&s->fs);
@@ -483,6 +619,11 @@ static av_cold void uninit(AVFilterContext *ctx)
         fclose(s->stats_file);
 
     av_freep(&s->temp);
+    av_freep(&s->row_ssim);
+    av_freep(&s->scores);
+    av_freep(&s->frames);
+    for (i = 2; i < ctx->nb_inputs; i++)
+        av_freep(&ctx->input_pads[i].name);
 }
 
 static const AVFilterPad ssim_inputs[] = {
@@ -518,4 +659,5 @@ AVFilter ff_vf_ssim = {
     .priv_class    = &ssim_class,
     .inputs        = ssim_inputs,
     .outputs       = ssim_outputs,
+    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,311 @@
+;*****************************************************************************
+;* x86-optimized functions for lut3d filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+
+SECTION_RODATA 32
+
+pd_0:       times 8 dd 0
+pd_3:       times 8 dd 3
+pd_1023:    times 8 dd 1023
+pd_4095:    times 8 dd 4095
+pf_255:     times 8 dd 255.0
+pf_1023:    times 8 dd 1023.0
+pf_4095:    times 8 dd 4095.0
+pf_65535:   times 8 dd 65535.0
+pf_flt_min: times 8 dd 0x00800000
+pf_1:       dd 1.0
+
+SECTION .text
+
+; Stack layout: LUT strides for r and g in floats, the per component input
+; scales, lut_max and 1 / maximum sample value, each broadcast to a full vector.
+%define STRIDE_R [rsp + 0*mmsize]
+%define STRIDE_G [rsp + 1*mmsize]
+%define SCALE_R  [rsp + 2*mmsize]
+%define SCALE_G  [rsp + 3*mmsize]
+%define SCALE_B  [rsp + 4*mmsize]
+%define LUT_MAX  [rsp + 5*mmsize]
+%define INV_MAX  [rsp + 6*mmsize]
+
+; Load 8 samples of one component and turn them into a clipped LUT
+; coordinate, with the same operations as the C version. Like sanitizef(),
+; NaN maps to 0 and infinities map to FLT_MIN. The clip is done in the
+; av_clipf() order.
+; %1 = dst, %2 = source pointer, %3 = scale, %4-%5 = tmp
+%macro LOAD 5
+%ifidn cur_fmt, pf32
+    movu         %1, [%2q + xq*4]
+    subps        %4, %1, %1
+    cmpps        %4, %4, %4, 3          ; x - x is NaN for inf and NaN
+    cmpps        %5, %1, %1, 7          ; not NaN
+    andps        %5, [pf_flt_min]
+    blendvps     %1, %1, %5, %4
+%elifidn cur_fmt, p8
+    pmovzxbd     %1, [%2q + xq]
+    cvtdq2ps     %1, %1
+    mulps        %1, INV_MAX
+%else
+    pmovzxwd     %1, [%2q + xq*2]
+    cvtdq2ps     %1, %1
+    mulps        %1, INV_MAX
+%endif
+    mulps        %1, %3
+    minps        %1, LUT_MAX
+    maxps        %1, [pd_0]
+%endmacro
+
+; Split a coordinate into its integer and fractional part.
+; %1 = coordinate in, fraction out, %2 = index of the previous point,
+; %3 = offset to the next point (0 on the last one), %4 = tmp, %5 = stride
+%macro SPLIT 5
+    cvttps2dq    %2, %1
+    cmpps        %3, %1, LUT_MAX, 1
+    cvtdq2ps     %4, %2
+    subps        %1, %4
+    pmulld       %2, %5
+    pand         %3, %5
+%endmacro
+
+; %1 = dst, %2 = index, %3 = component offset in bytes
+%macro GATHER 3
+    pcmpeqd      m11, m11
+    vgatherdps   %1, [lutq + %2*4 + %3], m11
+%endmacro
+
+; %1 = src register number, %2 = dst pointer, %3 = tmp register number
+%macro STORE 3
+%ifidn cur_fmt, pf32
+    movu         [%2q + xq*4], m%1
+%else
+    mulps        m%1, [cur_max]
+    cvttps2dq    m%1, m%1
+%ifidn cur_fmt, p10
+    pminsd       m%1, [pd_1023]
+%elifidn cur_fmt, p12
+    pminsd       m%1, [pd_4095]
+%endif
+    vextracti128 xm%3, m%1, 1
+    packusdw     xm%1, xm%3
+%ifidn cur_fmt, p8
+    packuswb     xm%1, xm%1
+    movq         [%2q + xq], xm%1
+%else
+    movu         [%2q + xq*2], xm%1
+%endif
+%endif
+%endmacro
+
+; in: m0-m2 fractions, m3 index of c000, m4-m6 offsets along r, g and b
+; The vertices and weights are picked with the same comparisons as the C
+; version and the products are summed in the same order.
+%macro TETRAHEDRAL 0
+    cmpps        m7, m1, m0, 1          ; r > g
+    cmpps        m8, m2, m1, 1          ; g > b
+    cmpps        m9, m2, m0, 1          ; r > b
+    cmpps        m10, m1, m2, 1         ; b > g
+    cmpps        m12, m0, m2, 1         ; b > r
+    orps         m13, m8, m9
+    andps        m13, m7                ; r is the largest
+    orps         m14, m7, m10           ; g is not the largest
+    blendvps     m15, m1, m2, m14
+    blendvps     m15, m15, m0, m13      ; largest fraction
+    blendvps     m9, m5, m6, m14
+    blendvps     m9, m9, m4, m13        ; offset along the largest
+    andnps       m10, m8, m7            ; g is the smallest
+    andps        m8, m7                 ; r > g > b
+    orps         m12, m14
+    andnps       m12, m8, m12           ; b is not the smallest
+    blendvps     m7, m0, m1, m10
+    blendvps     m7, m2, m7, m12        ; smallest fraction
+    blendvps     m8, m4, m5, m10
+    blendvps     m8, m6, m8, m12        ; offset along the smallest
+    andnps       m11, m10, m12          ; r is the smallest
+    orps         m11, m13
+    blendvps     m13, m0, m2, m11
+    andnps       m14, m10, m14          ; g is the middle
+    blendvps     m13, m13, m1, m14      ; middle fraction
+
+    vbroadcastss m10, [pf_1]
+    subps        m10, m15               ; weight of c000
+    subps        m15, m13               ; weight of the first vertex
+    subps        m13, m7                ; weight of the second vertex
+    paddd        m9, m3                 ; first vertex
+    paddd        m4, m5
+    paddd        m4, m6
+    psubd        m12, m4, m8
+    paddd        m12, m3                ; second vertex
+    paddd        m4, m3                 ; c111
+
+%assign %%i 0
+%rep 3
+    GATHER       m0, m3, %%i*4
+    GATHER       m1, m9, %%i*4
+    GATHER       m2, m12, %%i*4
+    GATHER       m5, m4, %%i*4
+    mulps        m0, m10
+    mulps        m1, m15
+    addps        m0, m1
+    mulps        m2, m13
+    addps        m0, m2
+    mulps        m5, m7
+    addps        m0, m5
+%if %%i == 0
+    STORE        0, rdst, 1
+%elif %%i == 1
+    STORE        0, gdst, 1
+%else
+    STORE        0, bdst, 1
+%endif
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+; in: m0-m2 fractions, m3 index of c000, m4-m6 offsets along r, g and b
+%macro TRILINEAR 0
+    paddd        m4, m3                 ; c100
+    paddd        m12, m3, m5            ; c010
+    paddd        m13, m4, m5            ; c110
+    paddd        m14, m3, m6            ; c001
+    paddd        m15, m4, m6            ; c101
+    paddd        m5, m12, m6            ; c011
+    paddd        m6, m13                ; c111
+
+%assign %%i 0
+%rep 3
+    GATHER       m7, m3, %%i*4
+    GATHER       m8, m4, %%i*4
+    subps        m8, m7
+    mulps        m8, m0
+    addps        m7, m8                 ; c00
+    GATHER       m8, m12, %%i*4
+    GATHER       m9, m13, %%i*4
+    subps        m9, m8
+    mulps        m9, m0
+    addps        m8, m9                 ; c10
+    subps        m8, m7
+    mulps        m8, m1
+    addps        m7, m8                 ; c0
+    GATHER       m8, m14, %%i*4
+    GATHER       m9, m15, %%i*4
+    subps        m9, m8
+    mulps        m9, m0
+    addps        m8, m9                 ; c01
+    GATHER       m9, m5, %%i*4
+    GATHER       m10, m6, %%i*4
+    subps        m10, m9
+    mulps        m10, m0
+    addps        m9, m10                ; c11
+    subps        m9, m8
+    mulps        m9, m1
+    addps        m8, m9                 ; c1
+    subps        m8, m7
+    mulps        m8, m2
+    addps        m7, m8
+%if %%i == 0
+    STORE        7, rdst, 8
+%elif %%i == 1
+    STORE        7, gdst, 8
+%else
+    STORE        7, bdst, 8
+%endif
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+; void ff_interp_<name>_<format>_avx2(uint8_t *const *dst, const uint8_t *const *src,
+;                                     const struct rgbvec *lut, const float *scale,
+;                                     int lutsize, int w);
+; %1 = name, %2 = format, %3 = maximum sample value
+%macro INTERP 2-3
+cglobal interp_%1_%2, 6, 13, 16, 7*mmsize, dst, src, lut, scale, lutsize, w, x, rdst, gdst, bdst, rsrc, gsrc, bsrc
+%xdefine cur_fmt %2
+%if %0 == 3
+%xdefine cur_max pf_%3
+%endif
+    movsxdifnidn wq, wd
+    mov          rdstq, [dstq]
+    mov          gdstq, [dstq + gprsize]
+    mov          bdstq, [dstq + 2*gprsize]
+    mov          rsrcq, [srcq]
+    mov          gsrcq, [srcq + gprsize]
+    mov          bsrcq, [srcq + 2*gprsize]
+
+    lea          xd, [lutsizeq*2 + lutsizeq]
+    movd         xm0, xd
+    vpbroadcastd m0, xm0
+    mova         STRIDE_G, m0
+    imul         xd, lutsized
+    movd         xm0, xd
+    vpbroadcastd m0, xm0
+    mova         STRIDE_R, m0
+
+%if %0 == 3
+    vbroadcastss m1, [pf_1]
+    divps        m1, [cur_max]
+    mova         INV_MAX, m1
+%endif
+%assign %%i 0
+%rep 3
+    vbroadcastss m0, [scaleq + %%i*4]
+    mova         [rsp + (2 + %%i)*mmsize], m0
+%assign %%i %%i+1
+%endrep
+    vbroadcastss m0, [scaleq + 12]
+    mova         LUT_MAX, m0
+
+    xor          xq, xq
+.loop:
+    LOAD         m0, rsrc, SCALE_R, m3, m4
+    LOAD         m1, gsrc, SCALE_G, m3, m4
+    LOAD         m2, bsrc, SCALE_B, m3, m4
+    SPLIT        m0, m3, m4, m7, STRIDE_R
+    SPLIT        m1, m7, m5, m8, STRIDE_G
+    paddd        m3, m7
+    SPLIT        m2, m7, m6, m8, [pd_3]
+    paddd        m3, m7
+
+%ifidn %1, tetrahedral
+    TETRAHEDRAL
+%else
+    TRILINEAR
+%endif
+
+    add          xq, mmsize / 4
+    cmp          xq, wq
+    jl .loop
+    RET
+%endmacro
+
+INIT_YMM avx2
+INTERP trilinear,   p8,   255
+INTERP trilinear,   p10,  1023
+INTERP trilinear,   p12,  4095
+INTERP trilinear,   p16,  65535
+INTERP trilinear,   pf32
+INTERP tetrahedral, p8,   255
+INTERP tetrahedral, p10,  1023
+INTERP tetrahedral, p12,  4095
+INTERP tetrahedral, p16,  65535
+INTERP tetrahedral, pf32
+
+%endif
@@ -0,0 +1,69 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/lut3d.h"
+
+#define DECLARE_INTERP_FUNC(name, format)                                              \
+void ff_interp_##name##_##format##_avx2(uint8_t *const *dst, const uint8_t *const *src, \
+                                        const struct rgbvec *lut, const float *scale,  \
+                                        int lutsize, int w);
+
+DECLARE_INTERP_FUNC(trilinear,   p8)
+DECLARE_INTERP_FUNC(trilinear,   p10)
+DECLARE_INTERP_FUNC(trilinear,   p12)
+DECLARE_INTERP_FUNC(trilinear,   p16)
+DECLARE_INTERP_FUNC(trilinear,   pf32)
+DECLARE_INTERP_FUNC(tetrahedral, p8)
+DECLARE_INTERP_FUNC(tetrahedral, p10)
+DECLARE_INTERP_FUNC(tetrahedral, p12)
+DECLARE_INTERP_FUNC(tetrahedral, p16)
+DECLARE_INTERP_FUNC(tetrahedral, pf32)
+
+#define SET_INTERP_FUNC(name) do {                                              \
+    if (isfloat) {                                                              \
+        s->interp_line = ff_interp_##name##_pf32_avx2;                          \
+    } else {                                                                    \
+        switch (depth) {                                                        \
+        case  8: s->interp_line = ff_interp_##name##_p8_avx2;  break;           \
+        case 10: s->interp_line = ff_interp_##name##_p10_avx2; break;           \
+        case 12: s->interp_line = ff_interp_##name##_p12_avx2; break;           \
+        case 16: s->interp_line = ff_interp_##name##_p16_avx2; break;           \
+        }                                                                       \
+    }                                                                           \
+} while (0)
+
+av_cold void ff_lut3d_init_x86(LUT3DContext *s, int depth, int isfloat)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        if (s->interpolation == INTERPOLATE_TRILINEAR)
+            SET_INTERP_FUNC(trilinear);
+        else if (s->interpolation == INTERPOLATE_TETRAHEDRAL)
+            SET_INTERP_FUNC(tetrahedral);
+        if (s->interp_line != s->interp_line_c)
+            s->line_block = 8;
+    }
+#endif
+}
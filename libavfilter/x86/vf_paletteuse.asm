@@ -0,0 +1,125 @@
+;*****************************************************************************
+;* x86-optimized functions for paletteuse filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+
+SECTION_RODATA 32
+
+pd_0to7:        dd 0, 1, 2, 3, 4, 5, 6, 7
+pd_8:           times 8 dd 8
+pd_0xff:        times 8 dd 0xff
+pd_0xff00ff:    times 8 dd 0xff00ff
+pd_max_diff:    times 8 dd 255*255*3
+pd_int_max:     times 8 dd 0x7fffffff
+
+SECTION .text
+
+; horizontal signed minimum of the dwords of %1, result in the low dword of
+; xm%2, %3 = tmp
+%macro HMIN 3
+    vextracti128   xm%2, m%1, 1
+    pminsd         xm%2, xm%1
+    pshufd         xm%3, xm%2, q1032
+    pminsd         xm%2, xm%3
+    pshufd         xm%3, xm%2, q2301
+    pminsd         xm%2, xm%3
+%endmacro
+
+;------------------------------------------------------------------------------
+; int ff_nearest_bruteforce(const uint32_t *palette, const uint8_t *argb,
+;                           int trans_thresh)
+;------------------------------------------------------------------------------
+INIT_YMM avx2
+cglobal nearest_bruteforce, 3, 5, 12, palette, argb, thresh, tmp, i
+    ; target r and b as words of a dword, g alone
+    movzx          tmpd, byte [argbq + 1]
+    movzx            id, byte [argbq + 3]
+    shl            tmpd, 16
+    or             tmpd, id
+    movd           xm3, tmpd
+    vpbroadcastd    m3, xm3
+    movzx          tmpd, byte [argbq + 2]
+    movd           xm4, tmpd
+    vpbroadcastd    m4, xm4
+
+    ; an entry is used if its alpha is > trans_thresh - 1
+    lea            tmpd, [threshq - 1]
+    movd           xm5, tmpd
+    vpbroadcastd    m5, xm5
+
+    ; a transparent target is at the same maximum distance of every entry
+    movzx          tmpd, byte [argbq]
+    xor              id, id
+    cmp            tmpd, threshd
+    jge .opaque
+    mov              id, -1
+.opaque:
+    movd           xm6, id
+    vpbroadcastd    m6, xm6
+    pand            m7, m6, [pd_max_diff]
+
+    mova            m8, [pd_int_max]            ; per lane minimum distance
+    pcmpeqd         m9, m9                      ; per lane index of the minimum
+    mova           m10, [pd_0to7]               ; indexes of the current entries
+
+    xor              iq, iq
+.loop:
+    movu            m0, [paletteq + iq]
+    pand            m1, m0, [pd_0xff00ff]
+    psubw           m1, m3
+    pmaddwd         m1, m1                      ; dr*dr + db*db
+    psrld           m2, m0, 8
+    pand            m2, [pd_0xff]
+    psubw           m2, m4
+    pmaddwd         m2, m2                      ; dg*dg
+    paddd           m1, m2
+    pandn           m1, m6, m1
+    por             m1, m7
+
+    psrld           m0, 24
+    pcmpgtd         m0, m5                      ; used entries
+    pand            m1, m0
+    pandn           m0, [pd_int_max]
+    por             m1, m0
+
+    ; keep the first minimum of each lane
+    pcmpgtd        m11, m8, m1
+    pminsd          m8, m1
+    pblendvb        m9, m9, m10, m11
+    paddd          m10, [pd_8]
+    add              iq, mmsize
+    cmp              iq, 256 * 4
+    jl .loop
+
+    ; select the lowest index among the lanes holding the global minimum
+    HMIN             8, 0, 1
+    vpbroadcastd    m0, xm0
+    pcmpeqd         m0, m8
+    pand            m9, m0
+    pandn           m0, [pd_int_max]
+    por             m9, m0
+    HMIN             9, 0, 1
+    movd           eax, xm0
+    movzx          eax, al
+    RET
+
+%endif
@@ -1086,7 +1086,7 @@ typedef struct AVStream {
     struct AVCodecParserContext *parser;
 
     /**
-     * last packet in packet_buffer for this stream when muxing.
+     * last packet in the interleaving queue of this stream when muxing.
      */
     struct AVPacketList *last_in_packet_buffer;
     AVProbeData probe_data;
@@ -1951,6 +1951,16 @@ typedef struct AVFormatContext {
      * - decoding: set by user
      */
     int max_probe_packets;
+
+    /**
+     * Number of threads used to decode probe packets in
+     * avformat_find_stream_info(), 0 for automatic.
+     * Any value other than 1 also skips decoding for streams whose
+     * parameters are fully known from the container.
+     * - encoding: unused
+     * - decoding: set by user
+     */
+    int stream_info_threads;
 } AVFormatContext;
 
 #if FF_API_FORMAT_GET_SET
@@ -649,6 +649,14 @@ int ffurl_get_multi_file_handle(URLContext *h, int **handles, int *numhandles)
     return h->prot->url_get_multi_file_handle(h, handles, numhandles);
 }
 
+int ffurl_read_buffer(URLContext *h, AVBufferRef **buf, uint8_t **data,
+                      int64_t pos, int size)
+{
+    if (!h || !h->prot || !h->prot->url_read_buffer || !(h->flags & AVIO_FLAG_READ))
+        return AVERROR(ENOSYS);
+    return h->prot->url_read_buffer(h, buf, data, pos, size);
+}
+
 int ffurl_get_short_seek(URLContext *h)
 {
     if (!h || !h->prot || !h->prot->url_get_short_seek)
@@ -149,6 +149,15 @@ int ffio_fdopen(AVIOContext **s, URLContext *h);
  */
 URLContext *ffio_geturlcontext(AVIOContext *s);
 
+/**
+ * Read size bytes as a reference into memory held by the underlying
+ * protocol, instead of copying them, and advance the read position.
+ *
+ * @return size on success, a negative AVERROR code if the data cannot be
+ *         read this way; the context is then left untouched.
+ */
+int ffio_read_buffer(AVIOContext *s, AVBufferRef **buf, uint8_t **data, int size);
+
 /**
  * Open a write-only fake memory stream. The written data is not stored
  * anywhere - this is only used for measuring the amount of data
@@ -980,6 +980,36 @@ fail:
     return AVERROR(ENOMEM);
 }
 
+int ffio_read_buffer(AVIOContext *s, AVBufferRef **buf, uint8_t **data, int size)
+{
+    URLContext *h = ffio_geturlcontext(s);
+    int64_t pos = avio_tell(s);
+    int ret;
+
+    if (!h || s->write_flag || s->update_checksum || pos < 0)
+        return AVERROR(ENOSYS);
+
+    ret = ffurl_read_buffer(h, buf, data, pos, size);
+    if (ret < 0)
+        return ret;
+
+    if (s->buf_end - s->buf_ptr >= size) {
+        s->buf_ptr += size;
+    } else {
+        int64_t res = s->seek(s->opaque, pos + size, SEEK_SET);
+        if (res < 0) {
+            av_buffer_unref(buf);
+            *data = NULL;
+            return res;
+        }
+        s->pos     = pos + size;
+        s->buf_ptr = s->buf_end = s->buffer;
+        s->bytes_read += size;
+    }
+
+    return size;
+}
+
 URLContext* ffio_geturlcontext(AVIOContext *s)
 {
     if (!s)
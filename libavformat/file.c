@@ -20,6 +20,7 @@
  */
 
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "avformat.h"
@@ -33,6 +34,9 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include <sys/stat.h>
 #include <stdlib.h>
 #include "os_support.h"
@@ -74,16 +78,28 @@ typedef struct FileContext {
     int blocksize;
     int follow;
     int seekable;
+    int use_mmap;
+    int64_t map_size;       ///< size of the file if packets are mapped, 0 otherwise
+    long page_size;
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
 } FileContext;
 
+typedef struct FileMapping {
+    void *addr;
+    size_t len;
+} FileMapping;
+
+/* Smaller packets are cheaper to copy than to map */
+#define FILE_MAP_MIN_SIZE 65536
+
 static const AVOption file_options[] = {
     { "truncate", "truncate existing files on write", offsetof(FileContext, trunc), AV_OPT_TYPE_BOOL, { .i64 = 1 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM },
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "mmap", "Map the file into memory and read packets from the mapping without copying", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -205,12 +221,88 @@ static int file_move(URLContext *h_src, URLContext *h_dst)
 
 #if CONFIG_FILE_PROTOCOL
 
+#if HAVE_MMAP
+static void file_unmap(void *opaque, uint8_t *data)
+{
+    FileMapping *m = opaque;
+    munmap(m->addr, m->len);
+    av_free(m);
+}
+
+static int file_map(URLContext *h, const struct stat *st)
+{
+    FileContext *c = h->priv_data;
+
+    if (!S_ISREG(st->st_mode) || !st->st_size)
+        return AVERROR(EINVAL);
+
+    c->page_size = sysconf(_SC_PAGESIZE);
+    if (c->page_size <= 0 || c->page_size & (c->page_size - 1))
+        return AVERROR(ENOSYS);
+    c->map_size = st->st_size;
+
+    /* Keep the AVIOContext buffer small, so that little of a mapped packet
+     * has already been copied into it. */
+    h->max_packet_size = 16384;
+
+    return 0;
+}
+
+/**
+ * Map size bytes of the file starting at pos. Every packet gets a private
+ * copy-on-write mapping, so that it can be written to, and its padding is
+ * zeroed, which only copies the last page.
+ */
+static int file_read_buffer(URLContext *h, AVBufferRef **buf, uint8_t **data,
+                            int64_t pos, int size)
+{
+    FileContext *c = h->priv_data;
+    FileMapping *m;
+    int64_t start;
+    size_t len;
+    uint8_t *ptr;
+
+    /* The padding must lie within the file, pages past its end cannot be
+     * accessed. */
+    if (!c->map_size || pos < 0 || size < FILE_MAP_MIN_SIZE || pos > c->map_size ||
+        c->map_size - pos < size + (int64_t)AV_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR(ENOSYS);
+
+    start = pos & ~(int64_t)(c->page_size - 1);
+    len   = pos - start + size + AV_INPUT_BUFFER_PADDING_SIZE;
+
+    m = av_malloc(sizeof(*m));
+    if (!m)
+        return AVERROR(ENOMEM);
+    m->addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, c->fd, start);
+    if (m->addr == MAP_FAILED) {
+        int ret = AVERROR(errno);
+        av_free(m);
+        return ret;
+    }
+    m->len = len;
+
+    ptr = (uint8_t *)m->addr + (pos - start);
+    memset(ptr + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    *buf = av_buffer_create(ptr, size + AV_INPUT_BUFFER_PADDING_SIZE,
+                            file_unmap, m, 0);
+    if (!*buf) {
+        file_unmap(m, NULL);
+        return AVERROR(ENOMEM);
+    }
+    *data = ptr;
+
+    return size;
+}
+#endif
+
 static int file_open(URLContext *h, const char *filename, int flags)
 {
     FileContext *c = h->priv_data;
     int access;
     int fd;
-    struct stat st;
+    struct stat st = { 0 };
 
     av_strstart(filename, "file:", &filename);
 
@@ -243,6 +335,15 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (c->seekable >= 0)
         h->is_streamed = !c->seekable;
 
+    if (c->use_mmap && !(flags & AVIO_FLAG_WRITE) && !c->follow && !h->is_streamed) {
+        int ret = AVERROR(ENOSYS);
+#if HAVE_MMAP
+        ret = file_map(h, &st);
+#endif
+        if (ret < 0)
+            av_log(h, AV_LOG_WARNING, "Could not map the file, reading it instead.\n");
+    }
+
     return 0;
 }
 
@@ -360,6 +461,9 @@ const URLProtocol ff_file_protocol = {
     .url_write           = file_write,
     .url_seek            = file_seek,
     .url_close           = file_close,
+#if HAVE_MMAP
+    .url_read_buffer     = file_read_buffer,
+#endif
     .url_get_file_handle = file_get_handle,
     .url_check           = file_check,
     .url_delete          = file_delete,
@@ -26,6 +26,8 @@
  * http://tools.ietf.org/html/draft-pantos-http-live-streaming
  */
 
+#include <stdatomic.h>
+
 #include "libavformat/http.h"
 #include "libavutil/avstring.h"
 #include "libavutil/avassert.h"
@@ -33,6 +35,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/dict.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "avformat.h"
 #include "internal.h"
@@ -40,6 +43,7 @@
 #include "id3v2.h"
 
 #define INITIAL_BUFFER_SIZE 32768
+#define PREFETCH_CHUNK_SIZE 65536
 
 #define MAX_FIELD_LEN 64
 #define MAX_CHARACTERISTICS_LEN 512
@@ -79,6 +83,35 @@ struct segment {
 
 struct rendition;
 
+/*
+ * A media segment downloaded ahead into memory by a background thread.
+ * The slot is in use if url is set.
+ */
+struct segment_prefetch {
+    struct playlist *pls;
+#if HAVE_THREADS
+    pthread_t thread;
+#endif
+    int thread_active;
+    /* the prefetch thread never calls the user interrupt callback, it is
+     * stopped through abort by the demuxer thread instead */
+    atomic_int abort;
+    /* set under pls->prefetch_lock when the download has finished */
+    int done;
+
+    int seq_no;
+    char *url;
+    AVDictionary *opts;
+    int is_http;
+    int64_t url_offset;
+    int64_t size;
+
+    uint8_t *data;
+    unsigned int data_size;
+    int data_len;
+    int ret;
+};
+
 enum PlaylistType {
     PLS_TYPE_UNSPECIFIED,
     PLS_TYPE_EVENT,
@@ -98,6 +131,15 @@ struct playlist {
     int input_read_done;
     AVIOContext *input_next;
     int input_next_requested;
+    /* prefetched segments, and the one the current segment is read from
+     * instead of input */
+    struct segment_prefetch *prefetch;
+    struct segment_prefetch *input_prefetch;
+#if HAVE_THREADS
+    /* signalled by the prefetch threads when they are done */
+    pthread_mutex_t prefetch_lock;
+    pthread_cond_t prefetch_cond;
+#endif
     AVFormatContext *parent;
     int index;
     AVFormatContext *ctx;
@@ -212,6 +254,8 @@ typedef struct HLSContext {
     int http_persistent;
     int http_multiple;
     int http_seekable;
+    int prefetch_segments;
+    int prefetch_max_size;
     AVIOContext *playlist_pb;
 } HLSContext;
 
@@ -232,6 +276,44 @@ static void free_segment_list(struct playlist *pls)
     pls->n_segments = 0;
 }
 
+static void prefetch_release(struct segment_prefetch *p)
+{
+#if HAVE_THREADS
+    if (p->thread_active) {
+        atomic_store(&p->abort, 1);
+        pthread_join(p->thread, NULL);
+        p->thread_active = 0;
+    }
+#endif
+    av_freep(&p->url);
+    av_dict_free(&p->opts);
+    av_freep(&p->data);
+    p->data_size = 0;
+    p->data_len  = 0;
+}
+
+static void prefetch_flush(HLSContext *c, struct playlist *pls)
+{
+    int i;
+
+    if (pls->prefetch)
+        for (i = 0; i <= c->prefetch_segments; i++)
+            prefetch_release(&pls->prefetch[i]);
+    pls->input_prefetch = NULL;
+}
+
+static void prefetch_free(HLSContext *c, struct playlist *pls)
+{
+    if (!pls->prefetch)
+        return;
+    prefetch_flush(c, pls);
+#if HAVE_THREADS
+    pthread_cond_destroy(&pls->prefetch_cond);
+    pthread_mutex_destroy(&pls->prefetch_lock);
+#endif
+    av_freep(&pls->prefetch);
+}
+
 static void free_init_section_list(struct playlist *pls)
 {
     int i;
@@ -262,6 +344,7 @@ static void free_playlist_list(HLSContext *c)
         pls->input_read_done = 0;
         ff_format_io_close(c->ctx, &pls->input_next);
         pls->input_next_requested = 0;
+        prefetch_free(c, pls);
         if (pls->ctx) {
             pls->ctx->pb = NULL;
             avformat_close_input(&pls->ctx);
@@ -624,13 +707,10 @@ static int open_url_keepalive(AVFormatContext *s, AVIOContext **pb,
 #endif
 }
 
-static int open_url(AVFormatContext *s, AVIOContext **pb, const char *url,
-                    AVDictionary *opts, AVDictionary *opts2, int *is_http_out)
+static int check_url(AVFormatContext *s, const char *url, int *is_http_out)
 {
     HLSContext *c = s->priv_data;
-    AVDictionary *tmp = NULL;
     const char *proto_name = NULL;
-    int ret;
     int is_http = 0;
 
     if (av_strstart(url, "crypto", NULL)) {
@@ -672,6 +752,21 @@ static int open_url(AVFormatContext *s, AVIOContext **pb, const char *url,
     else if (strcmp(proto_name, "file") || !strncmp(url, "file,", 5))
         return AVERROR_INVALIDDATA;
 
+    *is_http_out = is_http;
+    return 0;
+}
+
+static int open_url(AVFormatContext *s, AVIOContext **pb, const char *url,
+                    AVDictionary *opts, AVDictionary *opts2, int *is_http_out)
+{
+    HLSContext *c = s->priv_data;
+    AVDictionary *tmp = NULL;
+    int ret;
+    int is_http;
+
+    if ((ret = check_url(s, url, &is_http)) < 0)
+        return ret;
+
     av_dict_copy(&tmp, opts, 0);
     av_dict_copy(&tmp, opts2, 0);
 
@@ -1014,7 +1109,15 @@ static int read_from_url(struct playlist *pls, struct segment *seg,
     if (seg->size >= 0)
         buf_size = FFMIN(buf_size, seg->size - pls->cur_seg_offset);
 
-    ret = avio_read(pls->input, buf, buf_size);
+    if (pls->input_prefetch) {
+        struct segment_prefetch *p = pls->input_prefetch;
+        ret = FFMIN(buf_size, p->data_len - pls->cur_seg_offset);
+        if (ret <= 0)
+            return AVERROR_EOF;
+        memcpy(buf, p->data + pls->cur_seg_offset, ret);
+    } else {
+        ret = avio_read(pls->input, buf, buf_size);
+    }
     if (ret > 0)
         pls->cur_seg_offset += ret;
 
@@ -1416,6 +1519,214 @@ static int playlist_needed(struct playlist *pls)
     return 0;
 }
 
+#if HAVE_THREADS
+static int prefetch_interrupt_cb(void *opaque)
+{
+    struct segment_prefetch *p = opaque;
+
+    return atomic_load(&p->abort);
+}
+
+static void *prefetch_thread(void *arg)
+{
+    struct segment_prefetch *p = arg;
+    AVFormatContext *s = p->pls->parent;
+    HLSContext *c = s->priv_data;
+    const AVIOInterruptCB int_cb = { prefetch_interrupt_cb, p };
+    AVIOContext *in = NULL;
+    int ret;
+
+    /* The segment is opened directly through the protocol layer, as
+     * s->io_open() and the cookie handling of open_url() are not meant to
+     * be used from several threads at once. */
+    ret = ffio_open_whitelist(&in, p->url, AVIO_FLAG_READ, &int_cb, &p->opts,
+                              s->protocol_whitelist, s->protocol_blacklist);
+    if (ret >= 0 && !p->is_http && p->url_offset) {
+        int64_t seekret = avio_seek(in, p->url_offset, SEEK_SET);
+        if (seekret < 0)
+            ret = seekret;
+    }
+
+    while (ret >= 0) {
+        int len = PREFETCH_CHUNK_SIZE;
+        uint8_t *data;
+
+        if (p->size >= 0)
+            len = FFMIN(len, p->size - p->data_len);
+        if (len <= 0)
+            break;
+        if (len > c->prefetch_max_size - p->data_len) {
+            ret = AVERROR(ERANGE);
+            break;
+        }
+        data = av_fast_realloc(p->data, &p->data_size, p->data_len + len);
+        if (!data) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        p->data = data;
+        ret = avio_read(in, p->data + p->data_len, len);
+        if (ret <= 0)
+            break;
+        p->data_len += ret;
+    }
+    if (ret == AVERROR_EOF || ret > 0)
+        ret = 0;
+
+    avio_closep(&in);
+    pthread_mutex_lock(&p->pls->prefetch_lock);
+    p->ret  = ret;
+    p->done = 1;
+    pthread_cond_broadcast(&p->pls->prefetch_cond);
+    pthread_mutex_unlock(&p->pls->prefetch_lock);
+
+    return NULL;
+}
+
+/* Start downloading the segments following the current one. */
+static void prefetch_schedule(HLSContext *c, struct playlist *pls)
+{
+    int i, seq_no;
+
+    if (c->prefetch_segments <= 0)
+        return;
+
+    if (!pls->prefetch) {
+        pls->prefetch = av_mallocz_array(c->prefetch_segments + 1,
+                                         sizeof(*pls->prefetch));
+        if (!pls->prefetch)
+            return;
+        if (pthread_mutex_init(&pls->prefetch_lock, NULL)) {
+            av_freep(&pls->prefetch);
+            return;
+        }
+        if (pthread_cond_init(&pls->prefetch_cond, NULL)) {
+            pthread_mutex_destroy(&pls->prefetch_lock);
+            av_freep(&pls->prefetch);
+            return;
+        }
+    }
+
+    /* drop segments outside of the prefetch window, e.g. after a
+     * failed open */
+    for (i = 0; i <= c->prefetch_segments; i++) {
+        struct segment_prefetch *p = &pls->prefetch[i];
+        if (p->url && p != pls->input_prefetch &&
+            (p->seq_no <= pls->cur_seq_no ||
+             p->seq_no >  pls->cur_seq_no + c->prefetch_segments))
+            prefetch_release(p);
+    }
+
+    for (seq_no = pls->cur_seq_no + 1;
+         seq_no <= pls->cur_seq_no + c->prefetch_segments; seq_no++) {
+        struct segment_prefetch *p = NULL;
+        struct segment *seg;
+        int is_http;
+
+        if (seq_no - pls->start_seq_no >= pls->n_segments)
+            break;
+        seg = pls->segments[seq_no - pls->start_seq_no];
+        /* keys are fetched on the reading thread */
+        if (seg->key_type != KEY_NONE)
+            continue;
+
+        for (i = 0; i <= c->prefetch_segments; i++) {
+            if (pls->prefetch[i].url && pls->prefetch[i].seq_no == seq_no)
+                break;
+            if (!pls->prefetch[i].url && !p)
+                p = &pls->prefetch[i];
+        }
+        if (i <= c->prefetch_segments)
+            continue;
+        if (!p)
+            break;
+        if (check_url(pls->parent, seg->url, &is_http) < 0)
+            continue;
+
+        p->pls        = pls;
+        p->seq_no     = seq_no;
+        p->is_http    = is_http;
+        p->url_offset = seg->url_offset;
+        p->size       = seg->size;
+        p->ret        = 0;
+        atomic_init(&p->abort, 0);
+        p->done       = 0;
+        p->url        = av_strdup(seg->url);
+        if (!p->url ||
+            av_dict_copy(&p->opts, c->avio_opts, 0) < 0) {
+            prefetch_release(p);
+            break;
+        }
+        if (seg->size >= 0) {
+            av_dict_set_int(&p->opts, "offset", seg->url_offset, 0);
+            av_dict_set_int(&p->opts, "end_offset", seg->url_offset + seg->size, 0);
+        }
+
+        av_log(pls->parent, AV_LOG_VERBOSE, "HLS prefetch for url '%s', offset %"PRId64", playlist %d\n",
+               seg->url, seg->url_offset, pls->index);
+
+        if (pthread_create(&p->thread, NULL, prefetch_thread, p)) {
+            prefetch_release(p);
+            break;
+        }
+        p->thread_active = 1;
+    }
+}
+
+/* Wait for the current segment if it is being prefetched. */
+static struct segment_prefetch *prefetch_get(HLSContext *c, struct playlist *pls)
+{
+    int i, j;
+
+    if (!pls->prefetch)
+        return NULL;
+
+    for (i = 0; i <= c->prefetch_segments; i++) {
+        struct segment_prefetch *p = &pls->prefetch[i];
+
+        if (!p->url || p->seq_no != pls->cur_seq_no)
+            continue;
+
+        pthread_mutex_lock(&pls->prefetch_lock);
+        while (!p->done) {
+            /* wake up regularly to check the interrupt callback */
+            int64_t t = av_gettime() + 100000;
+            struct timespec tv = { .tv_sec  =  t / 1000000,
+                                   .tv_nsec = (t % 1000000) * 1000 };
+            if (ff_check_interrupt(&pls->parent->interrupt_callback)) {
+                for (j = 0; j <= c->prefetch_segments; j++)
+                    atomic_store(&pls->prefetch[j].abort, 1);
+                break;
+            }
+            pthread_cond_timedwait(&pls->prefetch_cond, &pls->prefetch_lock, &tv);
+        }
+        pthread_mutex_unlock(&pls->prefetch_lock);
+        pthread_join(p->thread, NULL);
+        p->thread_active = 0;
+        if (p->ret < 0) {
+            if (p->ret != AVERROR_EXIT)
+                av_log(pls->parent, AV_LOG_VERBOSE,
+                       "Prefetching segment %d of playlist %d failed: %s\n",
+                       p->seq_no, pls->index, av_err2str(p->ret));
+            prefetch_release(p);
+            return NULL;
+        }
+        return p;
+    }
+
+    return NULL;
+}
+#else
+static void prefetch_schedule(HLSContext *c, struct playlist *pls)
+{
+}
+
+static struct segment_prefetch *prefetch_get(HLSContext *c, struct playlist *pls)
+{
+    return NULL;
+}
+#endif
+
 static int read_data(void *opaque, uint8_t *buf, int buf_size)
 {
     struct playlist *v = opaque;
@@ -1429,7 +1740,8 @@ restart:
     if (!v->needed)
         return AVERROR_EOF;
 
-    if (!v->input || (c->http_persistent && v->input_read_done)) {
+    if (!v->input_prefetch &&
+        (!v->input || (c->http_persistent && v->input_read_done))) {
         int64_t reload_interval;
 
         /* Check that the playlist is still needed before opening a new
@@ -1500,7 +1812,13 @@ reload:
         if (ret)
             return ret;
 
-        if (c->http_multiple == 1 && v->input_next_requested) {
+        if ((v->input_prefetch = prefetch_get(c, v))) {
+            /* an open input is an idle persistent connection, keep it
+             * for the segments that are not prefetched */
+            v->input_read_done = !!v->input;
+            v->cur_seg_offset = 0;
+            ret = 0;
+        } else if (c->http_multiple == 1 && v->input_next_requested) {
             FFSWAP(AVIOContext *, v->input, v->input_next);
             v->cur_seg_offset = 0;
             v->input_next_requested = 0;
@@ -1518,9 +1836,11 @@ reload:
             goto reload;
         }
         just_opened = 1;
+
+        prefetch_schedule(c, v);
     }
 
-    if (c->http_multiple == -1) {
+    if (c->http_multiple == -1 && v->input) {
         uint8_t *http_version_opt = NULL;
         int r = av_opt_get(v->input, "http_version", AV_OPT_SEARCH_CHILDREN, &http_version_opt);
         if (r >= 0) {
@@ -1530,7 +1850,7 @@ reload:
     }
 
     seg = next_segment(v);
-    if (c->http_multiple == 1 && !v->input_next_requested &&
+    if (c->http_multiple == 1 && !c->prefetch_segments && !v->input_next_requested &&
         seg && seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
         ret = open_input(c, v, seg, &v->input_next);
         if (ret < 0) {
@@ -1563,7 +1883,10 @@ reload:
 
         return ret;
     }
-    if (c->http_persistent &&
+    if (v->input_prefetch) {
+        prefetch_release(v->input_prefetch);
+        v->input_prefetch = NULL;
+    } else if (c->http_persistent &&
         seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
         v->input_read_done = 1;
     } else {
@@ -1864,6 +2187,11 @@ static int hls_read_header(AVFormatContext *s)
     if ((ret = save_avio_options(s)) < 0)
         goto fail;
 
+    if (!HAVE_THREADS && c->prefetch_segments) {
+        av_log(s, AV_LOG_WARNING, "Segment prefetching requires threads, disabling it\n");
+        c->prefetch_segments = 0;
+    }
+
     /* XXX: Some HLS servers don't like being sent the range header,
        in this case, need to  setting http_seekable = 0 to disable
        the range header */
@@ -2089,6 +2417,7 @@ static int recheck_discard_flags(AVFormatContext *s, int first)
             pls->input_read_done = 0;
             ff_format_io_close(pls->parent, &pls->input_next);
             pls->input_next_requested = 0;
+            prefetch_flush(c, pls);
             pls->needed = 0;
             changed = 1;
             av_log(s, AV_LOG_INFO, "No longer receiving playlist %d\n", i);
@@ -2330,6 +2659,7 @@ static int hls_read_seek(AVFormatContext *s, int stream_index,
         pls->input_read_done = 0;
         ff_format_io_close(pls->parent, &pls->input_next);
         pls->input_next_requested = 0;
+        prefetch_flush(c, pls);
         av_packet_unref(&pls->pkt);
         pls->pb.eof_reached = 0;
         /* Clear any buffered data */
@@ -2391,6 +2721,10 @@ static const AVOption hls_options[] = {
         OFFSET(http_multiple), AV_OPT_TYPE_BOOL, {.i64 = -1}, -1, 1, FLAGS},
     {"http_seekable", "Use HTTP partial requests, 0 = disable, 1 = enable, -1 = auto",
         OFFSET(http_seekable), AV_OPT_TYPE_BOOL, { .i64 = -1}, -1, 1, FLAGS},
+    {"prefetch_segments", "Number of segments to download ahead in background threads",
+        OFFSET(prefetch_segments), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 64, FLAGS},
+    {"prefetch_max_size", "Maximum size of a prefetched segment",
+        OFFSET(prefetch_max_size), AV_OPT_TYPE_INT, {.i64 = 16 * 1024 * 1024}, PREFETCH_CHUNK_SIZE, INT_MAX, FLAGS},
     {NULL}
 };
 
@@ -76,6 +76,49 @@ struct AVFormatInternal {
     struct AVPacketList *packet_buffer;
     struct AVPacketList *packet_buffer_end;
 
+    /**
+     * Unused AVPacketList nodes, reused by the interleaver instead of
+     * allocating a node for each packet.
+     * Muxing only.
+     */
+    struct AVPacketList *packet_buffer_pool;
+
+    /**
+     * Streams with packets in their interleaving queue, as a binary heap
+     * ordered by the interleaving position of the first packet of each
+     * queue. Muxing only.
+     */
+    AVStream **interleave_heap;
+    int nb_interleave_heap;
+    unsigned int interleave_heap_size;
+
+    /**
+     * Comparison function of the packets in the interleaving queues, as
+     * passed to ff_interleave_add_packet(). Muxing only.
+     */
+    int (*interleave_compare)(struct AVFormatContext *, const AVPacket *, const AVPacket *);
+
+    /**
+     * Number of packets added to the interleaving queues so far; orders
+     * the packets the comparison function does not.
+     * Muxing only.
+     */
+    int64_t interleave_seq;
+
+    /**
+     * Number of times a queue has been moved ahead of all the others
+     * because it continues a chunk. Muxing only.
+     */
+    int64_t interleave_front;
+
+    /**
+     * Number of streams ff_interleave_packet_per_dts() waits for when
+     * they have no queued packets, and how many of them have queued
+     * packets. Muxing only.
+     */
+    int nb_waited_streams;
+    int nb_queued_waited_streams;
+
     /* av_seek_frame() support */
     int64_t data_offset; /**< offset of the first packet */
 
@@ -191,6 +234,19 @@ struct AVStreamInternal {
     int is_intra_only;
 
     FFFrac *priv_pts;
+
+    /**
+     * Queue of the packets of this stream waiting to be interleaved, the
+     * last packet is AVStream.last_in_packet_buffer. Muxing only.
+     */
+    struct AVPacketList *interleave_queue;
+
+    /**
+     * If nonzero, the first queued packet continues a chunk and is output
+     * before the packets of the queues with a lower value.
+     * Muxing only.
+     */
+    int64_t interleave_front;
 };
 
 #ifdef __GNUC__
@@ -231,13 +287,22 @@ char *ff_data_to_hex(char *buf, const uint8_t *src, int size, int lowercase);
 int ff_hex_to_data(uint8_t *data, const char *p);
 
 /**
- * Add packet to an AVFormatContext's packet_buffer list, determining its
- * interleaved position using compare() function argument.
+ * Add packet to the interleaving queue of its stream. The packets are
+ * output in the order given by the compare() function argument, which is
+ * applied to the first queued packet of each stream.
+ * The list node is taken from packet_buffer_pool if possible.
  * @return 0 on success, < 0 on error. pkt will always be blank on return.
  */
 int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
                              int (*compare)(AVFormatContext *, const AVPacket *, const AVPacket *));
 
+/**
+ * Remove the next packet in interleaving order from the queues filled by
+ * ff_interleave_add_packet().
+ * @return 1 if a packet was returned in out, 0 if the queues are empty
+ */
+int ff_interleave_get_packet(AVFormatContext *s, AVPacket *out);
+
 void ff_read_frame_flush(AVFormatContext *s);
 
 #define NTP_OFFSET 2208988800ULL
@@ -388,6 +453,23 @@ int ff_add_index_entry(AVIndexEntry **index_entries,
 
 void ff_configure_buffers_for_index(AVFormatContext *s, int64_t time_tolerance);
 
+/**
+ * Return 1 if s is read through a local protocol, whose buffers are not
+ * configured by ff_configure_buffers_for_index().
+ */
+int ff_is_local_protocol(AVFormatContext *s);
+
+/**
+ * Configure the buffer size and short seek threshold of s->pb like
+ * ff_configure_buffers_for_index(), for demuxers which do not keep their
+ * index in st->index_entries. The caller checks ff_is_local_protocol().
+ *
+ * @param pos_delta largest backward position distance between index entries
+ *                  of different streams which are close in time
+ * @param skip      largest index entry size
+ */
+void ff_configure_buffers(AVFormatContext *s, int64_t pos_delta, int64_t skip);
+
 /**
  * Add a new chapter.
  *
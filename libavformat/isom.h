@@ -155,6 +155,29 @@ typedef struct MOVIndexRange {
     int64_t end;
 } MOVIndexRange;
 
+/**
+ * Sample index resolved from the stts/stsc/stsz/stco tables on demand,
+ * used instead of AVStream.index_entries with the compact_index option.
+ */
+typedef struct MOVCompactIndex {
+    unsigned int nb_samples;
+    int key_off;              ///< 1 if stss/stps sample numbers start at 1
+    int64_t *stts_dts;        ///< dts of the first sample of each stts entry
+    unsigned int *stts_first; ///< first sample of each stts entry
+    unsigned int *stsc_first; ///< first sample of each stsc entry
+
+    /* cursor, describing the sample in entry */
+    unsigned int sample;      ///< UINT_MAX if the cursor is not set
+    unsigned int chunk;
+    unsigned int chunk_sample;
+    unsigned int stsc_index;
+    unsigned int stts_index;
+    int64_t pos;
+    unsigned int size;
+    int64_t dts;
+    AVIndexEntry entry;
+} MOVCompactIndex;
+
 typedef struct MOVStreamContext {
     AVIOContext *pb;
     int pb_is_copied;
@@ -193,6 +216,7 @@ typedef struct MOVStreamContext {
     int64_t current_index;
     MOVIndexRange* index_ranges;
     MOVIndexRange* current_index_range;
+    MOVCompactIndex *compact_index; ///< set if the sample tables replace index_entries
     unsigned int bytes_per_frame;
     unsigned int samples_per_frame;
     int dv_audio_container;
@@ -290,6 +314,7 @@ typedef struct MOVContext {
     uint8_t *decryption_key;
     int decryption_key_len;
     int enable_drefs;
+    int compact_index;
     int32_t movie_display_matrix[3][3]; ///< display matrix from mvhd
 } MOVContext;
 
@@ -3343,6 +3343,205 @@ static int64_t add_ctts_entry(MOVStts** ctts_data, unsigned int* ctts_count, uns
     return *ctts_count;
 }
 
+static int64_t mov_sync_sample_search(const unsigned *list, unsigned int count,
+                                      int key_off, int64_t sample, int backward)
+{
+    int64_t key = sample + key_off;
+    unsigned int lo = 0, hi = count;
+
+    /* find the first entry after (backward) or at (forward) the sample */
+    while (lo < hi) {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (list[mid] < key || (backward && list[mid] == key))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (backward)
+        return lo ? (int64_t)list[lo - 1] - key_off : -1;
+    return lo < count ? (int64_t)list[lo] - key_off : INT64_MAX;
+}
+
+/**
+ * Find the closest keyframe at or before (backward) or at or after the
+ * given sample, using the same rules as mov_build_index().
+ * Return -1 or INT64_MAX if there is none.
+ */
+static int64_t mov_compact_find_keyframe(AVStream *st, MOVStreamContext *sc,
+                                         int64_t sample, int backward)
+{
+    const MOVCompactIndex *ci = sc->compact_index;
+    int64_t best = backward ? -1 : INT64_MAX;
+
+    if (sc->keyframe_absent && !sc->stps_count) {
+        if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+            return sample;
+        return backward || !sample ? 0 : INT64_MAX;
+    }
+    if (!sc->keyframe_absent) {
+        if (!sc->keyframe_count)
+            return sample;
+        best = mov_sync_sample_search((const unsigned *)sc->keyframes,
+                                      sc->keyframe_count, ci->key_off,
+                                      sample, backward);
+    }
+    if (sc->stps_count) {
+        int64_t partial = mov_sync_sample_search(sc->stps_data, sc->stps_count,
+                                                 ci->key_off, sample, backward);
+        best = backward ? FFMAX(best, partial) : FFMIN(best, partial);
+    }
+    return best;
+}
+
+static AVIndexEntry *mov_compact_index_entry(AVStream *st, MOVStreamContext *sc,
+                                             unsigned int sample)
+{
+    MOVCompactIndex *ci = sc->compact_index;
+
+    if (sample >= ci->nb_samples)
+        return NULL;
+    if (sample == ci->sample)
+        return &ci->entry;
+
+    if (ci->sample != UINT_MAX && sample == ci->sample + 1) {
+        ci->pos += ci->size;
+        ci->dts += sc->stts_data[ci->stts_index].duration;
+        if (ci->stts_index + 1 < sc->stts_count &&
+            sample == ci->stts_first[ci->stts_index + 1])
+            ci->stts_index++;
+        if (++ci->chunk_sample == sc->stsc_data[ci->stsc_index].count) {
+            ci->chunk++;
+            ci->chunk_sample = 0;
+            if (mov_stsc_index_valid(ci->stsc_index, sc->stsc_count) &&
+                ci->chunk + 1 == sc->stsc_data[ci->stsc_index + 1].first)
+                ci->stsc_index++;
+            ci->pos = sc->chunk_offsets[ci->chunk];
+        }
+    } else {
+        unsigned int lo, hi, i, chunk_samples;
+
+        lo = 0;
+        hi = sc->stsc_count;
+        while (hi - lo > 1) {
+            unsigned int mid = lo + (hi - lo) / 2;
+            if (ci->stsc_first[mid] <= sample)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        ci->stsc_index   = lo;
+        chunk_samples    = sc->stsc_data[lo].count;
+        ci->chunk        = sc->stsc_data[lo].first - 1 +
+                           (sample - ci->stsc_first[lo]) / chunk_samples;
+        ci->chunk_sample = (sample - ci->stsc_first[lo]) % chunk_samples;
+
+        lo = 0;
+        hi = sc->stts_count;
+        while (hi - lo > 1) {
+            unsigned int mid = lo + (hi - lo) / 2;
+            if (ci->stts_first[mid] <= sample)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        ci->stts_index = lo;
+        ci->dts        = ci->stts_dts[lo] +
+                         (int64_t)(sample - ci->stts_first[lo]) * sc->stts_data[lo].duration;
+
+        ci->pos = sc->chunk_offsets[ci->chunk];
+        for (i = sample - ci->chunk_sample; i < sample; i++)
+            ci->pos += sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[i];
+    }
+
+    ci->sample = sample;
+    ci->size   = sc->stsz_sample_size > 0 ? sc->stsz_sample_size : sc->sample_sizes[sample];
+
+    ci->entry.pos          = ci->pos;
+    ci->entry.timestamp    = ci->dts;
+    ci->entry.size         = ci->size;
+    ci->entry.min_distance = 0;
+    ci->entry.flags        = mov_compact_find_keyframe(st, sc, sample, 1) == sample ?
+                             AVINDEX_KEYFRAME : 0;
+
+    return &ci->entry;
+}
+
+static void mov_free_compact_index(MOVStreamContext *sc)
+{
+    if (!sc->compact_index)
+        return;
+    av_freep(&sc->compact_index->stts_dts);
+    av_freep(&sc->compact_index->stts_first);
+    av_freep(&sc->compact_index->stsc_first);
+    av_freep(&sc->compact_index);
+}
+
+static unsigned int mov_index_size(AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+
+    return sc->compact_index ? sc->compact_index->nb_samples : st->nb_index_entries;
+}
+
+/**
+ * Return the index entry of the given sample, or NULL if there is none.
+ * With a compact index, the returned entry is only valid until the next
+ * call for the same stream.
+ */
+static AVIndexEntry *mov_index_entry(AVStream *st, unsigned int sample)
+{
+    MOVStreamContext *sc = st->priv_data;
+
+    if (sc->compact_index)
+        return mov_compact_index_entry(st, sc, sample);
+    return sample < st->nb_index_entries ? &st->index_entries[sample] : NULL;
+}
+
+static int mov_index_search_timestamp(AVStream *st, int64_t timestamp, int flags)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVCompactIndex *ci = sc->compact_index;
+    unsigned int lo = 0, hi;
+    int64_t a, b, m, end, dts;
+
+    if (!ci)
+        return av_index_search_timestamp(st, timestamp, flags);
+
+    if (!ci->nb_samples)
+        return -1;
+
+    /* a: last sample with dts <= timestamp, b: first one with dts >= timestamp */
+    if (timestamp < ci->stts_dts[0]) {
+        a = -1;
+        b = 0;
+    } else {
+        hi = sc->stts_count;
+        while (hi - lo > 1) {
+            unsigned int mid = lo + (hi - lo) / 2;
+            if (ci->stts_dts[mid] <= timestamp && ci->stts_first[mid] < ci->nb_samples)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        end = lo + 1 < sc->stts_count ? ci->stts_first[lo + 1] : ci->nb_samples;
+        end = FFMIN(end, ci->nb_samples) - 1;
+        if (sc->stts_data[lo].duration > 0)
+            a = ci->stts_first[lo] + (timestamp - ci->stts_dts[lo]) / sc->stts_data[lo].duration;
+        else
+            a = end;
+        a   = FFMIN(a, end);
+        dts = ci->stts_dts[lo] + (a - ci->stts_first[lo]) * sc->stts_data[lo].duration;
+        b   = dts == timestamp ? a : a + 1;
+    }
+
+    m = (flags & AVSEEK_FLAG_BACKWARD) ? a : b;
+    if (!(flags & AVSEEK_FLAG_ANY) && m >= 0 && m < ci->nb_samples)
+        m = mov_compact_find_keyframe(st, sc, m, flags & AVSEEK_FLAG_BACKWARD);
+    if (m < 0 || m >= ci->nb_samples)
+        return -1;
+    return m;
+}
+
 #define MAX_REORDER_DELAY 16
 static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
 {
@@ -3360,14 +3559,14 @@ static void mov_estimate_video_delay(MOVContext *c, AVStream* st)
     if (st->codecpar->video_delay <= 0 && msc->ctts_data &&
         st->codecpar->codec_id == AV_CODEC_ID_H264) {
         st->codecpar->video_delay = 0;
-        for (ind = 0; ind < st->nb_index_entries && ctts_ind < msc->ctts_count; ++ind) {
+        for (ind = 0; ind < mov_index_size(st) && ctts_ind < msc->ctts_count; ++ind) {
             // Point j to the last elem of the buffer and insert the current pts there.
             j = buf_start;
             buf_start = (buf_start + 1);
             if (buf_start == MAX_REORDER_DELAY + 1)
                 buf_start = 0;
 
-            pts_buf[j] = st->index_entries[ind].timestamp + msc->ctts_data[ctts_ind].duration;
+            pts_buf[j] = mov_index_entry(st, ind)->timestamp + msc->ctts_data[ctts_ind].duration;
 
             // The timestamps that are already in the sorted buffer, and are greater than the
             // current pts, are exactly the timestamps that need to be buffered to output PTS
@@ -3756,6 +3955,196 @@ static void mov_fix_index(MOVContext *mov, AVStream *st)
     msc->current_index = msc->index_ranges[0].start;
 }
 
+/**
+ * Return 0 if mov_build_index() would replace the STSZ sample size while
+ * building the index, which only affects the chunks after the first
+ * invalid one.
+ */
+static int mov_stsz_sample_size_valid(MOVStreamContext *sc)
+{
+    unsigned int stsc_index = 0;
+    unsigned int i;
+
+    if (sc->stsz_sample_size <= 0)
+        return 1;
+    if (sc->chunk_count && sc->stsz_sample_size < sc->sample_size)
+        return 0;
+
+    for (i = 0; i < sc->chunk_count; i++) {
+        int64_t next_offset = i+1 < sc->chunk_count ? sc->chunk_offsets[i+1] : INT64_MAX;
+        int64_t current_offset = sc->chunk_offsets[i];
+        while (mov_stsc_index_valid(stsc_index, sc->stsc_count) &&
+            i + 1 == sc->stsc_data[stsc_index + 1].first)
+            stsc_index++;
+
+        if (next_offset > current_offset && sc->sample_size>0 && sc->sample_size < sc->stsz_sample_size &&
+            sc->stsc_data[stsc_index].count * (int64_t)sc->stsz_sample_size > next_offset - current_offset)
+            return 0;
+    }
+    return 1;
+}
+
+/* Expand ctts entries such that we have a 1-1 mapping with samples */
+static int mov_expand_ctts(MOVStreamContext *sc)
+{
+    MOVStts *ctts_data_old = sc->ctts_data;
+    unsigned int ctts_count_old = sc->ctts_count;
+    unsigned int i, j;
+
+    if (sc->sample_count >= UINT_MAX / sizeof(*sc->ctts_data))
+        return AVERROR_INVALIDDATA;
+    sc->ctts_count = 0;
+    sc->ctts_allocated_size = 0;
+    sc->ctts_data = av_fast_realloc(NULL, &sc->ctts_allocated_size,
+                            sc->sample_count * sizeof(*sc->ctts_data));
+    if (!sc->ctts_data) {
+        av_free(ctts_data_old);
+        return AVERROR(ENOMEM);
+    }
+
+    memset((uint8_t*)(sc->ctts_data), 0, sc->ctts_allocated_size);
+
+    for (i = 0; i < ctts_count_old &&
+                sc->ctts_count < sc->sample_count; i++)
+        for (j = 0; j < ctts_data_old[i].count &&
+                    sc->ctts_count < sc->sample_count; j++)
+            add_ctts_entry(&sc->ctts_data, &sc->ctts_count,
+                           &sc->ctts_allocated_size, 1,
+                           ctts_data_old[i].duration);
+    av_free(ctts_data_old);
+    return 0;
+}
+
+/**
+ * Set up a compact index for the stream, keeping the sample tables instead
+ * of creating one index entry per sample. Layouts which need per sample
+ * fixups are left to the full index.
+ */
+static int mov_build_compact_index(MOVContext *mov, AVStream *st, int64_t current_dts)
+{
+    MOVStreamContext *sc = st->priv_data;
+    MOVCompactIndex *ci;
+    uint64_t nb_samples = 0, sample = 0, stream_size = 0;
+    unsigned int i, j;
+
+    if ((st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO &&
+         st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) ||
+        (sc->elst_count && mov->advanced_editlist) ||
+        (sc->rap_group_count && sc->rap_group) ||
+        !sc->sample_count || !sc->chunk_count || st->nb_index_entries ||
+        (!sc->stsz_sample_size && !sc->sample_sizes) ||
+        sc->stsz_sample_size > 0x3FFFFFFF ||
+        !mov_stsz_sample_size_valid(sc) ||
+        sc->stsc_data[0].first != 1)
+        return AVERROR(ENOSYS);
+    for (i = 0; i < sc->stsc_count; i++)
+        if (!sc->stsc_data[i].count ||
+            (i + 1 < sc->stsc_count && sc->stsc_data[i + 1].first <= sc->stsc_data[i].first) ||
+            (sc->pseudo_stream_id != -1 && sc->stsc_data[i].id - 1 != sc->pseudo_stream_id))
+            return AVERROR(ENOSYS);
+    for (i = 0; i < sc->stts_count; i++)
+        if (sc->stts_data[i].duration < 0 ||
+            (!sc->stts_data[i].count && i + 1 < sc->stts_count))
+            return AVERROR(ENOSYS);
+
+    ci = av_mallocz(sizeof(*ci));
+    if (!ci)
+        return AVERROR(ENOMEM);
+    sc->compact_index = ci;
+    ci->stts_dts   = av_malloc_array(sc->stts_count, sizeof(*ci->stts_dts));
+    ci->stts_first = av_malloc_array(sc->stts_count, sizeof(*ci->stts_first));
+    ci->stsc_first = av_malloc_array(sc->stsc_count, sizeof(*ci->stsc_first));
+    if (!ci->stts_dts || !ci->stts_first || !ci->stsc_first) {
+        mov_free_compact_index(sc);
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < sc->stsc_count; i++) {
+        ci->stsc_first[i] = FFMIN(nb_samples, UINT_MAX);
+        nb_samples += mov_get_stsc_samples(sc, i);
+    }
+    nb_samples = FFMIN(nb_samples, sc->sample_count);
+
+    for (i = 0; i < sc->stts_count; i++) {
+        ci->stts_first[i] = FFMIN(sample, UINT_MAX);
+        ci->stts_dts[i]   = current_dts;
+        sample      += sc->stts_data[i].count;
+        current_dts += sc->stts_data[i].count * (int64_t)sc->stts_data[i].duration;
+    }
+
+    if (sc->stsz_sample_size > 0) {
+        stream_size = nb_samples * sc->stsz_sample_size;
+    } else {
+        for (i = 0; i < nb_samples; i++) {
+            if (sc->sample_sizes[i] > 0x3FFFFFFF) {
+                av_log(mov->fc, AV_LOG_ERROR, "Sample size %u is too large\n", sc->sample_sizes[i]);
+                nb_samples = i;
+                break;
+            }
+            stream_size += sc->sample_sizes[i];
+        }
+    }
+
+    /* zero length runs would stall the ctts cursor of mov_read_packet() */
+    for (i = j = 0; i < sc->ctts_count; i++)
+        if (sc->ctts_data[i].count)
+            sc->ctts_data[j++] = sc->ctts_data[i];
+    sc->ctts_count = j;
+
+    ci->nb_samples = nb_samples;
+    ci->key_off    = (sc->keyframe_count && sc->keyframes[0] > 0) || (sc->stps_count && sc->stps_data[0] > 0);
+    ci->sample     = UINT_MAX;
+
+    av_log(mov->fc, AV_LOG_DEBUG, "stream %d: compact index with %u samples\n",
+           st->index, ci->nb_samples);
+
+    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        for (i = 0; i < FFMIN(nb_samples, 99); i++)
+            ff_rfps_add_frame(mov->fc, st, mov_compact_index_entry(st, sc, i)->timestamp);
+
+    if (st->duration > 0)
+        st->codecpar->bit_rate = stream_size*8*sc->time_scale/st->duration;
+
+    return 0;
+}
+
+/**
+ * Replace the compact index of the stream by regular index entries, for
+ * code which edits or walks st->index_entries directly.
+ */
+static int mov_compact_index_expand(MOVContext *mov, AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    unsigned int i, nb_samples;
+    int ret;
+
+    if (!sc->compact_index)
+        return 0;
+
+    nb_samples = sc->compact_index->nb_samples;
+    if (nb_samples >= UINT_MAX / sizeof(*st->index_entries))
+        return AVERROR_INVALIDDATA;
+    st->index_entries = av_malloc_array(nb_samples, sizeof(*st->index_entries));
+    if (!st->index_entries)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_samples; i++)
+        st->index_entries[i] = *mov_compact_index_entry(st, sc, i);
+    st->nb_index_entries = nb_samples;
+    st->index_entries_allocated_size = nb_samples * sizeof(*st->index_entries);
+
+    mov_free_compact_index(sc);
+    av_freep(&sc->chunk_offsets);
+    av_freep(&sc->sample_sizes);
+    av_freep(&sc->keyframes);
+    av_freep(&sc->stts_data);
+    av_freep(&sc->stps_data);
+
+    if (sc->ctts_data && (ret = mov_expand_ctts(sc)) < 0)
+        return ret;
+
+    return 0;
+}
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
@@ -3767,8 +4156,6 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
     unsigned int stps_index = 0;
     unsigned int i, j;
     uint64_t stream_size = 0;
-    MOVStts *ctts_data_old = sc->ctts_data;
-    unsigned int ctts_count_old = sc->ctts_count;
 
     if (sc->elst_count) {
         int i, edit_start_index = 0, multiple_edits = 0;
@@ -3828,6 +4215,10 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
 
         if (!sc->sample_count || st->nb_index_entries)
             return;
+
+        if (mov->compact_index && mov_build_compact_index(mov, st, current_dts) >= 0)
+            goto done;
+
         if (sc->sample_count >= UINT_MAX / sizeof(*st->index_entries) - st->nb_index_entries)
             return;
         if (av_reallocp_array(&st->index_entries,
@@ -3838,30 +4229,8 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
         }
         st->index_entries_allocated_size = (st->nb_index_entries + sc->sample_count) * sizeof(*st->index_entries);
 
-        if (ctts_data_old) {
-            // Expand ctts entries such that we have a 1-1 mapping with samples
-            if (sc->sample_count >= UINT_MAX / sizeof(*sc->ctts_data))
-                return;
-            sc->ctts_count = 0;
-            sc->ctts_allocated_size = 0;
-            sc->ctts_data = av_fast_realloc(NULL, &sc->ctts_allocated_size,
-                                    sc->sample_count * sizeof(*sc->ctts_data));
-            if (!sc->ctts_data) {
-                av_free(ctts_data_old);
-                return;
-            }
-
-            memset((uint8_t*)(sc->ctts_data), 0, sc->ctts_allocated_size);
-
-            for (i = 0; i < ctts_count_old &&
-                        sc->ctts_count < sc->sample_count; i++)
-                for (j = 0; j < ctts_data_old[i].count &&
-                            sc->ctts_count < sc->sample_count; j++)
-                    add_ctts_entry(&sc->ctts_data, &sc->ctts_count,
-                                   &sc->ctts_allocated_size, 1,
-                                   ctts_data_old[i].duration);
-            av_free(ctts_data_old);
-        }
+        if (sc->ctts_data && mov_expand_ctts(sc) < 0)
+            return;
 
         for (i = 0; i < sc->chunk_count; i++) {
             int64_t next_offset = i+1 < sc->chunk_count ? sc->chunk_offsets[i+1] : INT64_MAX;
@@ -4073,9 +4442,10 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
         mov_fix_index(mov, st);
     }
 
+done:
     // Update start time of the stream.
-    if (st->start_time == AV_NOPTS_VALUE && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && st->nb_index_entries > 0) {
-        st->start_time = st->index_entries[0].timestamp + sc->dts_shift;
+    if (st->start_time == AV_NOPTS_VALUE && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && mov_index_size(st) > 0) {
+        st->start_time = mov_index_entry(st, 0)->timestamp + sc->dts_shift;
         if (sc->ctts_data) {
             st->start_time += sc->ctts_data[0].duration;
         }
@@ -4312,12 +4682,14 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         && sc->time_scale == st->codecpar->sample_rate) {
             st->need_parsing = AVSTREAM_PARSE_FULL;
     }
-    /* Do not need those anymore. */
-    av_freep(&sc->chunk_offsets);
-    av_freep(&sc->sample_sizes);
-    av_freep(&sc->keyframes);
-    av_freep(&sc->stts_data);
-    av_freep(&sc->stps_data);
+    /* Do not need those anymore, unless the index is resolved from them. */
+    if (!sc->compact_index) {
+        av_freep(&sc->chunk_offsets);
+        av_freep(&sc->sample_sizes);
+        av_freep(&sc->keyframes);
+        av_freep(&sc->stts_data);
+        av_freep(&sc->stps_data);
+    }
     av_freep(&sc->elst_data);
     av_freep(&sc->rap_group);
 
@@ -4740,7 +5112,7 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     int64_t dts, pts = AV_NOPTS_VALUE;
     int data_offset = 0;
     unsigned entries, first_sample_flags = frag->flags;
-    int flags, distance, i;
+    int flags, distance, i, ret;
     int64_t prev_dts = AV_NOPTS_VALUE;
     int next_frag_index = -1, index_entry_pos;
     size_t requested_size;
@@ -4767,6 +5139,9 @@ static int mov_read_trun(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     if (sc->pseudo_stream_id+1 != frag->stsd_id && sc->pseudo_stream_id != -1)
         return 0;
 
+    if ((ret = mov_compact_index_expand(c, st)) < 0)
+        return ret;
+
     // Find the next frag_index index that has a valid index_entry for
     // the current track_id.
     //
@@ -7152,10 +7527,11 @@ static void mov_read_chapters(AVFormatContext *s)
         cur_pos = avio_tell(sc->pb);
 
         if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            AVIndexEntry *sample = mov_index_entry(st, 0);
+
             st->disposition |= AV_DISPOSITION_ATTACHED_PIC | AV_DISPOSITION_TIMED_THUMBNAILS;
-            if (st->nb_index_entries) {
+            if (sample) {
                 // Retrieve the first frame, if possible
-                AVIndexEntry *sample = &st->index_entries[0];
                 if (avio_seek(sc->pb, sample->pos, SEEK_SET) != sample->pos) {
                     av_log(s, AV_LOG_ERROR, "Failed to retrieve first frame\n");
                     goto finish;
@@ -7171,6 +7547,8 @@ static void mov_read_chapters(AVFormatContext *s)
             st->codecpar->codec_type = AVMEDIA_TYPE_DATA;
             st->codecpar->codec_id = AV_CODEC_ID_BIN_DATA;
             st->discard = AVDISCARD_ALL;
+            if (mov_compact_index_expand(s->priv_data, st) < 0)
+                goto finish;
             for (i = 0; i < st->nb_index_entries; i++) {
                 AVIndexEntry *sample = &st->index_entries[i];
                 int64_t end = i+1 < st->nb_index_entries ? st->index_entries[i+1].timestamp : st->duration;
@@ -7340,6 +7718,7 @@ static int mov_read_close(AVFormatContext *s)
         av_freep(&sc->rap_group);
         av_freep(&sc->display_matrix);
         av_freep(&sc->index_ranges);
+        mov_free_compact_index(sc);
 
         if (sc->extradata)
             for (j = 0; j < sc->stsd_count; j++)
@@ -7520,6 +7899,53 @@ fail:
     return ret;
 }
 
+/**
+ * ff_configure_buffers_for_index() for streams with a compact index, whose
+ * entries are not in st->index_entries.
+ */
+static void mov_configure_buffers(AVFormatContext *s)
+{
+    MOVContext *mov = s->priv_data;
+    int64_t pos_delta = 0;
+    int64_t skip = 0;
+    int ist1, ist2;
+
+    if (!mov->compact_index) {
+        ff_configure_buffers_for_index(s, AV_TIME_BASE);
+        return;
+    }
+    if (ff_is_local_protocol(s))
+        return;
+
+    for (ist1 = 0; ist1 < s->nb_streams; ist1++) {
+        AVStream *st1 = s->streams[ist1];
+        for (ist2 = 0; ist2 < s->nb_streams; ist2++) {
+            AVStream *st2 = s->streams[ist2];
+            unsigned int i1, i2;
+
+            if (ist1 == ist2)
+                continue;
+
+            for (i1 = i2 = 0; i1 < mov_index_size(st1); i1++) {
+                AVIndexEntry *e1 = mov_index_entry(st1, i1);
+                int64_t e1_pts = av_rescale_q(e1->timestamp, st1->time_base, AV_TIME_BASE_Q);
+
+                skip = FFMAX(skip, e1->size);
+                for (; i2 < mov_index_size(st2); i2++) {
+                    AVIndexEntry *e2 = mov_index_entry(st2, i2);
+                    int64_t e2_pts = av_rescale_q(e2->timestamp, st2->time_base, AV_TIME_BASE_Q);
+                    if (e2_pts < e1_pts || e2_pts - (uint64_t)e1_pts < AV_TIME_BASE)
+                        continue;
+                    pos_delta = FFMAX(pos_delta, e1->pos - e2->pos);
+                    break;
+                }
+            }
+        }
+    }
+
+    ff_configure_buffers(s, pos_delta, skip);
+}
+
 static int mov_read_header(AVFormatContext *s)
 {
     MOVContext *mov = s->priv_data;
@@ -7718,7 +8144,7 @@ static int mov_read_header(AVFormatContext *s)
             break;
         }
     }
-    ff_configure_buffers_for_index(s, AV_TIME_BASE);
+    mov_configure_buffers(s);
 
     for (i = 0; i < mov->frag_index.nb_items; i++)
         if (mov->frag_index.item[i].moof_offset <= mov->fragment.moof_offset)
@@ -7738,8 +8164,8 @@ static AVIndexEntry *mov_find_next_sample(AVFormatContext *s, AVStream **st)
     for (i = 0; i < s->nb_streams; i++) {
         AVStream *avst = s->streams[i];
         MOVStreamContext *msc = avst->priv_data;
-        if (msc->pb && msc->current_sample < avst->nb_index_entries) {
-            AVIndexEntry *current_sample = &avst->index_entries[msc->current_sample];
+        AVIndexEntry *current_sample = msc->pb ? mov_index_entry(avst, msc->current_sample) : NULL;
+        if (current_sample) {
             int64_t dts = av_rescale(current_sample->timestamp, AV_TIME_BASE, msc->time_scale);
             av_log(s, AV_LOG_TRACE, "stream %d, sample %d, dts %"PRId64"\n", i, msc->current_sample, dts);
             if (!sample || (!(s->pb->seekable & AVIO_SEEKABLE_NORMAL) && current_sample->pos < sample->pos) ||
@@ -7847,7 +8273,7 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
 {
     MOVContext *mov = s->priv_data;
     MOVStreamContext *sc;
-    AVIndexEntry *sample;
+    AVIndexEntry *sample, compact_sample;
     AVStream *st = NULL;
     int64_t current_index;
     int ret;
@@ -7862,6 +8288,11 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         goto retry;
     }
     sc = st->priv_data;
+    if (sc->compact_index) {
+        /* the entry is reused when looking up the next sample */
+        compact_sample = *sample;
+        sample = &compact_sample;
+    }
     /* must be done just before reading, to avoid infinite loop on sample */
     current_index = sc->current_index;
     mov_current_sample_inc(sc);
@@ -7942,8 +8373,8 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
             sc->ctts_sample = 0;
         }
     } else {
-        int64_t next_dts = (sc->current_sample < st->nb_index_entries) ?
-            st->index_entries[sc->current_sample].timestamp : st->duration;
+        AVIndexEntry *next = mov_index_entry(st, sc->current_sample);
+        int64_t next_dts = next ? next->timestamp : st->duration;
 
         if (next_dts >= pkt->dts)
             pkt->duration = next_dts - pkt->dts;
@@ -8022,9 +8453,9 @@ static int mov_seek_stream(AVFormatContext *s, AVStream *st, int64_t timestamp,
     if (ret < 0)
         return ret;
 
-    sample = av_index_search_timestamp(st, timestamp, flags);
+    sample = mov_index_search_timestamp(st, timestamp, flags);
     av_log(s, AV_LOG_TRACE, "stream %d, timestamp %"PRId64", sample %d\n", st->index, timestamp, sample);
-    if (sample < 0 && st->nb_index_entries && timestamp < st->index_entries[0].timestamp)
+    if (sample < 0 && mov_index_size(st) && timestamp < mov_index_entry(st, 0)->timestamp)
         sample = 0;
     if (sample < 0) /* not sure what to do */
         return AVERROR_INVALIDDATA;
@@ -8079,7 +8510,7 @@ static int mov_read_seek(AVFormatContext *s, int stream_index, int64_t sample_ti
 
     if (mc->seek_individually) {
         /* adjust seek timestamp to found sample timestamp */
-        int64_t seek_timestamp = st->index_entries[sample].timestamp;
+        int64_t seek_timestamp = mov_index_entry(st, sample)->timestamp;
 
         for (i = 0; i < s->nb_streams; i++) {
             int64_t timestamp;
@@ -8157,6 +8588,8 @@ static const AVOption mov_options[] = {
     { "decryption_key", "The media decryption key (hex)", OFFSET(decryption_key), AV_OPT_TYPE_BINARY, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "enable_drefs", "Enable external track support.", OFFSET(enable_drefs), AV_OPT_TYPE_BOOL,
         {.i64 = 0}, 0, 1, FLAGS },
+    { "compact_index", "Resolve samples from the sample tables instead of building a full index",
+        OFFSET(compact_index), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, FLAGS },
 
     { NULL },
 };
@@ -107,6 +107,9 @@ static const AVOption options[] = {
     { "wallclock", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = MOV_PRFT_SRC_WALLCLOCK}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "prft"},
     { "pts", NULL, 0, AV_OPT_TYPE_CONST, {.i64 = MOV_PRFT_SRC_PTS}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "prft"},
     { "empty_hdlr_name", "write zero-length name string in hdlr atoms within mdia and minf atoms", offsetof(MOVMuxContext, empty_hdlr_name), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
+    { "faststart_mode", "Set how faststart places the moov atom at the beginning of the file", offsetof(MOVMuxContext, faststart_mode), AV_OPT_TYPE_INT, {.i64 = MOV_FASTSTART_SHIFT}, 0, MOV_FASTSTART_RESERVE, AV_OPT_FLAG_ENCODING_PARAM, "faststart_mode"},
+    { "shift", "Shift the media data in a second pass", 0, AV_OPT_TYPE_CONST, {.i64 = MOV_FASTSTART_SHIFT}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "faststart_mode"},
+    { "reserve", "Reserve estimated space for the moov atom, shifting only if it does not fit", 0, AV_OPT_TYPE_CONST, {.i64 = MOV_FASTSTART_RESERVE}, 0, 0, AV_OPT_FLAG_ENCODING_PARAM, "faststart_mode"},
     { NULL },
 };
 
@@ -6277,6 +6280,52 @@ static int mov_create_dvd_sub_decoder_specific_info(MOVTrack *track,
     return 0;
 }
 
+/*
+ * Estimate an upper bound of the final moov size from the stream durations,
+ * assuming one sample per chunk and no run-length compression in any of the
+ * sample tables. Returns 0 if the estimate is not possible.
+ */
+static int estimate_moov_size(AVFormatContext *s)
+{
+    int64_t size = 4096;
+    int i;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        AVCodecParameters *par = st->codecpar;
+        double rate;
+        int entry_size;
+
+        if (st->duration <= 0 || st->time_base.num <= 0)
+            return 0;
+
+        switch (par->codec_type) {
+        case AVMEDIA_TYPE_VIDEO:
+            rate = st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0 ?
+                   av_q2d(st->avg_frame_rate) : 60;
+            /* stsz, stts, ctts, stss, stsc and co64 entries */
+            entry_size = 4 + 8 + 8 + 4 + 12 + 8;
+            break;
+        case AVMEDIA_TYPE_AUDIO:
+            if (par->sample_rate <= 0)
+                return 0;
+            rate = par->sample_rate / (double)(par->frame_size > 0 ? par->frame_size : 1024);
+            entry_size = 4 + 8 + 12 + 8;
+            break;
+        default:
+            rate = 10;
+            entry_size = 4 + 8 + 12 + 8;
+            break;
+        }
+        size += 1024 + par->extradata_size +
+                (int64_t)(st->duration * av_q2d(st->time_base) * rate * 1.05 + 16) * entry_size;
+        if (size > INT_MAX)
+            return 0;
+    }
+
+    return size;
+}
+
 static int mov_init(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -6332,7 +6381,21 @@ static int mov_init(AVFormatContext *s)
     }
 
     if (mov->flags & FF_MOV_FLAG_FASTSTART) {
-        mov->reserved_moov_size = -1;
+        if (mov->faststart_mode == MOV_FASTSTART_RESERVE &&
+            !(mov->flags & FF_MOV_FLAG_FRAGMENT)) {
+            if (mov->reserved_moov_size <= 0)
+                mov->reserved_moov_size = estimate_moov_size(s);
+            if (mov->reserved_moov_size > 0) {
+                mov->reserved_moov_size = FFMAX(mov->reserved_moov_size, 8);
+                av_log(s, AV_LOG_VERBOSE, "Reserving %d bytes for the moov atom\n",
+                       mov->reserved_moov_size);
+            } else {
+                av_log(s, AV_LOG_WARNING, "Cannot estimate the moov size without "
+                       "known stream durations, falling back to a second pass\n");
+            }
+        }
+        if (mov->reserved_moov_size <= 0)
+            mov->reserved_moov_size = -1;
     }
 
     if (mov->use_editlist < 0) {
@@ -6693,7 +6756,7 @@ static int mov_write_header(AVFormatContext *s)
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -6825,6 +6888,45 @@ static int compute_sidx_size(AVFormatContext *s)
     return sidx_size;
 }
 
+/*
+ * Write the moov atom into the space reserved at reserved_header_pos,
+ * followed by a free atom covering the rest. The moov is built in memory
+ * first, so nothing is overwritten if it does not fit.
+ */
+static int write_reserved_moov(AVFormatContext *s)
+{
+    MOVMuxContext *mov = s->priv_data;
+    AVIOContext *pb = s->pb, *moov_buf;
+    uint8_t *buf;
+    int ret, size;
+
+    if ((ret = avio_open_dyn_buf(&moov_buf)) < 0)
+        return ret;
+    if ((ret = mov_write_moov_tag(moov_buf, mov, s)) < 0) {
+        ffio_free_dyn_buf(&moov_buf);
+        return ret;
+    }
+    size = avio_close_dyn_buf(moov_buf, &buf);
+    if (!buf)
+        return AVERROR(ENOMEM);
+
+    if (mov->reserved_moov_size - size < 8) {
+        av_log(s, mov->flags & FF_MOV_FLAG_FASTSTART ? AV_LOG_WARNING : AV_LOG_ERROR,
+               "reserved_moov_size is too small, needed %d additional\n",
+               size + 8 - mov->reserved_moov_size);
+        av_free(buf);
+        return AVERROR(ENOSPC);
+    }
+
+    avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+    avio_write(pb, buf, size);
+    avio_wb32(pb, mov->reserved_moov_size - size);
+    ffio_wfourcc(pb, "free");
+    ffio_fill(pb, 0, mov->reserved_moov_size - size - 8);
+    av_free(buf);
+    return 0;
+}
+
 static int shift_data(AVFormatContext *s)
 {
     int ret = 0, moov_size;
@@ -6956,7 +7058,20 @@ static int mov_write_trailer(AVFormatContext *s)
         }
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (mov->reserved_moov_size > 0 &&
+            (res = write_reserved_moov(s)) != AVERROR(ENOSPC)) {
+            if (res < 0)
+                return res;
+            avio_seek(pb, moov_pos, SEEK_SET);
+        } else if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+            if (mov->reserved_moov_size > 0) {
+                /* the estimate was too small: turn the reserved space into a
+                 * free atom and move it along with the mdat */
+                avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+                avio_wb32(pb, mov->reserved_moov_size);
+                ffio_wfourcc(pb, "free");
+                avio_seek(pb, moov_pos, SEEK_SET);
+            }
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res < 0)
@@ -6965,18 +7080,7 @@ static int mov_write_trailer(AVFormatContext *s)
             if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
                 return res;
         } else if (mov->reserved_moov_size > 0) {
-            int64_t size;
-            if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
-                return res;
-            size = mov->reserved_moov_size - (avio_tell(pb) - mov->reserved_header_pos);
-            if (size < 8){
-                av_log(s, AV_LOG_ERROR, "reserved_moov_size is too small, needed %"PRId64" additional\n", 8-size);
-                return AVERROR(EINVAL);
-            }
-            avio_wb32(pb, size);
-            ffio_wfourcc(pb, "free");
-            ffio_fill(pb, 0, size - 8);
-            avio_seek(pb, moov_pos, SEEK_SET);
+            return AVERROR(EINVAL);
         } else {
             if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
                 return res;
@@ -178,6 +178,11 @@ typedef enum {
     MOV_PRFT_NB
 } MOVPrftBox;
 
+typedef enum {
+    MOV_FASTSTART_SHIFT = 0,
+    MOV_FASTSTART_RESERVE,
+} MOVFaststartMode;
+
 typedef struct MOVMuxContext {
     const AVClass *av_class;
     int     mode;
@@ -209,6 +214,7 @@ typedef struct MOVMuxContext {
 
     int reserved_moov_size; ///< 0 for disabled, -1 for automatic, size otherwise
     int64_t reserved_header_pos;
+    MOVFaststartMode faststart_mode;
 
     char *major_brand;
 
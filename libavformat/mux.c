@@ -227,6 +227,14 @@ static int validate_codec_tag(AVFormatContext *s, AVStream *st)
 }
 
 
+/* Streams without packets ff_interleave_packet_per_dts() waits for */
+static int interleave_waits_for(const AVStream *st)
+{
+    return st->codecpar->codec_type != AVMEDIA_TYPE_ATTACHMENT &&
+           st->codecpar->codec_id   != AV_CODEC_ID_VP8 &&
+           st->codecpar->codec_id   != AV_CODEC_ID_VP9;
+}
+
 static int init_muxer(AVFormatContext *s, AVDictionary **options)
 {
     int ret = 0, i;
@@ -371,6 +379,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         if (par->codec_type != AVMEDIA_TYPE_ATTACHMENT)
             s->internal->nb_interleaved_streams++;
+        s->internal->nb_waited_streams += interleave_waits_for(st);
     }
 
     if (!s->priv_data && of->priv_data_size > 0) {
@@ -809,33 +818,156 @@ static int prepare_input_packet(AVFormatContext *s, AVStream *st, AVPacket *pkt)
 
 #define CHUNK_START 0x1000
 
+/* Node of an interleaving queue, pktl must stay the first field */
+typedef struct InterleaveNode {
+    AVPacketList pktl;
+    int64_t seq;        ///< position in the order the packets were added in
+} InterleaveNode;
+
+static AVPacketList *interleave_get_node(AVFormatContext *s)
+{
+    AVPacketList *pktl = s->internal->packet_buffer_pool;
+
+    if (pktl) {
+        s->internal->packet_buffer_pool = pktl->next;
+        return pktl;
+    }
+    return av_malloc(sizeof(InterleaveNode));
+}
+
+static void interleave_release_node(AVFormatContext *s, AVPacketList *pktl)
+{
+    pktl->next = s->internal->packet_buffer_pool;
+    s->internal->packet_buffer_pool = pktl;
+}
+
+/**
+ * Whether the first queued packet of st goes before the one of st2.
+ * Continued chunks go first, the most recently continued one first, like a
+ * chunk that was inserted at the start of a single list. Packets the
+ * comparison function does not order keep the order they were added in.
+ */
+static int interleave_before(AVFormatContext *s, const AVStream *st,
+                             const AVStream *st2)
+{
+    const AVPacketList *pktl  = st ->internal->interleave_queue;
+    const AVPacketList *pktl2 = st2->internal->interleave_queue;
+
+    if (st->internal->interleave_front || st2->internal->interleave_front)
+        return st->internal->interleave_front > st2->internal->interleave_front;
+    if (s->internal->interleave_compare(s, &pktl2->pkt, &pktl->pkt))
+        return 1;
+    if (s->internal->interleave_compare(s, &pktl->pkt, &pktl2->pkt))
+        return 0;
+    return ((const InterleaveNode *)pktl)->seq < ((const InterleaveNode *)pktl2)->seq;
+}
+
+static void interleave_heap_up(AVFormatContext *s, int i)
+{
+    AVStream **heap = s->internal->interleave_heap;
+    AVStream *st    = heap[i];
+
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+        if (!interleave_before(s, st, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i       = parent;
+    }
+    heap[i] = st;
+}
+
+static void interleave_heap_down(AVFormatContext *s, int i)
+{
+    AVStream **heap = s->internal->interleave_heap;
+    AVStream *st    = heap[i];
+    int nb          = s->internal->nb_interleave_heap;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= nb)
+            break;
+        if (child + 1 < nb && interleave_before(s, heap[child + 1], heap[child]))
+            child++;
+        if (!interleave_before(s, heap[child], st))
+            break;
+        heap[i] = heap[child];
+        i       = child;
+    }
+    heap[i] = st;
+}
+
+/* The first packet in interleaving order, the queues must not be empty */
+static AVPacket *interleave_top(AVFormatContext *s)
+{
+    return &s->internal->interleave_heap[0]->internal->interleave_queue->pkt;
+}
+
+/* Remove the first packet in interleaving order, the queues must not be empty */
+static AVPacketList *interleave_pop(AVFormatContext *s)
+{
+    AVFormatInternal *internal = s->internal;
+    AVStream *st               = internal->interleave_heap[0];
+    AVPacketList *pktl         = st->internal->interleave_queue;
+
+    st->internal->interleave_queue = pktl->next;
+    if (pktl->next) {
+        /* the rest of a chunk stays in front */
+        if (!(pktl->next->pkt.flags & CHUNK_START) &&
+            (s->max_chunk_size || s->max_chunk_duration))
+            st->internal->interleave_front = ++internal->interleave_front;
+        else
+            st->internal->interleave_front = 0;
+        interleave_heap_down(s, 0);
+    } else {
+        st->last_in_packet_buffer      = NULL;
+        st->internal->interleave_front = 0;
+        internal->nb_queued_waited_streams -= interleave_waits_for(st);
+        if (--internal->nb_interleave_heap) {
+            internal->interleave_heap[0] =
+                internal->interleave_heap[internal->nb_interleave_heap];
+            interleave_heap_down(s, 0);
+        }
+    }
+
+    return pktl;
+}
+
 int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
                              int (*compare)(AVFormatContext *, const AVPacket *, const AVPacket *))
 {
     int ret;
-    AVPacketList **next_point, *this_pktl;
+    AVFormatInternal *internal = s->internal;
+    AVPacketList *this_pktl;
     AVStream *st = s->streams[pkt->stream_index];
     int chunked  = s->max_chunk_size || s->max_chunk_duration;
 
-    this_pktl    = av_malloc(sizeof(AVPacketList));
+    if (internal->interleave_heap_size < s->nb_streams * sizeof(*internal->interleave_heap)) {
+        AVStream **heap = av_fast_realloc(internal->interleave_heap,
+                                          &internal->interleave_heap_size,
+                                          s->nb_streams * sizeof(*heap));
+        if (!heap) {
+            av_packet_unref(pkt);
+            return AVERROR(ENOMEM);
+        }
+        internal->interleave_heap = heap;
+    }
+
+    this_pktl    = interleave_get_node(s);
     if (!this_pktl) {
         av_packet_unref(pkt);
         return AVERROR(ENOMEM);
     }
     if ((ret = av_packet_make_refcounted(pkt)) < 0) {
-        av_free(this_pktl);
+        interleave_release_node(s, this_pktl);
         av_packet_unref(pkt);
         return ret;
     }
 
     av_packet_move_ref(&this_pktl->pkt, pkt);
     pkt = &this_pktl->pkt;
-
-    if (st->last_in_packet_buffer) {
-        next_point = &(st->last_in_packet_buffer->next);
-    } else {
-        next_point = &s->internal->packet_buffer;
-    }
+    this_pktl->next = NULL;
+    ((InterleaveNode *)this_pktl)->seq = internal->interleave_seq++;
 
     if (chunked) {
         uint64_t max= av_rescale_q_rnd(s->max_chunk_duration, AV_TIME_BASE_Q, st->time_base, AV_ROUND_UP);
@@ -854,33 +986,39 @@ int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
                 st->interleaver_chunk_duration = 0;
         }
     }
-    if (*next_point) {
-        if (chunked && !(pkt->flags & CHUNK_START))
-            goto next_non_null;
-
-        if (compare(s, &s->internal->packet_buffer_end->pkt, pkt)) {
-            while (   *next_point
-                   && ((chunked && !((*next_point)->pkt.flags&CHUNK_START))
-                       || !compare(s, &(*next_point)->pkt, pkt)))
-                next_point = &(*next_point)->next;
-            if (*next_point)
-                goto next_non_null;
-        } else {
-            next_point = &(s->internal->packet_buffer_end->next);
-        }
-    }
-    av_assert1(!*next_point);
 
-    s->internal->packet_buffer_end = this_pktl;
-next_non_null:
+    internal->interleave_compare = compare;
 
-    this_pktl->next = *next_point;
+    /* the packets of a stream stay in the order they were added in, only
+     * the first one of each stream takes part in the ordering */
+    if (st->last_in_packet_buffer) {
+        st->last_in_packet_buffer = st->last_in_packet_buffer->next = this_pktl;
+        return 0;
+    }
 
-    st->last_in_packet_buffer = *next_point = this_pktl;
+    st->last_in_packet_buffer = st->internal->interleave_queue = this_pktl;
+    if (chunked && !(pkt->flags & CHUNK_START))
+        st->internal->interleave_front = ++internal->interleave_front;
+    internal->nb_queued_waited_streams += interleave_waits_for(st);
+    internal->interleave_heap[internal->nb_interleave_heap++] = st;
+    interleave_heap_up(s, internal->nb_interleave_heap - 1);
 
     return 0;
 }
 
+int ff_interleave_get_packet(AVFormatContext *s, AVPacket *out)
+{
+    AVPacketList *pktl;
+
+    if (!s->internal->nb_interleave_heap)
+        return 0;
+
+    pktl = interleave_pop(s);
+    *out = pktl->pkt;
+    interleave_release_node(s, pktl);
+    return 1;
+}
+
 static int interleave_compare_dts(AVFormatContext *s, const AVPacket *next,
                                                       const AVPacket *pkt)
 {
@@ -914,9 +1052,9 @@ static int interleave_compare_dts(AVFormatContext *s, const AVPacket *next,
 int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
                                  AVPacket *pkt, int flush)
 {
+    AVFormatInternal *internal = s->internal;
     AVPacketList *pktl;
-    int stream_count = 0;
-    int noninterleaved_count = 0;
+    int stream_count, noninterleaved_count;
     int i, ret;
     int eof = flush;
 
@@ -925,40 +1063,29 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
             return ret;
     }
 
-    for (i = 0; i < s->nb_streams; i++) {
-        if (s->streams[i]->last_in_packet_buffer) {
-            ++stream_count;
-        } else if (s->streams[i]->codecpar->codec_type != AVMEDIA_TYPE_ATTACHMENT &&
-                   s->streams[i]->codecpar->codec_id != AV_CODEC_ID_VP8 &&
-                   s->streams[i]->codecpar->codec_id != AV_CODEC_ID_VP9) {
-            ++noninterleaved_count;
-        }
-    }
+    stream_count         = internal->nb_interleave_heap;
+    noninterleaved_count = internal->nb_waited_streams -
+                           internal->nb_queued_waited_streams;
 
-    if (s->internal->nb_interleaved_streams == stream_count)
+    if (internal->nb_interleaved_streams == stream_count)
         flush = 1;
 
     if (s->max_interleave_delta > 0 &&
-        s->internal->packet_buffer &&
+        stream_count &&
         !flush &&
-        s->internal->nb_interleaved_streams == stream_count+noninterleaved_count
+        internal->nb_interleaved_streams == stream_count+noninterleaved_count
     ) {
-        AVPacket *top_pkt = &s->internal->packet_buffer->pkt;
+        AVPacket *top_pkt = interleave_top(s);
         int64_t delta_dts = INT64_MIN;
         int64_t top_dts = av_rescale_q(top_pkt->dts,
                                        s->streams[top_pkt->stream_index]->time_base,
                                        AV_TIME_BASE_Q);
 
-        for (i = 0; i < s->nb_streams; i++) {
-            int64_t last_dts;
-            const AVPacketList *last = s->streams[i]->last_in_packet_buffer;
-
-            if (!last)
-                continue;
-
-            last_dts = av_rescale_q(last->pkt.dts,
-                                    s->streams[i]->time_base,
-                                    AV_TIME_BASE_Q);
+        for (i = 0; i < stream_count; i++) {
+            const AVStream *st = internal->interleave_heap[i];
+            int64_t last_dts   = av_rescale_q(st->last_in_packet_buffer->pkt.dts,
+                                              st->time_base,
+                                              AV_TIME_BASE_Q);
             delta_dts = FFMAX(delta_dts, last_dts - top_dts);
         }
 
@@ -971,88 +1098,62 @@ int ff_interleave_packet_per_dts(AVFormatContext *s, AVPacket *out,
         }
     }
 
-    if (s->internal->packet_buffer &&
+    if (stream_count &&
         eof &&
         (s->flags & AVFMT_FLAG_SHORTEST) &&
-        s->internal->shortest_end == AV_NOPTS_VALUE) {
-        AVPacket *top_pkt = &s->internal->packet_buffer->pkt;
+        internal->shortest_end == AV_NOPTS_VALUE) {
+        AVPacket *top_pkt = interleave_top(s);
 
-        s->internal->shortest_end = av_rescale_q(top_pkt->dts,
+        internal->shortest_end = av_rescale_q(top_pkt->dts,
                                        s->streams[top_pkt->stream_index]->time_base,
                                        AV_TIME_BASE_Q);
     }
 
-    if (s->internal->shortest_end != AV_NOPTS_VALUE) {
-        while (s->internal->packet_buffer) {
-            AVPacket *top_pkt = &s->internal->packet_buffer->pkt;
-            AVStream *st;
+    if (internal->shortest_end != AV_NOPTS_VALUE) {
+        while (internal->nb_interleave_heap) {
+            AVPacket *top_pkt = interleave_top(s);
             int64_t top_dts = av_rescale_q(top_pkt->dts,
                                         s->streams[top_pkt->stream_index]->time_base,
                                         AV_TIME_BASE_Q);
 
-            if (s->internal->shortest_end + 1 >= top_dts)
+            if (internal->shortest_end + 1 >= top_dts)
                 break;
 
-            pktl = s->internal->packet_buffer;
-            st   = s->streams[pktl->pkt.stream_index];
-
-            s->internal->packet_buffer = pktl->next;
-            if (!s->internal->packet_buffer)
-                s->internal->packet_buffer_end = NULL;
-
-            if (st->last_in_packet_buffer == pktl)
-                st->last_in_packet_buffer = NULL;
-
+            pktl = interleave_pop(s);
             av_packet_unref(&pktl->pkt);
-            av_freep(&pktl);
+            interleave_release_node(s, pktl);
             flush = 0;
         }
     }
 
-    if (stream_count && flush) {
-        AVStream *st;
-        pktl = s->internal->packet_buffer;
-        *out = pktl->pkt;
-        st   = s->streams[out->stream_index];
-
-        s->internal->packet_buffer = pktl->next;
-        if (!s->internal->packet_buffer)
-            s->internal->packet_buffer_end = NULL;
-
-        if (st->last_in_packet_buffer == pktl)
-            st->last_in_packet_buffer = NULL;
-        av_freep(&pktl);
-
-        return 1;
-    } else {
+    if (stream_count && flush)
+        return ff_interleave_get_packet(s, out);
+    else
         return 0;
-    }
 }
 
 int ff_interleaved_peek(AVFormatContext *s, int stream,
                         AVPacket *pkt, int add_offset)
 {
-    AVPacketList *pktl = s->internal->packet_buffer;
-    while (pktl) {
-        if (pktl->pkt.stream_index == stream) {
-            *pkt = pktl->pkt;
-            if (add_offset) {
-                AVStream *st = s->streams[pkt->stream_index];
-                int64_t offset = st->mux_ts_offset;
-
-                if (s->output_ts_offset)
-                    offset += av_rescale_q(s->output_ts_offset, AV_TIME_BASE_Q, st->time_base);
-
-                if (pkt->dts != AV_NOPTS_VALUE)
-                    pkt->dts += offset;
-                if (pkt->pts != AV_NOPTS_VALUE)
-                    pkt->pts += offset;
-            }
-            return 0;
-        }
-        pktl = pktl->next;
+    AVPacketList *pktl = s->streams[stream]->internal->interleave_queue;
+
+    if (!pktl)
+        return AVERROR(ENOENT);
+
+    *pkt = pktl->pkt;
+    if (add_offset) {
+        AVStream *st = s->streams[pkt->stream_index];
+        int64_t offset = st->mux_ts_offset;
+
+        if (s->output_ts_offset)
+            offset += av_rescale_q(s->output_ts_offset, AV_TIME_BASE_Q, st->time_base);
+
+        if (pkt->dts != AV_NOPTS_VALUE)
+            pkt->dts += offset;
+        if (pkt->pts != AV_NOPTS_VALUE)
+            pkt->pts += offset;
     }
-    return AVERROR(ENOENT);
+    return 0;
 }
 
 /**
@@ -262,6 +262,8 @@ typedef struct MXFContext {
     int store_user_comments;
     int track_instance_count; // used to generate MXFTrack uuids
     int cbr_index;           ///< use a constant bitrate index
+    AVPacketList *edit_unit;     ///< packets of the last, incomplete edit unit when flushing
+    AVPacketList *edit_unit_end;
 } MXFContext;
 
 static const uint8_t uuid_base[]            = { 0xAD,0xAB,0x44,0x24,0x2f,0x25,0x4d,0xc7,0x92,0xff,0x29,0xbd };
@@ -3012,6 +3014,7 @@ static void mxf_deinit(AVFormatContext *s)
 
     av_freep(&mxf->index_entries);
     av_freep(&mxf->body_partition_offset);
+    ff_packet_list_free(&mxf->edit_unit, &mxf->edit_unit_end);
     if (mxf->timecode_track) {
         av_freep(&mxf->timecode_track->priv_data);
         av_freep(&mxf->timecode_track);
@@ -3020,56 +3023,39 @@ static void mxf_deinit(AVFormatContext *s)
 
 static int mxf_interleave_get_packet(AVFormatContext *s, AVPacket *out, AVPacket *pkt, int flush)
 {
-    int i, stream_count = 0;
-
-    for (i = 0; i < s->nb_streams; i++)
-        stream_count += !!s->streams[i]->last_in_packet_buffer;
-
-    if (stream_count && (s->nb_streams == stream_count || flush)) {
-        AVPacketList *pktl = s->internal->packet_buffer;
-        if (s->nb_streams != stream_count) {
-            AVPacketList *last = NULL;
-            // find last packet in edit unit
-            while (pktl) {
-                if (!stream_count || pktl->pkt.stream_index == 0)
-                    break;
-                // update last packet in packet buffer
-                if (s->streams[pktl->pkt.stream_index]->last_in_packet_buffer != pktl)
-                    s->streams[pktl->pkt.stream_index]->last_in_packet_buffer = pktl;
-                last = pktl;
-                pktl = pktl->next;
-                stream_count--;
-            }
-            // purge packet queue
-            while (pktl) {
-                AVPacketList *next = pktl->next;
-                av_packet_unref(&pktl->pkt);
-                av_freep(&pktl);
-                pktl = next;
-            }
-            if (last)
-                last->next = NULL;
-            else {
-                s->internal->packet_buffer = NULL;
-                s->internal->packet_buffer_end= NULL;
-                goto out;
+    MXFContext *mxf = s->priv_data;
+    int stream_count = s->internal->nb_interleave_heap;
+
+    if (mxf->edit_unit)
+        return !ff_packet_list_get(&mxf->edit_unit, &mxf->edit_unit_end, out);
+
+    if (stream_count && s->nb_streams != stream_count && flush) {
+        AVPacket tmp;
+        int ret = 0;
+        // keep the packets of the last edit unit and purge the rest
+        while (ff_interleave_get_packet(s, &tmp)) {
+            if (ret < 0 || !stream_count || tmp.stream_index == 0) {
+                stream_count = 0;
+                av_packet_unref(&tmp);
+                continue;
             }
-            pktl = s->internal->packet_buffer;
+            ret = ff_packet_list_put(&mxf->edit_unit, &mxf->edit_unit_end, &tmp, 0);
+            av_packet_unref(&tmp);
+            stream_count--;
         }
+        if (ret < 0)
+            return ret;
+        if (!mxf->edit_unit)
+            return 0;
+        return !ff_packet_list_get(&mxf->edit_unit, &mxf->edit_unit_end, out);
+    }
 
-        *out = pktl->pkt;
+    if (stream_count && (s->nb_streams == stream_count || flush)) {
+        ff_interleave_get_packet(s, out);
         av_log(s, AV_LOG_TRACE, "out st:%d dts:%"PRId64"\n", (*out).stream_index, (*out).dts);
-        s->internal->packet_buffer = pktl->next;
-        if(s->streams[pktl->pkt.stream_index]->last_in_packet_buffer == pktl)
-            s->streams[pktl->pkt.stream_index]->last_in_packet_buffer= NULL;
-        if(!s->internal->packet_buffer)
-            s->internal->packet_buffer_end= NULL;
-        av_freep(&pktl);
         return 1;
-    } else {
-    out:
-        return 0;
     }
+    return 0;
 }
 
 static int mxf_compare_timestamps(AVFormatContext *s, const AVPacket *next,
@@ -0,0 +1,230 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Write packets of several streams, stream by stream in chunks like a set of
+ * encoders would deliver them, through av_interleaved_write_frame() and print
+ * the order the muxer receives them in.
+ *
+ * With -b, measure the time per packet instead, writing to the null muxer
+ * with 1 to max_streams audio streams.
+ *
+ * Usage: interleave [-b [max_streams [seconds]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavutil/opt.h"
+#include "libavutil/time.h"
+
+typedef struct TestStream {
+    enum AVMediaType type;
+    AVRational time_base;
+    int duration;           /* of a packet, in time_base units */
+    int size;
+} TestStream;
+
+static const TestStream streams_mixed[] = {
+    { AVMEDIA_TYPE_VIDEO,    { 1, 25 },     1,    3000 },
+    { AVMEDIA_TYPE_AUDIO,    { 1, 48000 },  1024, 400 },
+    { AVMEDIA_TYPE_AUDIO,    { 1, 44100 },  1152, 300 },
+    { AVMEDIA_TYPE_SUBTITLE, { 1, 1000 },   700,  20 },
+    { AVMEDIA_TYPE_AUDIO,    { 1, 48000 },  960,  200 },
+    { AVMEDIA_TYPE_VIDEO,    { 1001, 30000 }, 1,  2000 },
+};
+
+static int write_packets(AVFormatContext *s, const TestStream *ts, int nb_streams,
+                         int64_t end, int64_t chunk)
+{
+    AVPacket *pkt = av_packet_alloc();
+    int64_t *next_dts = av_mallocz_array(nb_streams, sizeof(*next_dts));
+    int64_t chunk_end;
+    int i, ret = 0;
+
+    if (!pkt || !next_dts) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    /* chunk and end are in microseconds */
+    for (chunk_end = chunk; chunk_end <= end; chunk_end += chunk) {
+        for (i = 0; i < nb_streams; i++) {
+            AVStream *st = s->streams[i];
+            int64_t stop = av_rescale_q(chunk_end, AV_TIME_BASE_Q, st->time_base);
+
+            while (next_dts[i] < stop) {
+                if ((ret = av_new_packet(pkt, ts[i].size)) < 0)
+                    goto end;
+                memset(pkt->data, i, pkt->size);
+                pkt->stream_index = i;
+                pkt->pts = pkt->dts = next_dts[i];
+                pkt->duration = ts[i].duration;
+                pkt->flags = AV_PKT_FLAG_KEY;
+                next_dts[i] += ts[i].duration;
+
+                if ((ret = av_interleaved_write_frame(s, pkt)) < 0)
+                    goto end;
+            }
+        }
+    }
+
+end:
+    av_packet_free(&pkt);
+    av_free(next_dts);
+    return ret;
+}
+
+static int run(const char *format, const TestStream *ts, int nb_streams,
+               int64_t end, int64_t chunk, const char *opts, int print)
+{
+    AVFormatContext *s = NULL;
+    AVDictionary *dict = NULL;
+    uint8_t *buf = NULL;
+    int i, ret, size;
+
+    if ((ret = avformat_alloc_output_context2(&s, NULL, format, NULL)) < 0)
+        return ret;
+
+    for (i = 0; i < nb_streams; i++) {
+        AVStream *st = avformat_new_stream(s, NULL);
+        if (!st) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        st->codecpar->codec_type = ts[i].type;
+        switch (ts[i].type) {
+        case AVMEDIA_TYPE_VIDEO:
+            st->codecpar->codec_id = AV_CODEC_ID_RAWVIDEO;
+            st->codecpar->width    = 16;
+            st->codecpar->height   = 16;
+            break;
+        case AVMEDIA_TYPE_AUDIO:
+            st->codecpar->codec_id    = AV_CODEC_ID_PCM_S16LE;
+            st->codecpar->sample_rate = ts[i].time_base.den;
+            st->codecpar->channels    = 2;
+            break;
+        default:
+            st->codecpar->codec_id = AV_CODEC_ID_SUBRIP;
+        }
+        st->time_base = ts[i].time_base;
+    }
+    s->flags |= AVFMT_FLAG_BITEXACT;
+
+    if (print && (ret = avio_open_dyn_buf(&s->pb)) < 0)
+        goto end;
+    if ((ret = av_dict_parse_string(&dict, opts, "=", ":", 0)) < 0)
+        goto end;
+    if ((ret = avformat_write_header(s, &dict)) < 0)
+        goto end;
+    if ((ret = write_packets(s, ts, nb_streams, end, chunk)) < 0)
+        goto end;
+    ret = av_write_trailer(s);
+
+end:
+    if (print && s->pb) {
+        size = avio_close_dyn_buf(s->pb, &buf);
+        if (ret >= 0)
+            fwrite(buf, 1, size, stdout);
+        av_free(buf);
+    }
+    av_dict_free(&dict);
+    avformat_free_context(s);
+    return ret;
+}
+
+static int bench(int max_streams, int seconds)
+{
+    TestStream *ts = av_malloc_array(max_streams, sizeof(*ts));
+    static const int frame_sizes[] = { 1024, 960, 1152, 480 };
+    int i, nb_streams;
+
+    if (!ts)
+        return 1;
+    for (i = 0; i < max_streams; i++) {
+        ts[i].type      = AVMEDIA_TYPE_AUDIO;
+        ts[i].time_base = (AVRational){ 1, 48000 };
+        ts[i].duration  = frame_sizes[i % FF_ARRAY_ELEMS(frame_sizes)];
+        ts[i].size      = 64;
+    }
+
+    printf("streams  ns/packet\n");
+    for (nb_streams = 1; nb_streams <= max_streams; nb_streams *= 2) {
+        int64_t nb_packets = 0, t;
+        int ret;
+
+        for (i = 0; i < nb_streams; i++)
+            nb_packets += (seconds * 48000LL + ts[i].duration - 1) / ts[i].duration;
+
+        t   = av_gettime_relative();
+        ret = run("null", ts, nb_streams, seconds * 1000000LL, 100000, "", 0);
+        t   = av_gettime_relative() - t;
+        if (ret < 0) {
+            fprintf(stderr, "Muxing failed: %s\n", av_err2str(ret));
+            av_free(ts);
+            return 1;
+        }
+        printf("%7d %10.1f\n", nb_streams, 1000.0 * t / nb_packets);
+    }
+
+    av_free(ts);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        int64_t chunk;
+        const char *opts;
+    } tests[] = {
+        { "chunks of 200ms",          200000, "" },
+        { "chunks of 1s",            1000000, "" },
+        { "audio preload",            500000, "audio_preload=300000" },
+        { "max chunk size",           300000, "chunk_size=2000" },
+        { "max chunk duration",       300000, "chunk_duration=100000" },
+        { "max interleave delta",    1000000, "max_interleave_delta=200000" },
+    };
+    int i, ret;
+
+    if (argc > 1 && !strcmp(argv[1], "-b")) {
+        int max_streams = argc > 2 ? atoi(argv[2]) : 64;
+        int seconds     = argc > 3 ? atoi(argv[3]) : 600;
+
+        if (max_streams < 1 || seconds < 1) {
+            fprintf(stderr, "Usage: %s [-b [max_streams [seconds]]]\n", argv[0]);
+            return 1;
+        }
+        return bench(max_streams, seconds);
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        printf("#%s\n", tests[i].name);
+        fflush(stdout);
+        ret = run("framecrc", streams_mixed, FF_ARRAY_ELEMS(streams_mixed),
+                  2000000, tests[i].chunk, tests[i].opts, 1);
+        if (ret < 0) {
+            fprintf(stderr, "%s failed: %s\n", tests[i].name, av_err2str(ret));
+            return 1;
+        }
+    }
+
+    return 0;
+}
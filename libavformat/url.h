@@ -27,6 +27,7 @@
 #include "avio.h"
 #include "libavformat/version.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/dict.h"
 #include "libavutil/log.h"
 
@@ -87,6 +88,13 @@ typedef struct URLProtocol {
                                      int *numhandles);
     int (*url_get_short_seek)(URLContext *h);
     int (*url_shutdown)(URLContext *h, int flags);
+    /**
+     * Return a reference to size bytes of the resource starting at pos,
+     * without copying them. Only implemented by protocols that already
+     * hold the data in memory. The read position is not changed.
+     */
+    int (*url_read_buffer)(URLContext *h, AVBufferRef **buf, uint8_t **data,
+                           int64_t pos, int size);
     int priv_data_size;
     const AVClass *priv_data_class;
     int flags;
@@ -250,6 +258,16 @@ int ffurl_get_file_handle(URLContext *h);
  */
 int ffurl_get_multi_file_handle(URLContext *h, int **handles, int *numhandles);
 
+/**
+ * Return a reference to size bytes of the resource starting at pos, without
+ * copying them.
+ *
+ * @return size on success, AVERROR(ENOSYS) if the protocol cannot provide
+ *         the data this way, or another negative error code
+ */
+int ffurl_read_buffer(URLContext *h, AVBufferRef **buf, uint8_t **data,
+                      int64_t pos, int size);
+
 /**
  * Return the current short seek threshold value for this URL.
  *
@@ -31,6 +31,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/slicethread.h"
 #include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/timestamp.h"
@@ -308,6 +309,11 @@ int av_get_packet(AVIOContext *s, AVPacket *pkt, int size)
     pkt->size = 0;
     pkt->pos  = avio_tell(s);
 
+    if (size > 0 && ffio_read_buffer(s, &pkt->buf, &pkt->data, size) == size) {
+        pkt->size = size;
+        return size;
+    }
+
     return append_packet_chunked(s, pkt, size);
 }
 
@@ -2094,16 +2100,11 @@ int ff_index_search_timestamp(const AVIndexEntry *entries, int nb_entries,
     return m;
 }
 
-void ff_configure_buffers_for_index(AVFormatContext *s, int64_t time_tolerance)
+int ff_is_local_protocol(AVFormatContext *s)
 {
-    int ist1, ist2;
-    int64_t pos_delta = 0;
-    int64_t skip = 0;
     //We could use URLProtocol flags here but as many user applications do not use URLProtocols this would be unreliable
     const char *proto = avio_find_protocol_name(s->url);
 
-    av_assert0(time_tolerance >= 0);
-
     if (!proto) {
         av_log(s, AV_LOG_INFO,
                "Protocol name not provided, cannot determine if input is local or "
@@ -2111,7 +2112,39 @@ void ff_configure_buffers_for_index(AVFormatContext *s, int64_t time_tolerance)
                "optimally without knowing the protocol\n");
     }
 
-    if (proto && !(strcmp(proto, "file") && strcmp(proto, "pipe") && strcmp(proto, "cache")))
+    return proto && !(strcmp(proto, "file") && strcmp(proto, "pipe") && strcmp(proto, "cache"));
+}
+
+void ff_configure_buffers(AVFormatContext *s, int64_t pos_delta, int64_t skip)
+{
+    pos_delta *= 2;
+    /* XXX This could be adjusted depending on protocol*/
+    if (s->pb->buffer_size < pos_delta && pos_delta < (1<<24)) {
+        av_log(s, AV_LOG_VERBOSE, "Reconfiguring buffers to size %"PRId64"\n", pos_delta);
+
+        /* realloc the buffer and the original data will be retained */
+        if (ffio_realloc_buf(s->pb, pos_delta)) {
+            av_log(s, AV_LOG_ERROR, "Realloc buffer fail.\n");
+            return;
+        }
+
+        s->pb->short_seek_threshold = FFMAX(s->pb->short_seek_threshold, pos_delta/2);
+    }
+
+    if (skip < (1<<23)) {
+        s->pb->short_seek_threshold = FFMAX(s->pb->short_seek_threshold, skip);
+    }
+}
+
+void ff_configure_buffers_for_index(AVFormatContext *s, int64_t time_tolerance)
+{
+    int ist1, ist2;
+    int64_t pos_delta = 0;
+    int64_t skip = 0;
+
+    av_assert0(time_tolerance >= 0);
+
+    if (ff_is_local_protocol(s))
         return;
 
     for (ist1 = 0; ist1 < s->nb_streams; ist1++) {
@@ -2140,23 +2173,7 @@ void ff_configure_buffers_for_index(AVFormatContext *s, int64_t time_tolerance)
         }
     }
 
-    pos_delta *= 2;
-    /* XXX This could be adjusted depending on protocol*/
-    if (s->pb->buffer_size < pos_delta && pos_delta < (1<<24)) {
-        av_log(s, AV_LOG_VERBOSE, "Reconfiguring buffers to size %"PRId64"\n", pos_delta);
-
-        /* realloc the buffer and the original data will be retained */
-        if (ffio_realloc_buf(s->pb, pos_delta)) {
-            av_log(s, AV_LOG_ERROR, "Realloc buffer fail.\n");
-            return;
-        }
-
-        s->pb->short_seek_threshold = FFMAX(s->pb->short_seek_threshold, pos_delta/2);
-    }
-
-    if (skip < (1<<23)) {
-        s->pb->short_seek_threshold = FFMAX(s->pb->short_seek_threshold, skip);
-    }
+    ff_configure_buffers(s, pos_delta, skip);
 }
 
 int av_index_search_timestamp(AVStream *st, int64_t wanted_timestamp, int flags)
@@ -3612,6 +3629,145 @@ static int add_coded_side_data(AVStream *st, AVCodecContext *avctx)
     return 0;
 }
 
+/**
+ * Probe packets waiting to be decoded by the stream info decode threads.
+ * At most one packet per stream is pending at any time, so each job owns
+ * its stream and the jobs of one batch can run concurrently.
+ */
+typedef struct StreamInfoDecodeJob {
+    AVStream *st;
+    AVPacket *pkt;
+    AVDictionary **options;
+    int codec_info_nb_frames;
+    int flush;
+} StreamInfoDecodeJob;
+
+typedef struct StreamInfoThreads {
+    AVFormatContext *ic;
+    AVSliceThread *thread;
+    StreamInfoDecodeJob *jobs;
+    int nb_jobs;
+    int nb_jobs_allocated;
+} StreamInfoThreads;
+
+static void stream_info_decode_job(void *priv, int jobnr, int threadnr,
+                                   int nb_jobs, int nb_threads)
+{
+    StreamInfoThreads *sit = priv;
+    StreamInfoDecodeJob *job = &sit->jobs[jobnr];
+    AVStream *st = job->st;
+    int codec_info_nb_frames = st->codec_info_nb_frames;
+
+    if (job->flush) {
+        int err;
+
+        do {
+            err = try_decode_frame(sit->ic, st, job->pkt, job->options);
+        } while (err > 0 && !has_codec_parameters(st, NULL));
+
+        if (err < 0)
+            av_log(sit->ic, AV_LOG_INFO,
+                   "decoding for stream %d failed\n", st->index);
+        return;
+    }
+
+    /* Let the decoder see the stream as it was when the packet was read. */
+    st->codec_info_nb_frames = job->codec_info_nb_frames;
+    try_decode_frame(sit->ic, st, job->pkt, job->options);
+    st->codec_info_nb_frames = codec_info_nb_frames;
+
+    av_packet_unref(job->pkt);
+}
+
+static int stream_info_pending(const StreamInfoThreads *sit, const AVStream *st)
+{
+    int i;
+
+    for (i = 0; i < sit->nb_jobs; i++)
+        if (sit->jobs[i].st == st)
+            return 1;
+    return 0;
+}
+
+/* Decode all pending probe packets and wait until they are done. */
+static void stream_info_flush_jobs(StreamInfoThreads *sit)
+{
+    if (!sit->nb_jobs)
+        return;
+    if (sit->thread) {
+        avpriv_slicethread_execute(sit->thread, sit->nb_jobs, 0);
+    } else {
+        int i;
+        for (i = 0; i < sit->nb_jobs; i++)
+            stream_info_decode_job(sit, i, 0, sit->nb_jobs, 1);
+    }
+    sit->nb_jobs = 0;
+}
+
+/**
+ * Queue a probe packet for decoding, or a decoder flush if pkt is NULL.
+ */
+static int stream_info_add_job(StreamInfoThreads *sit, AVStream *st,
+                               const AVPacket *pkt, AVDictionary **options)
+{
+    StreamInfoDecodeJob *job;
+    int ret;
+
+    if (sit->nb_jobs >= sit->nb_jobs_allocated) {
+        job = av_realloc_array(sit->jobs, sit->nb_jobs + 1, sizeof(*sit->jobs));
+        if (!job)
+            return AVERROR(ENOMEM);
+        sit->jobs = job;
+        job = &sit->jobs[sit->nb_jobs_allocated++];
+        job->pkt = av_packet_alloc();
+        if (!job->pkt) {
+            sit->nb_jobs_allocated--;
+            return AVERROR(ENOMEM);
+        }
+    }
+
+    job = &sit->jobs[sit->nb_jobs];
+    if (pkt && (ret = av_packet_ref(job->pkt, pkt)) < 0)
+        return ret;
+    job->st                   = st;
+    job->flush                = !pkt;
+    job->options              = options;
+    job->codec_info_nb_frames = st->codec_info_nb_frames;
+    sit->nb_jobs++;
+
+    return 0;
+}
+
+static void stream_info_threads_uninit(StreamInfoThreads *sit)
+{
+    int i;
+
+    for (i = 0; i < sit->nb_jobs_allocated; i++)
+        av_packet_free(&sit->jobs[i].pkt);
+    av_freep(&sit->jobs);
+    avpriv_slicethread_free(&sit->thread);
+    sit->nb_jobs = sit->nb_jobs_allocated = 0;
+}
+
+/**
+ * Check whether decoding a packet can still tell us anything about the
+ * stream, using the same conditions as the decode loop in try_decode_frame()
+ * but without opening the decoder for streams the container fully describes.
+ */
+static int stream_info_needs_decode(AVFormatContext *ic, AVStream *st)
+{
+    const AVCodec *codec;
+
+    if (!has_codec_parameters(st, NULL) || !has_decode_delay_been_guessed(st))
+        return 1;
+    if (st->codec_info_nb_frames)
+        return 0;
+    codec = st->internal->avctx->codec;
+    if (!codec)
+        codec = find_probe_decoder(ic, st, st->codecpar->codec_id);
+    return codec && (codec->capabilities & AV_CODEC_CAP_CHANNEL_CONF);
+}
+
 int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 {
     int i, count = 0, ret = 0, j;
@@ -3629,6 +3785,10 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
     int64_t probesize = ic->probesize;
     int eof_reached = 0;
     int *missing_streams = av_opt_ptr(ic->iformat->priv_class, ic->priv_data, "missing_streams");
+    int lazy_decode = ic->stream_info_threads != 1;
+    StreamInfoThreads sit = { .ic = ic };
+    int bound_stream = -1;
+    const char *bound_reason = NULL;
 
     flush_codecs = probesize > 0;
 
@@ -3735,6 +3895,18 @@ FF_ENABLE_DEPRECATION_WARNINGS
         ic->streams[i]->info->fps_last_dts  = AV_NOPTS_VALUE;
     }
 
+    if (lazy_decode) {
+        ret = avpriv_slicethread_create(&sit.thread, &sit, stream_info_decode_job,
+                                        NULL, ic->stream_info_threads);
+        if (ret == AVERROR(ENOSYS))
+            sit.thread = NULL;
+        else if (ret < 0)
+            goto find_stream_info_err;
+        else
+            av_log(ic, AV_LOG_DEBUG, "Decoding probe packets with %d threads\n", ret);
+        ret = 0;
+    }
+
     read_size = 0;
     for (;;) {
         const AVPacket *pkt;
@@ -3751,6 +3923,10 @@ FF_ENABLE_DEPRECATION_WARNINGS
             int count;
 
             st = ic->streams[i];
+            /* Streams still decoding a probe packet cannot be judged yet. */
+            if (lazy_decode && stream_info_pending(&sit, st))
+                continue;
+            bound_reason = "codec parameters";
             if (!has_codec_parameters(st, NULL))
                 break;
             /* If the timebase is coarse (like the usual millisecond precision
@@ -3768,6 +3944,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
             count = (ic->iformat->flags & AVFMT_NOTIMESTAMPS) ?
                        st->info->codec_info_duration_fields/2 :
                        st->info->duration_count;
+            bound_reason = "frame rate";
             if (!(st->r_frame_rate.num && st->avg_frame_rate.num) &&
                 st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
                 if (count < fps_analyze_framecount)
@@ -3775,13 +3952,16 @@ FF_ENABLE_DEPRECATION_WARNINGS
             }
             // Look at the first 3 frames if there is evidence of frame delay
             // but the decoder delay is not set.
+            bound_reason = "decoder delay";
             if (st->info->frame_delay_evidence && count < 2 && st->internal->avctx->has_b_frames == 0)
                 break;
+            bound_reason = "extradata";
             if (!st->internal->avctx->extradata &&
                 (!st->internal->extract_extradata.inited ||
                  st->internal->extract_extradata.bsf) &&
                 extract_extradata_check(st))
                 break;
+            bound_reason = "first timestamp";
             if (st->first_dts == AV_NOPTS_VALUE &&
                 !(ic->iformat->flags & AVFMT_NOTIMESTAMPS) &&
                 st->codec_info_nb_frames < ((st->disposition & AV_DISPOSITION_ATTACHED_PIC) ? 1 : ic->max_ts_probe) &&
@@ -3789,6 +3969,14 @@ FF_ENABLE_DEPRECATION_WARNINGS
                  st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO))
                 break;
         }
+        if (i < ic->nb_streams) {
+            bound_stream = i;
+        } else if (sit.nb_jobs) {
+            /* Only the pending probe packets can still hold up the
+             * analysis, so wait for them before reading any further. */
+            stream_info_flush_jobs(&sit);
+            continue;
+        }
         analyzed_all_streams = 0;
         if (!missing_streams || !*missing_streams)
             if (i == ic->nb_streams) {
@@ -3847,6 +4035,12 @@ FF_ENABLE_DEPRECATION_WARNINGS
         if (!(st->disposition & AV_DISPOSITION_ATTACHED_PIC))
             read_size += pkt->size;
 
+        /* Keep at most one packet per stream in flight, so that every
+         * packet of a stream is decoded in order and before the next one is
+         * inspected below. */
+        if (lazy_decode && stream_info_pending(&sit, st))
+            stream_info_flush_jobs(&sit);
+
         avctx = st->internal->avctx;
         if (!st->internal->avctx_inited) {
             ret = avcodec_parameters_to_context(avctx, st->codecpar);
@@ -3950,9 +4144,20 @@ FF_ENABLE_DEPRECATION_WARNINGS
          * If AV_CODEC_CAP_CHANNEL_CONF is set this will force decoding of at
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
-         * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+         * the container.
+         *
+         * In lazy decode mode, streams which are already fully described
+         * are not decoded at all and the others are decoded concurrently. */
+        if (!lazy_decode) {
+            try_decode_frame(ic, st, pkt,
+                             (options && i < orig_nb_streams) ? &options[i] : NULL);
+        } else if (stream_info_needs_decode(ic, st)) {
+            ret = stream_info_add_job(&sit, st, pkt,
+                                      (options && pkt->stream_index < orig_nb_streams) ?
+                                      &options[pkt->stream_index] : NULL);
+            if (ret < 0)
+                goto unref_then_goto_end;
+        }
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(&pkt1);
@@ -3961,6 +4166,13 @@ FF_ENABLE_DEPRECATION_WARNINGS
         count++;
     }
 
+    stream_info_flush_jobs(&sit);
+
+    if (bound_stream >= 0)
+        av_log(ic, AV_LOG_VERBOSE, "Stream #%d bounded the stream analysis "
+               "(%s) after %d packets, %"PRId64" bytes\n",
+               bound_stream, bound_reason, count, read_size);
+
     if (eof_reached) {
         int stream_index;
         for (stream_index = 0; stream_index < ic->nb_streams; stream_index++) {
@@ -3997,7 +4209,15 @@ FF_ENABLE_DEPRECATION_WARNINGS
             st = ic->streams[i];
 
             /* flush the decoders */
-            if (st->info->found_decoder == 1) {
+            if (st->info->found_decoder == 1 && lazy_decode) {
+                err = stream_info_add_job(&sit, st, NULL,
+                                          (options && i < orig_nb_streams)
+                                          ? &options[i] : NULL);
+                if (err < 0) {
+                    ret = err;
+                    goto find_stream_info_err;
+                }
+            } else if (st->info->found_decoder == 1) {
                 do {
                     err = try_decode_frame(ic, st, &empty_pkt,
                                             (options && i < orig_nb_streams)
@@ -4010,6 +4230,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 }
             }
         }
+        stream_info_flush_jobs(&sit);
     }
 
     ff_rfps_calculate(ic);
@@ -4205,6 +4426,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
 find_stream_info_err:
+    stream_info_threads_uninit(&sit);
     for (i = 0; i < ic->nb_streams; i++) {
         st = ic->streams[i];
         if (st->info)
@@ -4412,6 +4634,7 @@ static void free_stream(AVStream **pst)
         av_freep(&st->internal->priv_pts);
         av_bsf_free(&st->internal->extract_extradata.bsf);
         av_packet_free(&st->internal->extract_extradata.pkt);
+        ff_packet_list_free(&st->internal->interleave_queue, &st->last_in_packet_buffer);
     }
     av_freep(&st->internal);
 
@@ -4483,6 +4706,12 @@ void avformat_free_context(AVFormatContext *s)
     av_dict_free(&s->internal->id3v2_meta);
     av_freep(&s->streams);
     flush_packet_queue(s);
+    while (s->internal->packet_buffer_pool) {
+        AVPacketList *pktl = s->internal->packet_buffer_pool;
+        s->internal->packet_buffer_pool = pktl->next;
+        av_free(pktl);
+    }
+    av_freep(&s->internal->interleave_heap);
     av_freep(&s->internal);
     av_freep(&s->url);
     av_free(s);
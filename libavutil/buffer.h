@@ -285,6 +285,18 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Retrieve usage statistics of a buffer pool.
+ *
+ * @param pool   the buffer pool
+ * @param hits   if non-NULL, set to the number of av_buffer_pool_get() calls
+ *               that reused a buffer already in the pool
+ * @param misses if non-NULL, set to the number of av_buffer_pool_get() calls
+ *               that had to allocate a new buffer
+ */
+void av_buffer_pool_get_stats(AVBufferPool *pool,
+                              uint64_t *hits, uint64_t *misses);
+
 /**
  * Query the original opaque parameter of an allocated buffer in the pool.
  *
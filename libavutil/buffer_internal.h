@@ -30,6 +30,12 @@
  */
 #define BUFFER_FLAG_REALLOCATABLE (1 << 0)
 
+/**
+ * The AVBuffer structure is part of a larger structure
+ * and should not be freed.
+ */
+#define BUFFER_FLAG_NO_FREE       (1 << 1)
+
 struct AVBuffer {
     uint8_t *data; /**< data described by this buffer */
     int      size; /**< size of data in bytes */
@@ -72,6 +78,12 @@ typedef struct BufferPoolEntry {
 
     AVBufferPool *pool;
     struct BufferPoolEntry *next;
+
+    /*
+     * An AVBuffer structure to (re)use as AVBuffer for subsequent uses
+     * of this BufferPoolEntry.
+     */
+    AVBuffer buffer;
 } BufferPoolEntry;
 
 struct AVBufferPool {
@@ -89,6 +101,13 @@ struct AVBufferPool {
      */
     atomic_uint refcount;
 
+    /*
+     * Number of av_buffer_pool_get() calls served from the free list (hits)
+     * and by allocating a new buffer (misses).
+     */
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+
     int size;
     void *opaque;
     AVBufferRef* (*alloc)(int size);
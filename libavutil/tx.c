@@ -91,6 +91,22 @@ int ff_tx_gen_compound_mapping(AVTXContext *s)
     return 0;
 }
 
+static const int avx_tab[] = {
+    0, 4, 1, 5, 8, 12, 9, 13, 2, 6, 3, 7, 10, 14, 11, 15
+};
+
+static int is_second_half_of_fft32(int i, int n)
+{
+    if (n <= 32)
+        return i >= 16;
+    else if (i < n/2)
+        return is_second_half_of_fft32(i, n/2);
+    else if (i < 3*n/4)
+        return is_second_half_of_fft32(i - n/2, n/4);
+    else
+        return is_second_half_of_fft32(i - 3*n/4, n/4);
+}
+
 int ff_tx_gen_ptwo_revtab(AVTXContext *s)
 {
     const int m = s->m, inv = s->inv;
@@ -98,10 +114,30 @@ int ff_tx_gen_ptwo_revtab(AVTXContext *s)
     if (!(s->revtab = av_malloc(m*sizeof(*s->revtab))))
         return AVERROR(ENOMEM);
 
-    /* Default */
-    for (int i = 0; i < m; i++) {
-        int k = -split_radix_permutation(i, m, inv) & (m - 1);
-        s->revtab[k] = i;
+    switch (s->ptwo_perm) {
+    case FF_TX_PERM_AVX: /* Blocks of 16, the second half of each fft32 differs */
+        for (int i = 0; i < m; i += 16) {
+            for (int j = 0; j < 16; j++) {
+                int k = -split_radix_permutation(i + j, m, inv) & (m - 1);
+                if (is_second_half_of_fft32(i, m))
+                    s->revtab[k] = i + avx_tab[j];
+                else
+                    s->revtab[k] = ((i + j) & ~7) | (((i + j) >> 1) & 3) |
+                                   (((i + j) << 2) & 4);
+            }
+        }
+        break;
+    case FF_TX_PERM_SWAP_LSBS:
+        for (int i = 0; i < m; i++) {
+            int k = -split_radix_permutation(i, m, inv) & (m - 1);
+            s->revtab[k] = (i & ~3) | ((i >> 1) & 1) | ((i << 1) & 2);
+        }
+        break;
+    default:
+        for (int i = 0; i < m; i++) {
+            int k = -split_radix_permutation(i, m, inv) & (m - 1);
+            s->revtab[k] = i;
+        }
     }
 
     return 0;
@@ -101,6 +101,13 @@ typedef void FFTComplex;
 #define COSTABLE(size) \
     DECLARE_ALIGNED(32, FFTSample, TX_NAME(ff_cos_##size))[size/2]
 
+/* Input orders the power of two FFT may require */
+enum FFTXPtwoPermutation {
+    FF_TX_PERM_DEFAULT,
+    FF_TX_PERM_SWAP_LSBS,
+    FF_TX_PERM_AVX,
+};
+
 /* Used by asm, reorder with care */
 struct AVTXContext {
     int n;              /* Nptwo part */
@@ -112,6 +119,11 @@ struct AVTXContext {
     FFTComplex *tmp;    /* Temporary buffer needed for all compound transforms */
     int        *pfatab; /* Input/Output mapping for compound transforms */
     int        *revtab; /* Input mapping for power of two transforms */
+
+    /* In-place power of two FFT on 1 << nbits points, its input must be
+     * ordered according to ptwo_perm, which revtab takes care of */
+    void      (*ptwo_fft)(void *z, int nbits);
+    int         ptwo_perm;
 };
 
 /* Shared functions */
@@ -146,6 +158,9 @@ int ff_tx_init_mdct_fft_int32(AVTXContext *s, av_tx_fn *tx,
                               enum AVTXType type, int inv, int len,
                               const void *scale, uint64_t flags);
 
+/* Architecture specific init, may only replace ptwo_fft and ptwo_perm */
+void ff_tx_init_float_x86(AVTXContext *s);
+
 typedef struct CosTabsInitOnce {
     void (*func)(void);
     AVOnce control;
@@ -359,6 +359,11 @@ static void (* const fft_dispatch[])(FFTComplex*) = {
     fft1024, fft2048, fft4096, fft8192, fft16384, fft32768, fft65536, fft131072
 };
 
+static void ptwo_fft(void *z, int nbits)
+{
+    fft_dispatch[nbits](z);
+}
+
 #define DECL_COMP_FFT(N)                                                       \
 static void compound_fft_##N##xM(AVTXContext *s, void *_out,                   \
                                  void *_in, ptrdiff_t stride)                  \
@@ -367,7 +372,7 @@ static void compound_fft_##N##xM(AVTXContext *s, void *_out,                   \
     FFTComplex *in = _in;                                                      \
     FFTComplex *out = _out;                                                    \
     FFTComplex fft##N##in[N];                                                  \
-    void (*fftp)(FFTComplex *z) = fft_dispatch[av_log2(m)];                    \
+    const int mb = av_log2(m);                                                 \
                                                                                \
     for (int i = 0; i < m; i++) {                                              \
         for (int j = 0; j < N; j++)                                            \
@@ -376,7 +381,7 @@ static void compound_fft_##N##xM(AVTXContext *s, void *_out,                   \
     }                                                                          \
                                                                                \
     for (int i = 0; i < N; i++)                                                \
-        fftp(s->tmp + m*i);                                                    \
+        s->ptwo_fft(s->tmp + m*i, mb);                                         \
                                                                                \
     for (int i = 0; i < N*m; i++)                                              \
         out[i] = s->tmp[out_map[i]];                                           \
@@ -394,7 +399,7 @@ static void monolithic_fft(AVTXContext *s, void *_out, void *_in,
     int m = s->m, mb = av_log2(m);
     for (int i = 0; i < m; i++)
         out[s->revtab[i]] = in[i];
-    fft_dispatch[mb](out);
+    s->ptwo_fft(out, mb);
 }
 
 #define DECL_COMP_IMDCT(N)                                                     \
@@ -406,7 +411,7 @@ static void compound_imdct_##N##xM(AVTXContext *s, void *_dst, void *_src,     \
     const int m = s->m, len8 = N*m >> 1;                                       \
     const int *in_map = s->pfatab, *out_map = in_map + N*m;                    \
     const FFTSample *src = _src, *in1, *in2;                                   \
-    void (*fftp)(FFTComplex *) = fft_dispatch[av_log2(m)];                     \
+    const int mb = av_log2(m);                                                 \
                                                                                \
     stride /= sizeof(*src); /* To convert it from bytes */                     \
     in1 = src;                                                                 \
@@ -422,7 +427,7 @@ static void compound_imdct_##N##xM(AVTXContext *s, void *_dst, void *_src,     \
     }                                                                          \
                                                                                \
     for (int i = 0; i < N; i++)                                                \
-        fftp(s->tmp + m*i);                                                    \
+        s->ptwo_fft(s->tmp + m*i, mb);                                         \
                                                                                \
     for (int i = 0; i < len8; i++) {                                           \
         const int i0 = len8 + i, i1 = len8 - i - 1;                            \
@@ -447,7 +452,7 @@ static void compound_mdct_##N##xM(AVTXContext *s, void *_dst, void *_src,      \
     FFTComplex *exp = s->exptab, tmp, fft##N##in[N];                           \
     const int m = s->m, len4 = N*m, len3 = len4 * 3, len8 = len4 >> 1;         \
     const int *in_map = s->pfatab, *out_map = in_map + N*m;                    \
-    void (*fftp)(FFTComplex *) = fft_dispatch[av_log2(m)];                     \
+    const int mb = av_log2(m);                                                 \
                                                                                \
     stride /= sizeof(*dst);                                                    \
                                                                                \
@@ -468,7 +473,7 @@ static void compound_mdct_##N##xM(AVTXContext *s, void *_dst, void *_src,      \
     }                                                                          \
                                                                                \
     for (int i = 0; i < N; i++)                                                \
-        fftp(s->tmp + m*i);                                                    \
+        s->ptwo_fft(s->tmp + m*i, mb);                                         \
                                                                                \
     for (int i = 0; i < len8; i++) {                                           \
         const int i0 = len8 + i, i1 = len8 - i - 1;                            \
@@ -493,7 +498,7 @@ static void monolithic_imdct(AVTXContext *s, void *_dst, void *_src,
     FFTComplex *z = _dst, *exp = s->exptab;
     const int m = s->m, len8 = m >> 1;
     const FFTSample *src = _src, *in1, *in2;
-    void (*fftp)(FFTComplex *) = fft_dispatch[av_log2(m)];
+    const int mb = av_log2(m);
 
     stride /= sizeof(*src);
     in1 = src;
@@ -504,7 +509,7 @@ static void monolithic_imdct(AVTXContext *s, void *_dst, void *_src,
         CMUL3(z[s->revtab[i]], tmp, exp[i]);
     }
 
-    fftp(z);
+    s->ptwo_fft(z, mb);
 
     for (int i = 0; i < len8; i++) {
         const int i0 = len8 + i, i1 = len8 - i - 1;
@@ -522,7 +527,7 @@ static void monolithic_mdct(AVTXContext *s, void *_dst, void *_src,
     FFTSample *src = _src, *dst = _dst;
     FFTComplex *exp = s->exptab, tmp, *z = _dst;
     const int m = s->m, len4 = m, len3 = len4 * 3, len8 = len4 >> 1;
-    void (*fftp)(FFTComplex *) = fft_dispatch[av_log2(m)];
+    const int mb = av_log2(m);
 
     stride /= sizeof(*dst);
 
@@ -539,7 +544,7 @@ static void monolithic_mdct(AVTXContext *s, void *_dst, void *_src,
              exp[i].re, exp[i].im);
     }
 
-    fftp(z);
+    s->ptwo_fft(z, mb);
 
     for (int i = 0; i < len8; i++) {
         const int i0 = len8 + i, i1 = len8 - i - 1;
@@ -600,6 +605,8 @@ int TX_NAME(ff_tx_init_mdct_fft)(AVTXContext *s, av_tx_fn *tx,
     s->m = m;
     s->inv = inv;
     s->type = type;
+    s->ptwo_fft = ptwo_fft;
+    s->ptwo_perm = FF_TX_PERM_DEFAULT;
 
     /* Filter out direct 3, 5 and 15 transforms, too niche */
     if (len > 1 || m == 1) {
@@ -627,7 +634,12 @@ int TX_NAME(ff_tx_init_mdct_fft)(AVTXContext *s, av_tx_fn *tx,
     if (n != 1)
         init_cos_tabs(0);
     if (m != 1) {
-        ff_tx_gen_ptwo_revtab(s);
+#ifdef TX_FLOAT
+        if (ARCH_X86)
+            ff_tx_init_float_x86(s);
+#endif
+        if ((err = ff_tx_gen_ptwo_revtab(s)))
+            return err;
         for (int i = 4; i <= av_log2(m); i++)
             init_cos_tabs(i);
     }
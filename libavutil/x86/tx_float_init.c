@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define TX_FLOAT
+#include "libavutil/tx_priv.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/common.h"
+#include "libavutil/x86/cpu.h"
+
+void ff_tx_fft_float_sse(void *z, int nbits);
+void ff_tx_fft_float_avx(void *z, int nbits);
+
+/* Only the power of two part has SIMD versions, the 3, 5 and 15-point
+ * transforms of compound sizes and the MDCT pre/post rotations are C. */
+av_cold void ff_tx_init_float_x86(AVTXContext *s)
+{
+    int cpu_flags = av_get_cpu_flags();
+    int nbits = av_log2(s->m);
+
+    if (nbits < 2 || nbits > 17)
+        return;
+
+    if (EXTERNAL_SSE(cpu_flags)) {
+        s->ptwo_fft  = ff_tx_fft_float_sse;
+        s->ptwo_perm = FF_TX_PERM_SWAP_LSBS;
+    }
+
+    if (EXTERNAL_AVX_FAST(cpu_flags) && nbits >= 5) {
+        s->ptwo_fft  = ff_tx_fft_float_avx;
+        s->ptwo_perm = FF_TX_PERM_AVX;
+    }
+}
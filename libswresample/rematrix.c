@@ -413,6 +413,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
             maxsum = FFMAX(maxsum, sum);
         }
         *((int*)s->native_one) = 32768;
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_s16;
         if (maxsum <= 32768) {
             s->mix_1_1_f = (mix_1_1_func_type*)copy_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_s16;
@@ -433,6 +434,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((float*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
@@ -445,6 +447,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((double*)s->native_one) = 1.0;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         s->native_one    = av_mallocz(sizeof(int));
@@ -467,6 +470,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         *((int*)s->native_one) = 32768;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_s32;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_s32;
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_s32;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
     }else
         av_assert0(0);
@@ -481,6 +485,23 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
+    /* compact coefficients for the outputs mixed from more than 2 inputs */
+    s->native_n_stride = nb_in * (s->midbuf.fmt == AV_SAMPLE_FMT_DBLP ? sizeof(double) : sizeof(float));
+    s->native_n_matrix = av_calloc(nb_out, s->native_n_stride);
+    if (!s->native_n_matrix)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_out; i++) {
+        uint8_t *row = s->native_n_matrix + i * s->native_n_stride;
+        for (j = 0; j < s->matrix_ch[i][0] && j < nb_in; j++) {
+            int in_i = s->matrix_ch[i][1 + j];
+            switch (s->midbuf.fmt) {
+            case AV_SAMPLE_FMT_FLTP: ((float  *)row)[j] = s->matrix_flt[i][in_i]; break;
+            case AV_SAMPLE_FMT_DBLP: ((double *)row)[j] = s->matrix[i][in_i];     break;
+            default:                 ((int    *)row)[j] = s->matrix32[i][in_i];   break;
+            }
+        }
+    }
+
     if(HAVE_X86ASM && HAVE_MMX)
         return swri_rematrix_init_x86(s);
 
@@ -492,27 +513,29 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->native_n_matrix);
 }
 
-int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
-
-    if(s->mix_any_f) {
-        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
-        return 0;
-    }
-
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
-    }
-
-    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
-    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
-
-    for(out_i=0; out_i<out->ch_count; out_i++){
+typedef struct RematrixJob {
+    AudioData *out;
+    AudioData *in;
+    int len;
+    int len1;
+    int off;
+    int mustcopy;
+} RematrixJob;
+
+static void rematrix_channels(SwrContext *s, void *arg, int ch_start, int ch_end){
+    RematrixJob *job = arg;
+    AudioData *out = job->out;
+    AudioData *in  = job->in;
+    int len  = job->len;
+    int len1 = job->len1;
+    int off  = job->off;
+    int mustcopy = job->mustcopy;
+    int out_i, in_i, j;
+
+    for(out_i=ch_start; out_i<ch_end; out_i++){
         switch(s->matrix_ch[out_i][0]){
         case 0:
             if(mustcopy)
@@ -541,36 +564,42 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             if(len != len1)
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
-        default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
+        default: {
+            const uint8_t *ins[SWR_CH_MAX];
+            uint8_t *coeffp = s->native_n_matrix + out_i * s->native_n_stride;
+            int nb_in = s->matrix_ch[out_i][0];
+            int n_len1 = s->mix_n_1_simd ? len & ~15 : 0;
+
+            for(j=0; j<nb_in; j++)
+                ins[j] = in->ch[s->matrix_ch[out_i][1+j]];
+            if(n_len1)
+                s->mix_n_1_simd(out->ch[out_i], ins, coeffp, nb_in, n_len1);
+            if(len != n_len1){
+                for(j=0; j<nb_in; j++)
+                    ins[j] += n_len1 * in->bps;
+                s->mix_n_1_f(out->ch[out_i] + n_len1 * out->bps, ins, coeffp, nb_in, len - n_len1);
             }
+            break;}
         }
     }
+}
+
+int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
+    RematrixJob job = { out, in, len, 0, 0, mustcopy };
+
+    if(s->mix_any_f) {
+        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
+        return 0;
+    }
+
+    if(s->mix_2_1_simd || s->mix_1_1_simd){
+        job.len1= len&~15;
+        job.off = job.len1 * out->bps;
+    }
+
+    av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
+    av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
+
+    swri_execute_channels(s, rematrix_channels, &job, out->ch_count, len);
     return 0;
 }
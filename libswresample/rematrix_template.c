@@ -60,6 +60,19 @@ static void RENAME(sum2)(SAMPLE *out, const SAMPLE *in1, const SAMPLE *in2, COEF
         out[i] = R(coeff1*in1[i] + coeff2*in2[i]);
 }
 
+#ifndef TEMPLATE_CLIP
+static void RENAME(sumn)(SAMPLE *out, const SAMPLE **in, COEFF *coeffp, integer nb_in, integer len){
+    int i, j;
+
+    for(i=0; i<len; i++){
+        INTER v = 0;
+        for(j=0; j<nb_in; j++)
+            v += in[j][i] * (INTER)coeffp[j];
+        out[i] = R(v);
+    }
+}
+#endif
+
 static void RENAME(copy)(SAMPLE *out, const SAMPLE *in, COEFF *coeffp, integer index, integer len){
     int i;
     INTER coeff = coeffp[index];
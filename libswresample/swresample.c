@@ -21,6 +21,7 @@
 #include "libavutil/opt.h"
 #include "swresample_internal.h"
 #include "audioconvert.h"
+#include "resample.h"
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/internal.h"
@@ -129,6 +130,7 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    avpriv_slicethread_free(&s->slicethread);
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
@@ -149,6 +151,34 @@ av_cold void swr_close(SwrContext *s){
     clear_context(s);
 }
 
+static void channel_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    SwrContext *s = priv;
+    int ch_start = s->channel_count *  jobnr      / nb_jobs;
+    int ch_end   = s->channel_count * (jobnr + 1) / nb_jobs;
+
+    s->channel_func(s, s->channel_arg, ch_start, ch_end);
+}
+
+/* below this many samples in total, splitting costs more than it gains */
+#define MIN_THREADED_SAMPLES 4096
+
+void swri_execute_channels(SwrContext *s, swri_channel_func *func, void *arg,
+                           int ch_count, int count)
+{
+    int nb_jobs = FFMIN(s->nb_threads, ch_count);
+
+    if (!s->slicethread || nb_jobs < 2 || (int64_t)ch_count * count < MIN_THREADED_SAMPLES) {
+        func(s, arg, 0, ch_count);
+        return;
+    }
+
+    s->channel_func  = func;
+    s->channel_arg   = arg;
+    s->channel_count = ch_count;
+    avpriv_slicethread_execute(s->slicethread, nb_jobs, 0);
+}
+
 av_cold int swr_init(struct SwrContext *s){
     int ret;
     char l1[1024], l2[1024];
@@ -390,6 +420,22 @@ av_assert0(s->out.ch_count);
             goto fail;
     }
 
+    s->nb_threads = 1;
+    if (s->threads != 1) {
+        ret = avpriv_slicethread_create(&s->slicethread, s, channel_worker,
+                                        NULL, s->threads);
+        if (ret == AVERROR(ENOSYS)) {
+            ret = 1;
+        } else if (ret < 0) {
+            goto fail;
+        }
+        s->nb_threads = ret;
+        if (ret == 1)
+            avpriv_slicethread_free(&s->slicethread);
+        else
+            av_log(s, AV_LOG_DEBUG, "Using %d threads\n", ret);
+    }
+
     return 0;
 fail:
     swr_close(s);
@@ -480,6 +526,67 @@ static void buf_set(AudioData *out, AudioData *in, int count){
     }
 }
 
+typedef struct ResampleJob {
+    ResampleContext c;              ///< resampler state before the call, shared by all jobs
+    ResampleContext c_out;          ///< resampler state after the call
+    AudioData *dst;
+    AudioData *src;
+    int dst_size;
+    int src_size;
+    int ret;
+    int consumed;
+} ResampleJob;
+
+static void resample_channels(SwrContext *s, void *arg, int ch_start, int ch_end)
+{
+    ResampleJob *job = arg;
+    ResampleContext c = job->c;
+    AudioData dst = *job->dst;
+    AudioData src = *job->src;
+    int ch, ret, consumed;
+
+    for (ch = ch_start; ch < ch_end; ch++) {
+        dst.ch[ch - ch_start] = job->dst->ch[ch];
+        src.ch[ch - ch_start] = job->src->ch[ch];
+    }
+    dst.ch_count =
+    src.ch_count = ch_end - ch_start;
+
+    ret = s->resampler->multiple_resample(&c, &dst, job->dst_size, &src, job->src_size, &consumed);
+
+    /* every job advances its copy of the state identically */
+    if (!ch_start) {
+        job->c_out    = c;
+        job->ret      = ret;
+        job->consumed = consumed;
+    }
+}
+
+/**
+ * Resample all channels, splitting them between threads for the swr engine.
+ * Each job works on its own copy of the resampler state, so the result is
+ * identical to the single-threaded one.
+ */
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size,
+                             AudioData *src, int src_size, int *consumed)
+{
+    ResampleJob job;
+
+    if (!s->slicethread || s->engine != SWR_ENGINE_SWR)
+        return s->resampler->multiple_resample(s->resample, dst, dst_size, src, src_size, consumed);
+
+    job.c        = *s->resample;
+    job.dst      = dst;
+    job.src      = src;
+    job.dst_size = dst_size;
+    job.src_size = src_size;
+    swri_execute_channels(s, resample_channels, &job, dst->ch_count, dst_size);
+
+    *s->resample = job.c_out;
+    *consumed    = job.consumed;
+    return job.ret;
+}
+
 /**
  *
  * @return number of samples output per channel
@@ -514,7 +621,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -534,7 +641,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -579,11 +686,51 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     return ret_sum;
 }
 
+typedef struct DitherJob {
+    AudioData *dst;
+    AudioData *src;
+    int count;
+} DitherJob;
+
+static void dither_channels(SwrContext *s, void *arg, int ch_start, int ch_end)
+{
+    DitherJob *job = arg;
+    AudioData *conv_src = job->dst;
+    AudioData *preout   = job->src;
+    int out_count = job->count;
+    int ch;
+
+    if (s->dither.method < SWR_DITHER_NS){
+        if (s->mix_2_1_simd) {
+            int len1= out_count&~15;
+            int off = len1 * preout->bps;
+
+            if(len1)
+                for(ch=ch_start; ch<ch_end; ch++)
+                    s->mix_2_1_simd(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_simd_one, 0, 0, len1);
+            if(out_count != len1)
+                for(ch=ch_start; ch<ch_end; ch++)
+                    s->mix_2_1_f(conv_src->ch[ch] + off, preout->ch[ch] + off, s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos + off, s->native_one, 0, 0, out_count - len1);
+        } else {
+            for(ch=ch_start; ch<ch_end; ch++)
+                s->mix_2_1_f(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_one, 0, 0, out_count);
+        }
+    } else {
+        switch(s->int_sample_fmt) {
+        case AV_SAMPLE_FMT_S16P :swri_noise_shaping_int16(s, conv_src, preout, &s->dither.noise, out_count, ch_start, ch_end); break;
+        case AV_SAMPLE_FMT_S32P :swri_noise_shaping_int32(s, conv_src, preout, &s->dither.noise, out_count, ch_start, ch_end); break;
+        case AV_SAMPLE_FMT_FLTP :swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count, ch_start, ch_end); break;
+        case AV_SAMPLE_FMT_DBLP :swri_noise_shaping_double(s,conv_src, preout, &s->dither.noise, out_count, ch_start, ch_end); break;
+        }
+    }
+}
+
 static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
                                                       AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
     int ret/*, in_max*/;
     AudioData preout_tmp, midbuf_tmp;
+    DitherJob dither_job;
 
     if(s->full_convert){
         av_assert0(!s->resample);
@@ -676,28 +823,13 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
             if(s->dither.noise_pos + out_count > s->dither.noise.count)
                 s->dither.noise_pos = 0;
 
-            if (s->dither.method < SWR_DITHER_NS){
-                if (s->mix_2_1_simd) {
-                    int len1= out_count&~15;
-                    int off = len1 * preout->bps;
-
-                    if(len1)
-                        for(ch=0; ch<preout->ch_count; ch++)
-                            s->mix_2_1_simd(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_simd_one, 0, 0, len1);
-                    if(out_count != len1)
-                        for(ch=0; ch<preout->ch_count; ch++)
-                            s->mix_2_1_f(conv_src->ch[ch] + off, preout->ch[ch] + off, s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos + off, s->native_one, 0, 0, out_count - len1);
-                } else {
-                    for(ch=0; ch<preout->ch_count; ch++)
-                        s->mix_2_1_f(conv_src->ch[ch], preout->ch[ch], s->dither.noise.ch[ch] + s->dither.noise.bps * s->dither.noise_pos, s->native_one, 0, 0, out_count);
-                }
-            } else {
-                switch(s->int_sample_fmt) {
-                case AV_SAMPLE_FMT_S16P :swri_noise_shaping_int16(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_S32P :swri_noise_shaping_int32(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_FLTP :swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_DBLP :swri_noise_shaping_double(s,conv_src, preout, &s->dither.noise, out_count); break;
-                }
+            dither_job.dst   = conv_src;
+            dither_job.src   = preout;
+            dither_job.count = out_count;
+            swri_execute_channels(s, dither_channels, &dither_job, preout->ch_count, out_count);
+            if (s->dither.method >= SWR_DITHER_NS) {
+                int taps = s->dither.ns_taps;
+                s->dither.ns_pos = (s->dither.ns_pos + taps - out_count % taps) % taps;
             }
             s->dither.noise_pos += out_count;
         }
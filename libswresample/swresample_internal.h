@@ -23,6 +23,7 @@
 
 #include "swresample.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/slicethread.h"
 #include "config.h"
 
 #define SWR_CH_MAX 64
@@ -42,6 +43,16 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+/**
+ * Mix nb_in channels into one: out[i] = sum(in[j][i] * coeffp[j]).
+ */
+typedef void (mix_n_1_func_type)(void *out, const uint8_t **in, void *coeffp, integer nb_in, integer len);
+
+/**
+ * Process the channels [ch_start, ch_end) of a per-channel operation.
+ */
+typedef void (swri_channel_func)(SwrContext *s, void *arg, int ch_start, int ch_end);
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -184,16 +195,39 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    uint8_t *native_n_matrix;                       ///< per output channel, coefficients of the inputs listed in matrix_ch
+    int native_n_stride;                            ///< size of a native_n_matrix row in bytes
+    mix_n_1_func_type *mix_n_1_f;
+    mix_n_1_func_type *mix_n_1_simd;
+
+    int threads;                                    ///< requested number of threads, 0 for automatic
+    int nb_threads;                                 ///< number of threads in use
+    AVSliceThread *slicethread;                     ///< thread pool for the per-channel work, NULL if single-threaded
+    swri_channel_func *channel_func;                ///< per-channel job currently executed on the thread pool
+    void *channel_arg;                              ///< opaque argument of channel_func
+    int channel_count;                              ///< number of channels split between the jobs
+
     /* TODO: callbacks for ASM optimizations */
 };
 
+/**
+ * Run func over ch_count channels, split into contiguous channel ranges
+ * executed on the thread pool if there is one and the work is large enough.
+ * Every channel must be independent of the others.
+ *
+ * @param count number of samples per channel, used to decide whether
+ *              splitting the work is worth the synchronization
+ */
+void swri_execute_channels(SwrContext *s, swri_channel_func *func, void *arg,
+                           int ch_count, int count);
+
 av_warn_unused_result
 int swri_realloc_audio(AudioData *a, int count);
 
-void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
-void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
+void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
+void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count, int ch_start, int ch_end);
 
 av_warn_unused_result
 int swri_rematrix_init(SwrContext *s);
@@ -24,6 +24,8 @@
 SECTION_RODATA 32
 dw1: times 8  dd 1
 w1 : times 16 dw 1
+pq_16384: times 4 dq 16384
+pd_16384: dd 16384
 
 SECTION .text
 
@@ -222,6 +224,152 @@ mix_2_1_int16_u_int %+ SUFFIX:
 %endif
 %endmacro
 
+; The mix_n_1 functions mix any number of input channels into one output
+; channel, 16 samples per iteration, in the same order of operations as the
+; C code so that the output is identical.
+;
+; void mix_n_1(void *out, const uint8_t **in, void *coeffp, integer nb_in,
+;              integer len)
+
+%macro MIXN_FLT 0
+cglobal mix_n_1_float, 5, 8, 6, out, in, coeffp, nb_in, len, off, j, src
+    shl        lenq, 2
+    xor        offq, offq
+.next:
+%assign i 0
+%rep 64/mmsize
+    xorps   m %+ i, m %+ i
+%assign i i+1
+%endrep
+    xor          jq, jq
+.in_loop:
+    mov        srcq, [inq + jq*gprsize]
+    VBROADCASTSS m5, [coeffpq + 4*jq]
+    add        srcq, offq
+%assign i 0
+%rep 64/mmsize
+    movu         m4, [srcq + i*mmsize]
+    mulps        m4, m4, m5
+    addps   m %+ i, m %+ i, m4
+%assign i i+1
+%endrep
+    inc          jq
+    cmp          jq, nb_inq
+        jl .in_loop
+%assign i 0
+%rep 64/mmsize
+    movu [outq + offq + i*mmsize], m %+ i
+%assign i i+1
+%endrep
+    add        offq, 64
+    cmp        offq, lenq
+        jl .next
+    RET
+%endmacro
+
+; 17.15 fixed point coefficients, the sum wraps and is truncated to 16 bits
+%macro MIXN_INT16 0
+cglobal mix_n_1_int16, 5, 8, 7, out, in, coeffp, nb_in, len, off, j, src
+    add        lenq, lenq
+    xor        offq, offq
+    VPBROADCASTD m6, [pd_16384]
+.next:
+%assign i 0
+%rep 64/mmsize
+    mova    m %+ i, m6
+%assign i i+1
+%endrep
+    xor          jq, jq
+.in_loop:
+    mov        srcq, [inq + jq*gprsize]
+    VPBROADCASTD m4, [coeffpq + 4*jq]
+    add        srcq, offq
+%assign i 0
+%rep 64/mmsize
+    pmovsxwd     m5, [srcq + i*mmsize/2]
+    pmulld       m5, m4
+    paddd   m %+ i, m5
+%assign i i+1
+%endrep
+    inc          jq
+    cmp          jq, nb_inq
+        jl .in_loop
+%if cpuflag(avx512)
+    psrad        m0, 15
+    vpmovdw [outq + offq], m0
+%else
+%assign i 0
+%rep 64/mmsize
+    pslld   m %+ i, 1
+    psrad   m %+ i, 16
+%assign i i+1
+%endrep
+%assign i 0
+%rep 32/mmsize
+%assign a 2*i
+%assign b 2*i+1
+    packssdw m %+ a, m %+ b
+%if mmsize == 32
+    vpermq  m %+ a, m %+ a, q3120
+%endif
+    movu [outq + offq + i*mmsize], m %+ a
+%assign i i+1
+%endrep
+%endif
+    add        offq, 32
+    cmp        offq, lenq
+        jl .next
+    RET
+%endmacro
+
+; 17.15 fixed point coefficients, summed in 64 bits and truncated to 32 bits
+%macro MIXN_INT32 0
+cglobal mix_n_1_int32, 5, 8, 12, out, in, coeffp, nb_in, len, off, j, src
+    shl        lenq, 2
+    xor        offq, offq
+    mova        m11, [pq_16384]
+.next:
+%assign i 0
+%rep 128/mmsize
+    mova    m %+ i, m11
+%assign i i+1
+%endrep
+    xor          jq, jq
+.in_loop:
+    mov        srcq, [inq + jq*gprsize]
+    VPBROADCASTD m8, [coeffpq + 4*jq]
+    add        srcq, offq
+%assign i 0
+%rep 64/mmsize
+%assign a 2*i
+%assign b 2*i+1
+    movu         m9, [srcq + i*mmsize]
+    pmuldq      m10, m9, m8
+    psrlq        m9, 32
+    pmuldq       m9, m8
+    paddq   m %+ a, m10
+    paddq   m %+ b, m9
+%assign i i+1
+%endrep
+    inc          jq
+    cmp          jq, nb_inq
+        jl .in_loop
+%assign i 0
+%rep 64/mmsize
+%assign a 2*i
+%assign b 2*i+1
+    psrlq   m %+ a, 15
+    psrlq   m %+ b, 15
+    psllq   m %+ b, 32
+    pblendw m %+ a, m %+ b, 0xCC
+    movu [outq + offq + i*mmsize], m %+ a
+%assign i i+1
+%endrep
+    add        offq, 64
+    cmp        offq, lenq
+        jl .next
+    RET
+%endmacro
 
 INIT_MMX mmx
 MIX1_INT16 u
@@ -248,3 +396,25 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if ARCH_X86_64
+INIT_XMM sse
+MIXN_FLT
+INIT_XMM sse4
+MIXN_INT16
+MIXN_INT32
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+MIXN_FLT
+%endif
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIXN_INT16
+MIXN_INT32
+%endif
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+MIXN_FLT
+MIXN_INT16
+%endif
+%endif
@@ -166,13 +166,18 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     mov         min_filter_count_x4q, min_filter_length_x4q
 %endif
 %ifidn %1, int16
-    movd                          m0, [pd_0x4000]
+    movd                         xm0, [pd_0x4000]
 %else ; float/double
     xorps                         m0, m0, m0
 %endif
 
     align 16
 .inner_loop:
+%if mmsize == 32 && %2 == 2
+    ; int16 filters are only padded to 8 taps, finish with xmm
+    cmp         min_filter_count_x4q, -mmsize
+    jg .inner_tail
+%endif
     movu                          m1, [srcq+min_filter_count_x4q*1]
 %ifidn %1, int16
 %if cpuflag(xop)
@@ -191,14 +196,24 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
 %endif
     add         min_filter_count_x4q, mmsize
     js .inner_loop
+%if mmsize == 32 && %2 == 2
+    jmp .inner_end
+.inner_tail:
+    movu                         xm1, [srcq+min_filter_count_x4q*1]
+    pmaddwd                      xm1, [filterq+min_filter_count_x4q*1]
+    paddd                         m0, m1
+    add         min_filter_count_x4q, 16
+    js .inner_tail
+.inner_end:
+%endif
 
 %ifidn %1, int16
     HADDD                         m0, m1
-    psrad                         m0, 15
+    psrad                        xm0, 15
     add                        fracd, dst_incr_modd
-    packssdw                      m0, m0
+    packssdw                     xm0, xm0
     add                       indexd, dst_incr_divd
-    movd                      [dstq], m0
+    movd                      [dstq], xm0
 %else ; float/double
     ; horizontal sum & store
 %if mmsize == 32
@@ -312,7 +327,7 @@ cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index,
     mov                   ctx_stackq, ctxq
     mov           min_filter_len_x4d, [ctxq+ResampleContext.filter_length]
 %ifidn %1, int16
-    movd                          m4, [pd_0x4000]
+    movd                         xm4, [pd_0x4000]
 %else ; float/double
     cvtsi2s%4                    xm0, src_incrd
     movs%4                       xm4, [%5]
@@ -365,7 +380,7 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     PUSH                              dword [ctxq+ResampleContext.phase_count]  ; unneeded replacement of phase_mask
     PUSH                              r3d
 %ifidn %1, int16
-    movd                          m4, [pd_0x4000]
+    movd                         xm4, [pd_0x4000]
 %else ; float/double
     cvtsi2s%4                    xm0, r3d
     movs%4                       xm4, [%5]
@@ -423,6 +438,10 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 
     align 16
 .inner_loop:
+%if mmsize == 32 && %2 == 2
+    cmp         min_filter_count_x4q, -mmsize
+    jg .inner_tail
+%endif
     movu                          m1, [srcq+min_filter_count_x4q*1]
 %ifidn %1, int16
 %if cpuflag(xop)
@@ -447,38 +466,56 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %endif
     add         min_filter_count_x4q, mmsize
     js .inner_loop
+%if mmsize == 32 && %2 == 2
+    jmp .inner_end
+.inner_tail:
+    movu                         xm1, [srcq+min_filter_count_x4q*1]
+    pmaddwd                      xm3, xm1, [filter2q+min_filter_count_x4q*1]
+    pmaddwd                      xm1, [filter1q+min_filter_count_x4q*1]
+    paddd                         m2, m3
+    paddd                         m0, m1
+    add         min_filter_count_x4q, 16
+    js .inner_tail
+.inner_end:
+%endif
 
 %ifidn %1, int16
-%if mmsize == 16
+%if mmsize == 32
+    vextracti128                 xm3, m2, 1
+    vextracti128                 xm1, m0, 1
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
+%endif
+%if mmsize >= 16
 %if cpuflag(xop)
     vphadddq                      m2, m2
     vphadddq                      m0, m0
 %endif
-    pshufd                        m3, m2, q0032
-    pshufd                        m1, m0, q0032
-    paddd                         m2, m3
-    paddd                         m0, m1
+    pshufd                       xm3, xm2, q0032
+    pshufd                       xm1, xm0, q0032
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
 %endif
 %if notcpuflag(xop)
-    PSHUFLW                       m3, m2, q0032
-    PSHUFLW                       m1, m0, q0032
-    paddd                         m2, m3
-    paddd                         m0, m1
+    PSHUFLW                      xm3, xm2, q0032
+    PSHUFLW                      xm1, xm0, q0032
+    paddd                        xm2, xm3
+    paddd                        xm0, xm1
 %endif
-    psubd                         m2, m0
+    psubd                        xm2, xm0
     ; This is probably a really bad idea on atom and other machines with a
     ; long transfer latency between GPRs and XMMs (atom). However, it does
     ; make the clip a lot simpler...
-    movd                         eax, m2
+    movd                         eax, xm2
     add                       indexd, dst_incr_divd
     imul                              fracd
     idiv                              src_incrd
-    movd                          m1, eax
+    movd                         xm1, eax
     add                        fracd, dst_incr_modd
-    paddd                         m0, m1
-    psrad                         m0, 15
-    packssdw                      m0, m0
-    movd                      [dstq], m0
+    paddd                        xm0, xm1
+    psrad                        xm0, 15
+    packssdw                     xm0, xm0
+    movd                      [dstq], xm0
 
     ; note that for imul/idiv, I need to move filter to edx/eax for each:
     ; - 32bit: eax=r0[filter1], edx=r2[filter2]
@@ -601,6 +638,10 @@ RESAMPLE_FNS int16, 2, 1
 
 INIT_XMM sse2
 RESAMPLE_FNS int16, 2, 1
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RESAMPLE_FNS int16, 2, 1
+%endif
 %if HAVE_XOP_EXTERNAL
 INIT_XMM xop
 RESAMPLE_FNS int16, 2, 1
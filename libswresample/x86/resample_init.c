@@ -36,6 +36,7 @@ int ff_resample_linear_##type##_##opt(ResampleContext *c, void *dst, \
 
 RESAMPLE_FUNCS(int16,  mmxext);
 RESAMPLE_FUNCS(int16,  sse2);
+RESAMPLE_FUNCS(int16,  avx2);
 RESAMPLE_FUNCS(int16,  xop);
 RESAMPLE_FUNCS(float,  sse);
 RESAMPLE_FUNCS(float,  avx);
@@ -59,6 +60,10 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample_linear = ff_resample_linear_int16_sse2;
             c->dsp.resample_common = ff_resample_common_int16_sse2;
         }
+        if (EXTERNAL_AVX2_FAST(mm_flags)) {
+            c->dsp.resample_linear = ff_resample_linear_int16_avx2;
+            c->dsp.resample_common = ff_resample_common_int16_avx2;
+        }
         if (EXTERNAL_XOP(mm_flags)) {
             c->dsp.resample_linear = ff_resample_linear_int16_xop;
             c->dsp.resample_common = ff_resample_common_int16_xop;
@@ -142,6 +142,27 @@ extern void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst
                                  int width, int height, int srcStride,
                                  int dst1Stride, int dst2Stride);
 
+/**
+ * Word (16 bits per sample) versions of the functions above, for high bit
+ * depth semi-planar formats. Strides are in bytes. interleaveWords() shifts
+ * the samples left by shift bits, deinterleaveWords() shifts them right.
+ * shiftWords() copies a plane, shifting left for positive and right for
+ * negative values of shift.
+ */
+extern void (*interleaveWords)(const uint16_t *src1, const uint16_t *src2,
+                               uint16_t *dst, int width, int height,
+                               int src1Stride, int src2Stride, int dstStride,
+                               int shift);
+
+extern void (*deinterleaveWords)(const uint16_t *src, uint16_t *dst1,
+                                 uint16_t *dst2, int width, int height,
+                                 int srcStride, int dst1Stride, int dst2Stride,
+                                 int shift);
+
+extern void (*shiftWords)(const uint16_t *src, uint16_t *dst,
+                          int width, int height,
+                          int srcStride, int dstStride, int shift);
+
 extern void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                            uint8_t *dst1, uint8_t *dst2,
                            int width, int height,
@@ -745,6 +745,64 @@ static void deinterleaveBytes_c(const uint8_t *src, uint8_t *dst1, uint8_t *dst2
     }
 }
 
+static void interleaveWords_c(const uint16_t *src1, const uint16_t *src2,
+                              uint16_t *dest, int width, int height,
+                              int src1Stride, int src2Stride, int dstStride,
+                              int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        for (w = 0; w < width; w++) {
+            dest[2 * w + 0] = src1[w] << shift;
+            dest[2 * w + 1] = src2[w] << shift;
+        }
+        dest += dstStride  / 2;
+        src1 += src1Stride / 2;
+        src2 += src2Stride / 2;
+    }
+}
+
+static void deinterleaveWords_c(const uint16_t *src, uint16_t *dst1,
+                                uint16_t *dst2, int width, int height,
+                                int srcStride, int dst1Stride, int dst2Stride,
+                                int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        for (w = 0; w < width; w++) {
+            dst1[w] = src[2 * w + 0] >> shift;
+            dst2[w] = src[2 * w + 1] >> shift;
+        }
+        src  += srcStride  / 2;
+        dst1 += dst1Stride / 2;
+        dst2 += dst2Stride / 2;
+    }
+}
+
+static void shiftWords_c(const uint16_t *src, uint16_t *dst,
+                         int width, int height,
+                         int srcStride, int dstStride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        if (shift >= 0) {
+            for (w = 0; w < width; w++)
+                dst[w] = src[w] << shift;
+        } else {
+            for (w = 0; w < width; w++)
+                dst[w] = src[w] >> -shift;
+        }
+        src += srcStride / 2;
+        dst += dstStride / 2;
+    }
+}
+
 static inline void vu9_to_vu12_c(const uint8_t *src1, const uint8_t *src2,
                                  uint8_t *dst1, uint8_t *dst2,
                                  int width, int height,
@@ -984,6 +1042,9 @@ static av_cold void rgb2rgb_init_c(void)
     ff_rgb24toyv12     = ff_rgb24toyv12_c;
     interleaveBytes    = interleaveBytes_c;
     deinterleaveBytes  = deinterleaveBytes_c;
+    interleaveWords    = interleaveWords_c;
+    deinterleaveWords  = deinterleaveWords_c;
+    shiftWords         = shiftWords_c;
     vu9_to_vu12        = vu9_to_vu12_c;
     yvu9_to_yuy2       = yvu9_to_yuy2_c;
 
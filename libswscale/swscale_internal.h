@@ -31,6 +31,7 @@
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/slicethread.h"
 #include "libavutil/ppc/util_altivec.h"
 
 #define STR(s) AV_TOSTRING(s) // AV_STRINGIFY is too long
@@ -323,6 +324,20 @@ typedef struct SwsContext {
     uint8_t *cascaded1_tmp[4];
     int cascaded_mainindex;
 
+    /* The slice_* fields allow splitting the output of a full-frame scaler
+     * call into horizontal bands, each scaled by its own child context on
+     * a separate thread. Unscaled converters use no child contexts, the
+     * bands are converted with the parent context directly.
+     */
+    int nb_threads;
+    AVSliceThread *slicethread;
+    struct SwsContext **slice_ctx;
+    int nb_slice_ctx;
+    const uint8_t *slice_src[4];
+    int slice_srcStride[4];
+    uint8_t *slice_dst[4];
+    int slice_dstStride[4];
+
     double gamma_value;
     int gamma_flag;
     int is_internal_gamma;
@@ -864,6 +879,26 @@ void ff_get_unscaled_swscale_aarch64(SwsContext *c);
  */
 SwsFunc ff_getSwsFunc(SwsContext *c);
 
+/**
+ * Slice thread worker scaling one horizontal band of the output picture
+ * with the child context matching threadnr.
+ */
+void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
+                         int nb_jobs, int nb_threads);
+
+/**
+ * Return 1 if the unscaled converter set in c->swscale can convert the
+ * horizontal bands of a picture concurrently, 0 otherwise.
+ */
+int ff_sws_unscaled_threadable(SwsContext *c);
+
+/**
+ * Slice thread worker converting one horizontal band of the picture with
+ * the unscaled converter of the context passed as priv.
+ */
+void ff_sws_unscaled_slice_worker(void *priv, int jobnr, int threadnr,
+                                  int nb_jobs, int nb_threads);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -231,7 +231,6 @@ static int planarToP01xWrapper(SwsContext *c, const uint8_t *src8[],
     const uint16_t **src = (const uint16_t**)src8;
     uint16_t *dstY = (uint16_t*)(dstParam8[0] + dstStride[0] * srcSliceY);
     uint16_t *dstUV = (uint16_t*)(dstParam8[1] + dstStride[1] * srcSliceY / 2);
-    int x, y;
 
     /* Calculate net shift required for values. */
     const int shift[3] = {
@@ -245,27 +244,81 @@ static int planarToP01xWrapper(SwsContext *c, const uint8_t *src8[],
 
     av_assert0(!(srcStride[0] % 2 || srcStride[1] % 2 || srcStride[2] % 2 ||
                  dstStride[0] % 2 || dstStride[1] % 2));
+    av_assert0(shift[1] == shift[2]);
+
+    shiftWords(src[0], dstY, c->srcW, srcSliceH,
+               srcStride[0], dstStride[0], shift[0]);
+    interleaveWords(src[1], src[2], dstUV, c->chrSrcW, (srcSliceH + 1) / 2,
+                    srcStride[1], srcStride[2], dstStride[1], shift[1]);
+
+    return srcSliceH;
+}
 
+static int p01xToPlanarWrapper(SwsContext *c, const uint8_t *src8[],
+                               int srcStride[], int srcSliceY,
+                               int srcSliceH, uint8_t *dstParam8[],
+                               int dstStride[])
+{
+    const AVPixFmtDescriptor *src_format = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
+    const uint16_t **src = (const uint16_t**)src8;
+    uint16_t *dstY = (uint16_t*)(dstParam8[0] + dstStride[0] * srcSliceY);
+    uint16_t *dstU = (uint16_t*)(dstParam8[1] + dstStride[1] * srcSliceY / 2);
+    uint16_t *dstV = (uint16_t*)(dstParam8[2] + dstStride[2] * srcSliceY / 2);
+
+    /* Calculate net shift required for values, the samples of the
+     * semi-planar formats are stored in the most significant bits. The
+     * low bits are not filled from the high ones, like in the generic
+     * scaler. */
+    const int shift = src_format->comp[0].depth + src_format->comp[0].shift -
+                      dst_format->comp[0].depth - dst_format->comp[0].shift;
+
+    av_assert0(!(srcStride[0] % 2 || srcStride[1] % 2 ||
+                 dstStride[0] % 2 || dstStride[1] % 2 || dstStride[2] % 2));
+
+    shiftWords(src[0], dstY, c->srcW, srcSliceH,
+               srcStride[0], dstStride[0], -shift);
+    deinterleaveWords(src[1], dstU, dstV, c->chrSrcW, (srcSliceH + 1) / 2,
+                      srcStride[1], dstStride[1], dstStride[2], shift);
+
+    return srcSliceH;
+}
+
+static int nv12ToPlanar16Wrapper(SwsContext *c, const uint8_t *src[],
+                                 int srcStride[], int srcSliceY,
+                                 int srcSliceH, uint8_t *dstParam8[],
+                                 int dstStride[])
+{
+    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
+    const int shift = dst_format->comp[0].depth - 8;
+    uint16_t *dstY = (uint16_t*)(dstParam8[0] + dstStride[0] * srcSliceY);
+    uint16_t *dst1 = (uint16_t*)(dstParam8[1] + dstStride[1] * srcSliceY / 2);
+    uint16_t *dst2 = (uint16_t*)(dstParam8[2] + dstStride[2] * srcSliceY / 2);
+    const uint8_t *srcY  = src[0];
+    const uint8_t *srcUV = src[1];
+    int x, y;
+
+    av_assert0(!(dstStride[0] % 2 || dstStride[1] % 2 || dstStride[2] % 2));
+
+    if (c->srcFormat == AV_PIX_FMT_NV21)
+        FFSWAP(uint16_t*, dst1, dst2);
+
+    /* Only shift the samples, without replicating the high bits into the
+     * low ones, like the generic scaler does for these formats. */
     for (y = 0; y < srcSliceH; y++) {
-        uint16_t *tdstY = dstY;
-        const uint16_t *tsrc0 = src[0];
-        for (x = c->srcW; x > 0; x--) {
-            *tdstY++ = *tsrc0++ << shift[0];
-        }
-        src[0] += srcStride[0] / 2;
+        for (x = 0; x < c->srcW; x++)
+            dstY[x] = srcY[x] << shift;
+        srcY += srcStride[0];
         dstY += dstStride[0] / 2;
 
         if (!(y & 1)) {
-            uint16_t *tdstUV = dstUV;
-            const uint16_t *tsrc1 = src[1];
-            const uint16_t *tsrc2 = src[2];
-            for (x = c->srcW / 2; x > 0; x--) {
-                *tdstUV++ = *tsrc1++ << shift[1];
-                *tdstUV++ = *tsrc2++ << shift[2];
+            for (x = 0; x < c->chrSrcW; x++) {
+                dst1[x] = srcUV[2 * x + 0] << shift;
+                dst2[x] = srcUV[2 * x + 1] << shift;
             }
-            src[1] += srcStride[1] / 2;
-            src[2] += srcStride[2] / 2;
-            dstUV += dstStride[1] / 2;
+            srcUV += srcStride[1];
+            dst1  += dstStride[1] / 2;
+            dst2  += dstStride[2] / 2;
         }
     }
 
@@ -1970,6 +2023,20 @@ void ff_get_unscaled_swscale(SwsContext *c)
         (dstFormat == AV_PIX_FMT_P010 || dstFormat == AV_PIX_FMT_P016)) {
         c->swscale = planarToP01xWrapper;
     }
+    /* p01x_to_yuv420p1x */
+    if ((srcFormat == AV_PIX_FMT_P010 &&
+         (dstFormat == AV_PIX_FMT_YUV420P10 || dstFormat == AV_PIX_FMT_YUV420P16)) ||
+        (srcFormat == AV_PIX_FMT_P016 && dstFormat == AV_PIX_FMT_YUV420P16)) {
+        c->swscale = p01xToPlanarWrapper;
+    }
+    /* nv12_to_yuv420p1x; the other direction reduces the depth and stays on
+     * the scaler, which dithers it */
+    if ((srcFormat == AV_PIX_FMT_NV12 || srcFormat == AV_PIX_FMT_NV21) &&
+        (dstFormat == AV_PIX_FMT_YUV420P9  || dstFormat == AV_PIX_FMT_YUV420P10 ||
+         dstFormat == AV_PIX_FMT_YUV420P12 || dstFormat == AV_PIX_FMT_YUV420P14 ||
+         dstFormat == AV_PIX_FMT_YUV420P16)) {
+        c->swscale = nv12ToPlanar16Wrapper;
+    }
     /* yuv420p_to_p01xle */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUVA420P) &&
         (dstFormat == AV_PIX_FMT_P010LE || dstFormat == AV_PIX_FMT_P016LE)) {
@@ -2178,6 +2245,57 @@ void ff_get_unscaled_swscale(SwsContext *c)
         ff_get_unscaled_swscale_aarch64(c);
 }
 
+int ff_sws_unscaled_threadable(SwsContext *c)
+{
+    /* converters which only read the context and handle any slice aligned
+     * to the chroma subsampling independently */
+    return c->swscale == planarToNv12Wrapper    ||
+           c->swscale == nv12ToPlanarWrapper    ||
+           c->swscale == planarToNv24Wrapper    ||
+           c->swscale == nv24ToPlanarWrapper    ||
+           c->swscale == planarToP01xWrapper    ||
+           c->swscale == planar8ToP01xleWrapper ||
+           c->swscale == p01xToPlanarWrapper    ||
+           c->swscale == nv12ToPlanar16Wrapper  ||
+           c->swscale == planarRgbToRgbWrapper  ||
+           c->swscale == rgbToPlanarRgbWrapper  ||
+           c->swscale == planarCopyWrapper      ||
+           c->swscale == packedCopyWrapper;
+}
+
+void ff_sws_unscaled_slice_worker(void *priv, int jobnr, int threadnr,
+                                  int nb_jobs, int nb_threads)
+{
+    SwsContext *c = priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const int nb_planes = av_pix_fmt_count_planes(c->srcFormat);
+    /* Keep the bands aligned to the chroma subsampling and to the period
+     * of the ordered dither used by planarCopyWrapper(). */
+    const int align  = 8 << FFMAX(c->chrSrcVSubSample, c->chrDstVSubSample);
+    const int band_h = FFALIGN((c->srcH + nb_jobs - 1) / nb_jobs, align);
+    const int y      = FFMIN(jobnr * band_h, c->srcH);
+    const int h      = FFMIN(band_h, c->srcH - y);
+    const uint8_t *src[4];
+    uint8_t *dst[4];
+    int srcStride[4], dstStride[4];
+    int i;
+
+    if (h <= 0)
+        return;
+
+    memcpy(srcStride, c->slice_srcStride, sizeof(srcStride));
+    memcpy(dst,       c->slice_dst,       sizeof(dst));
+    memcpy(dstStride, c->slice_dstStride, sizeof(dstStride));
+    for (i = 0; i < 4; i++) {
+        int vsub = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+        src[i] = c->slice_src[i];
+        if (src[i] && i < nb_planes)
+            src[i] += (y >> vsub) * srcStride[i];
+    }
+
+    c->swscale(c, src, srcStride, y, h, dst, dstStride);
+}
+
 /* Convert the palette to the same packed 32-bit format as the palette */
 void sws_convertPalette8ToPacked32(const uint8_t *src, uint8_t *dst,
                                    int num_pixels, const uint8_t *palette)
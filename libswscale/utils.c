@@ -871,6 +871,15 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
     int need_reinit = 0;
+    int i;
+
+    for (i = 0; i < c->nb_slice_ctx; i++) {
+        int ret = sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange,
+                                           table, dstRange, brightness,
+                                           contrast, saturation);
+        if (ret < 0)
+            return ret;
+    }
 
     handle_formats(c);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
@@ -1171,6 +1180,62 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
+static av_cold int context_init_threaded(SwsContext *c, int unscaled,
+                                         SwsFilter *srcFilter, SwsFilter *dstFilter)
+{
+    int i, ret;
+
+    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                    unscaled ? ff_sws_unscaled_slice_worker :
+                                               ff_sws_slice_worker,
+                                    NULL, c->nb_threads);
+    if (ret == AVERROR(ENOSYS)) {
+        c->nb_threads = 1;
+        return 0;
+    } else if (ret < 0)
+        return ret;
+
+    c->nb_threads = ret;
+    if (ret == 1) {
+        avpriv_slicethread_free(&c->slicethread);
+        return 0;
+    }
+
+    /* unscaled converters work on the bands with the parent context */
+    if (unscaled)
+        return 0;
+
+    c->slice_ctx = av_mallocz_array(c->nb_threads, sizeof(*c->slice_ctx));
+    if (!c->slice_ctx)
+        return AVERROR(ENOMEM);
+    c->nb_slice_ctx = c->nb_threads;
+
+    for (i = 0; i < c->nb_slice_ctx; i++) {
+        SwsContext *slice = sws_alloc_context();
+        if (!slice)
+            return AVERROR(ENOMEM);
+        c->slice_ctx[i] = slice;
+
+        ret = av_opt_copy(slice, c);
+        if (ret < 0)
+            return ret;
+        slice->nb_threads = 1;
+        slice->flags     &= ~SWS_PRINT_INFO;
+
+        ret = sws_init_context(slice, srcFilter, dstFilter);
+        if (ret < 0)
+            return ret;
+
+        ret = sws_setColorspaceDetails(slice, c->srcColorspaceTable, c->srcRange,
+                                       c->dstColorspaceTable, c->dstRange,
+                                       c->brightness, c->contrast, c->saturation);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                              SwsFilter *dstFilter)
 {
@@ -1842,12 +1907,23 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                 av_log(c, AV_LOG_INFO,
                        "using unscaled %s -> %s special converter\n",
                        av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+            if (c->nb_threads != 1 && ff_sws_unscaled_threadable(c))
+                return context_init_threaded(c, 1, srcFilter, dstFilter);
             return 0;
         }
     }
 
     c->swscale = ff_getSwsFunc(c);
-    return ff_init_filters(c);
+    ret = ff_init_filters(c);
+    if (ret < 0)
+        return ret;
+
+    /* Only the generic scaler gets slice contexts, the special converters
+     * and the cascades have returned above. Error diffusion carries state
+     * from one output line to the next. */
+    if (c->nb_threads != 1 && c->dither != SWS_DITHER_ED)
+        return context_init_threaded(c, 0, srcFilter, dstFilter);
+    return 0;
 nomem:
     ret = AVERROR(ENOMEM);
 fail: // FIXME replace things by appropriate error codes
@@ -2334,6 +2410,11 @@ void sws_freeContext(SwsContext *c)
     if (!c)
         return;
 
+    avpriv_slicethread_free(&c->slicethread);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
 
@@ -298,3 +298,225 @@ UYVY_TO_YUV422
 INIT_XMM avx
 UYVY_TO_YUV422
 %endif
+
+;------------------------------------------------------------------------------
+; shift_words(const uint16_t *src, uint16_t *dst, int width, int height,
+;             int src_stride, int dst_stride, int shift)
+;------------------------------------------------------------------------------
+; %1 shift instruction
+%macro SHIFT_WORDS_LINES 1
+%%loop_line:
+    mov          xq, wq
+    neg          xq
+    mov        cntq, wq
+    and        cntq, mmsize / 2 - 1
+    jz %%loop_simd_check
+
+%%loop_scalar:
+    movzx      vald, word [srcq + xq * 2]
+    movd        xm0, vald
+    %1          xm0, xm2
+    movd       vald, xm0
+    mov [dstq + xq * 2], valw
+    add          xq, 1
+    sub        cntq, 1
+    jg %%loop_scalar
+
+%%loop_simd_check:
+    test         xq, xq
+    jz %%end_line
+
+%%loop_simd:
+    movu          m0, [srcq + xq * 2]
+    %1            m0, xm2
+    movu [dstq + xq * 2], m0
+    add           xq, mmsize / 2
+    jl %%loop_simd
+
+%%end_line:
+    add        srcq, src_strideq
+    add        dstq, dst_strideq
+    sub          hd, 1
+    jg %%loop_line
+%endmacro
+
+%macro SHIFT_WORDS 0
+cglobal shift_words, 7, 10, 3, src, dst, w, h, src_stride, dst_stride, shift, x, cnt, val
+    movsxdifnidn          wq, wd
+    movsxdifnidn src_strideq, src_strided
+    movsxdifnidn dst_strideq, dst_strided
+
+    lea        srcq, [srcq + wq * 2]
+    lea        dstq, [dstq + wq * 2]
+
+    test     shiftd, shiftd
+    jl .right
+    movd        xm2, shiftd
+    SHIFT_WORDS_LINES psllw
+    RET
+
+.right:
+    neg      shiftd
+    movd        xm2, shiftd
+    SHIFT_WORDS_LINES psrlw
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; interleave_words(const uint16_t *src1, const uint16_t *src2, uint16_t *dst,
+;                  int width, int height, int src1_stride, int src2_stride,
+;                  int dst_stride, int shift)
+;------------------------------------------------------------------------------
+%macro INTERLEAVE_WORDS 0
+cglobal interleave_words, 9, 12, 5, src1, src2, dst, w, h, src1_stride, src2_stride, dst_stride, shift, x, cnt, val
+    movsxdifnidn           wq, wd
+    movsxdifnidn src1_strideq, src1_strided
+    movsxdifnidn src2_strideq, src2_strided
+    movsxdifnidn  dst_strideq, dst_strided
+
+    movd        xm2, shiftd
+    lea       src1q, [src1q + wq * 2]
+    lea       src2q, [src2q + wq * 2]
+    lea        dstq, [dstq  + wq * 4]
+
+.loop_line:
+    mov          xq, wq
+    neg          xq
+    mov        cntq, wq
+    and        cntq, mmsize / 2 - 1
+    jz .loop_simd_check
+
+.loop_scalar:
+    movzx      vald, word [src1q + xq * 2]
+    movd        xm0, vald
+    psllw       xm0, xm2
+    movd       vald, xm0
+    mov [dstq + xq * 4], valw
+    movzx      vald, word [src2q + xq * 2]
+    movd        xm0, vald
+    psllw       xm0, xm2
+    movd       vald, xm0
+    mov [dstq + xq * 4 + 2], valw
+    add          xq, 1
+    sub        cntq, 1
+    jg .loop_scalar
+
+.loop_simd_check:
+    test         xq, xq
+    jz .end_line
+
+.loop_simd:
+    movu         m0, [src1q + xq * 2]
+    movu         m1, [src2q + xq * 2]
+    psllw        m0, xm2
+    psllw        m1, xm2
+    punpcklwd    m3, m0, m1
+    punpckhwd    m0, m1
+%if cpuflag(avx2)
+    vperm2i128   m4, m3, m0, 0x20
+    vperm2i128   m0, m3, m0, 0x31
+    movu [dstq + xq * 4], m4
+%else
+    movu [dstq + xq * 4], m3
+%endif
+    movu [dstq + xq * 4 + mmsize], m0
+    add          xq, mmsize / 2
+    jl .loop_simd
+
+.end_line:
+    add       src1q, src1_strideq
+    add       src2q, src2_strideq
+    add        dstq, dst_strideq
+    sub          hd, 1
+    jg .loop_line
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; deinterleave_words(const uint16_t *src, uint16_t *dst1, uint16_t *dst2,
+;                    int width, int height, int src_stride, int dst1_stride,
+;                    int dst2_stride, int shift)
+;------------------------------------------------------------------------------
+%macro DEINTERLEAVE_WORDS 0
+cglobal deinterleave_words, 9, 12, 5, src, dst1, dst2, w, h, src_stride, dst1_stride, dst2_stride, shift, x, cnt, val
+    movsxdifnidn           wq, wd
+    movsxdifnidn  src_strideq, src_strided
+    movsxdifnidn dst1_strideq, dst1_strided
+    movsxdifnidn dst2_strideq, dst2_strided
+
+    movd        xm2, shiftd
+    lea        srcq, [srcq  + wq * 4]
+    lea       dst1q, [dst1q + wq * 2]
+    lea       dst2q, [dst2q + wq * 2]
+
+.loop_line:
+    mov          xq, wq
+    neg          xq
+    mov        cntq, wq
+    and        cntq, mmsize / 2 - 1
+    jz .loop_simd_check
+
+.loop_scalar:
+    movzx      vald, word [srcq + xq * 4]
+    movd        xm0, vald
+    psrlw       xm0, xm2
+    movd       vald, xm0
+    mov [dst1q + xq * 2], valw
+    movzx      vald, word [srcq + xq * 4 + 2]
+    movd        xm0, vald
+    psrlw       xm0, xm2
+    movd       vald, xm0
+    mov [dst2q + xq * 2], valw
+    add          xq, 1
+    sub        cntq, 1
+    jg .loop_scalar
+
+.loop_simd_check:
+    test         xq, xq
+    jz .end_line
+
+.loop_simd:
+    movu         m0, [srcq + xq * 4]
+    movu         m1, [srcq + xq * 4 + mmsize]
+    psrlw        m0, xm2
+    psrlw        m1, xm2
+    ; sign extend the words so that packssdw restores them unchanged
+    pslld        m3, m0, 16
+    pslld        m4, m1, 16
+    psrad        m3, 16
+    psrad        m4, 16
+    packssdw     m3, m4
+    psrad        m0, 16
+    psrad        m1, 16
+    packssdw     m0, m1
+%if cpuflag(avx2)
+    vpermq       m3, m3, q3120
+    vpermq       m0, m0, q3120
+%endif
+    movu [dst1q + xq * 2], m3
+    movu [dst2q + xq * 2], m0
+    add          xq, mmsize / 2
+    jl .loop_simd
+
+.end_line:
+    add        srcq, src_strideq
+    add       dst1q, dst1_strideq
+    add       dst2q, dst2_strideq
+    sub          hd, 1
+    jg .loop_line
+    RET
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+SHIFT_WORDS
+INTERLEAVE_WORDS
+DEINTERLEAVE_WORDS
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SHIFT_WORDS
+INTERLEAVE_WORDS
+DEINTERLEAVE_WORDS
+%endif
+%endif
@@ -0,0 +1,126 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <math.h>
+
+#define TX_FLOAT
+#include "libavutil/tx_priv.h"
+#include "libavutil/mem.h"
+
+#include "checkasm.h"
+
+#define MIN_BITS 2
+#define MAX_BITS 17
+
+/* The reference checkasm calls is the last version that passed, which need
+ * not be the C one, so remember the input order each version wants */
+static struct {
+    void (*fn)(void *z, int nbits);
+    int perm;
+} versions[8];
+static int nb_versions;
+
+static void add_version(const AVTXContext *s)
+{
+    for (int i = 0; i < nb_versions; i++)
+        if (versions[i].fn == s->ptwo_fft)
+            return;
+    if (nb_versions < FF_ARRAY_ELEMS(versions)) {
+        versions[nb_versions].fn   = s->ptwo_fft;
+        versions[nb_versions].perm = s->ptwo_perm;
+        nb_versions++;
+    }
+}
+
+static int version_perm(void *fn)
+{
+    for (int i = 0; i < nb_versions; i++)
+        if ((void *)versions[i].fn == fn)
+            return versions[i].perm;
+    return FF_TX_PERM_DEFAULT;
+}
+
+static void check_ptwo_fft(const FFTComplex *src, FFTComplex *ref,
+                           FFTComplex *new, int nbits)
+{
+    const int len = 1 << nbits;
+    AVTXContext *s;
+    av_tx_fn fn;
+    float scale = 1.0f;
+
+    declare_func(void, void *z, int nbits);
+
+    if (av_tx_init(&s, &fn, AV_TX_FLOAT_FFT, 0, len, &scale, 0) < 0)
+        return;
+    add_version(s);
+
+    if (check_func(s->ptwo_fft, "fft_%d", len)) {
+        AVTXContext r = { .m = len, .ptwo_perm = version_perm(func_ref) };
+
+        if (ff_tx_gen_ptwo_revtab(&r) < 0) {
+            fail();
+            goto end;
+        }
+
+        /* Lay the input out the way each version's revtab says, so that
+         * both compute the same transform */
+        for (int i = 0; i < len; i++) {
+            ref[r.revtab[i]] = src[i];
+            new[s->revtab[i]] = src[i];
+        }
+        av_free(r.revtab);
+
+        call_ref(ref, nbits);
+        call_new(new, nbits);
+
+        if (!float_near_abs_eps_array((float *)ref, (float *)new,
+                                      4 * nbits * sqrtf(len) * FLT_EPSILON,
+                                      2 * len))
+            fail();
+
+        bench_new(new, nbits);
+    }
+
+end:
+    av_tx_uninit(&s);
+}
+
+void checkasm_check_av_tx(void)
+{
+    FFTComplex *src = av_malloc_array(1 << MAX_BITS, sizeof(*src));
+    FFTComplex *ref = av_malloc_array(1 << MAX_BITS, sizeof(*ref));
+    FFTComplex *new = av_malloc_array(1 << MAX_BITS, sizeof(*new));
+
+    if (!src || !ref || !new)
+        goto end;
+
+    for (int i = 0; i < 1 << MAX_BITS; i++) {
+        src[i].re = (rnd() & 0xFFFF) / 32768.0f - 1.0f;
+        src[i].im = (rnd() & 0xFFFF) / 32768.0f - 1.0f;
+    }
+
+    for (int nbits = MIN_BITS; nbits <= MAX_BITS; nbits++)
+        check_ptwo_fft(src, ref, new, nbits);
+    report("fft");
+
+end:
+    av_free(src);
+    av_free(ref);
+    av_free(new);
+}
@@ -0,0 +1,168 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#include "libavcodec/hevcpred.h"
+
+#include "checkasm.h"
+
+static const uint32_t pixel_mask[3] = { 0xffffffff, 0x03ff03ff, 0x0fff0fff };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define BUF_STRIDE (32 * 2)
+/* the prediction functions take the stride in pixels */
+#define PIXEL_STRIDE (BUF_STRIDE / SIZEOF_PIXEL)
+#define EDGE_SIZE ((16 + 64 + 16) * 2)
+
+/* top[-1] and left[-1] are read, as well as up to 2 * size samples after
+ * the start of each edge */
+#define randomize_edges()                                       \
+    do {                                                        \
+        uint32_t mask = pixel_mask[(bit_depth - 8) >> 1];       \
+        int k;                                                  \
+        for (k = 0; k < EDGE_SIZE; k += 4) {                    \
+            AV_WN32A(top_buf  + k, rnd() & mask);               \
+            AV_WN32A(left_buf + k, rnd() & mask);               \
+        }                                                       \
+    } while (0)
+
+static void check_pred_planar(HEVCPredContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, top_buf,  [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_STRIDE * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_STRIDE * 32]);
+    const uint8_t *top  = top_buf  + 16 * SIZEOF_PIXEL;
+    const uint8_t *left = left_buf + 16 * SIZEOF_PIXEL;
+    int i;
+
+    declare_func(void, uint8_t *src, const uint8_t *top,
+                 const uint8_t *left, ptrdiff_t stride);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+        if (check_func(h->pred_planar[i], "hevc_pred_planar_%dx%d_%d",
+                       size, size, bit_depth)) {
+            randomize_edges();
+            memset(dst0, 0, BUF_STRIDE * 32);
+            memset(dst1, 0, BUF_STRIDE * 32);
+            call_ref(dst0, top, left, PIXEL_STRIDE);
+            call_new(dst1, top, left, PIXEL_STRIDE);
+            if (memcmp(dst0, dst1, BUF_STRIDE * 32))
+                fail();
+            bench_new(dst1, top, left, PIXEL_STRIDE);
+        }
+    }
+}
+
+static void check_pred_dc(HEVCPredContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, top_buf,  [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_STRIDE * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_STRIDE * 32]);
+    const uint8_t *top  = top_buf  + 16 * SIZEOF_PIXEL;
+    const uint8_t *left = left_buf + 16 * SIZEOF_PIXEL;
+    int log2_size, c_idx;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int log2_size, int c_idx);
+
+    for (log2_size = 2; log2_size <= 5; log2_size++) {
+        int size = 1 << log2_size;
+        if (check_func(h->pred_dc, "hevc_pred_dc_%dx%d_%d",
+                       size, size, bit_depth)) {
+            for (c_idx = 0; c_idx < 2; c_idx++) {
+                randomize_edges();
+                memset(dst0, 0, BUF_STRIDE * 32);
+                memset(dst1, 0, BUF_STRIDE * 32);
+                call_ref(dst0, top, left, PIXEL_STRIDE, log2_size, c_idx);
+                call_new(dst1, top, left, PIXEL_STRIDE, log2_size, c_idx);
+                if (memcmp(dst0, dst1, BUF_STRIDE * 32))
+                    fail();
+            }
+            bench_new(dst1, top, left, PIXEL_STRIDE, log2_size, 0);
+        }
+    }
+}
+
+static void check_pred_angular(HEVCPredContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, top_buf,  [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [EDGE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_STRIDE * 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_STRIDE * 32]);
+    const uint8_t *top  = top_buf  + 16 * SIZEOF_PIXEL;
+    const uint8_t *left = left_buf + 16 * SIZEOF_PIXEL;
+    int i, mode, c_idx;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int c_idx, int mode);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+        if (check_func(h->pred_angular[i], "hevc_pred_angular_%dx%d_%d",
+                       size, size, bit_depth)) {
+            for (mode = 2; mode <= 34; mode++) {
+                for (c_idx = 0; c_idx < 2; c_idx++) {
+                    randomize_edges();
+                    memset(dst0, 0, BUF_STRIDE * 32);
+                    memset(dst1, 0, BUF_STRIDE * 32);
+                    call_ref(dst0, top, left, PIXEL_STRIDE, c_idx, mode);
+                    call_new(dst1, top, left, PIXEL_STRIDE, c_idx, mode);
+                    if (memcmp(dst0, dst1, BUF_STRIDE * 32))
+                        fail();
+                }
+            }
+            bench_new(dst1, top, left, PIXEL_STRIDE, 0, 3);
+        }
+    }
+}
+
+void checkasm_check_hevc_pred(void)
+{
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCPredContext h;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        check_pred_planar(&h, bit_depth);
+    }
+    report("pred_planar");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCPredContext h;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        check_pred_dc(&h, bit_depth);
+    }
+    report("pred_dc");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCPredContext h;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        check_pred_angular(&h, bit_depth);
+    }
+    report("pred_angular");
+}
@@ -179,6 +179,115 @@ static void check_interleave_bytes(void)
     }
 }
 
+static const int word_shifts[] = { 0, 6, -6 };
+
+static void check_shift_words(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,  [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_STRIDE * MAX_HEIGHT]);
+    int i, s;
+
+    declare_func(void, const uint16_t *src, uint16_t *dst, int width, int height,
+                 int srcStride, int dstStride, int shift);
+
+    randomize_buffers((uint8_t *)src, MAX_STRIDE * MAX_HEIGHT * 2);
+
+    for (s = 0; s < FF_ARRAY_ELEMS(word_shifts); s++) {
+        if (check_func(shiftWords, "shift_words_%d", word_shifts[s])) {
+            for (i = 0; i <= 33; i++) {
+                int w = i > 0 ? i : 1 + rnd() % (MAX_STRIDE - 1);
+                int h = 1 + rnd() % MAX_HEIGHT;
+
+                memset(dst0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                memset(dst1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                call_ref(src, dst0, w, h, MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+                call_new(src, dst1, w, h, MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+                checkasm_check(uint16_t, dst0, MAX_STRIDE * 2, dst1, MAX_STRIDE * 2,
+                               MAX_STRIDE, h, "dst");
+            }
+            bench_new(src, dst1, MAX_STRIDE, MAX_HEIGHT,
+                      MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+        }
+    }
+}
+
+static void check_interleave_words(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, src0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, src1, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [2 * MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [2 * MAX_STRIDE * MAX_HEIGHT]);
+    int i, s;
+
+    declare_func(void, const uint16_t *src1, const uint16_t *src2, uint16_t *dst,
+                 int width, int height, int src1Stride, int src2Stride,
+                 int dstStride, int shift);
+
+    randomize_buffers((uint8_t *)src0, MAX_STRIDE * MAX_HEIGHT * 2);
+    randomize_buffers((uint8_t *)src1, MAX_STRIDE * MAX_HEIGHT * 2);
+
+    for (s = 0; s < 2; s++) {
+        if (check_func(interleaveWords, "interleave_words_%d", word_shifts[s])) {
+            for (i = 0; i <= 33; i++) {
+                int w = i > 0 ? i : 1 + rnd() % (MAX_STRIDE - 1);
+                int h = 1 + rnd() % MAX_HEIGHT;
+
+                memset(dst0, 0, 4 * MAX_STRIDE * MAX_HEIGHT);
+                memset(dst1, 0, 4 * MAX_STRIDE * MAX_HEIGHT);
+                call_ref(src0, src1, dst0, w, h, MAX_STRIDE * 2, MAX_STRIDE * 2,
+                         MAX_STRIDE * 4, word_shifts[s]);
+                call_new(src0, src1, dst1, w, h, MAX_STRIDE * 2, MAX_STRIDE * 2,
+                         MAX_STRIDE * 4, word_shifts[s]);
+                checkasm_check(uint16_t, dst0, MAX_STRIDE * 4, dst1, MAX_STRIDE * 4,
+                               2 * MAX_STRIDE, h, "dst");
+            }
+            bench_new(src0, src1, dst1, MAX_STRIDE, MAX_HEIGHT, MAX_STRIDE * 2,
+                      MAX_STRIDE * 2, MAX_STRIDE * 4, word_shifts[s]);
+        }
+    }
+}
+
+static void check_deinterleave_words(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,    [2 * MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst0_0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst0_1, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst1_0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst1_1, [MAX_STRIDE * MAX_HEIGHT]);
+    int i, s;
+
+    declare_func(void, const uint16_t *src, uint16_t *dst1, uint16_t *dst2,
+                 int width, int height, int srcStride, int dst1Stride,
+                 int dst2Stride, int shift);
+
+    randomize_buffers((uint8_t *)src, 4 * MAX_STRIDE * MAX_HEIGHT);
+
+    for (s = 0; s < 2; s++) {
+        if (check_func(deinterleaveWords, "deinterleave_words_%d", word_shifts[s])) {
+            for (i = 0; i <= 33; i++) {
+                int w = i > 0 ? i : 1 + rnd() % (MAX_STRIDE - 1);
+                int h = 1 + rnd() % MAX_HEIGHT;
+
+                memset(dst0_0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                memset(dst0_1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                memset(dst1_0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                memset(dst1_1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+                call_ref(src, dst0_0, dst0_1, w, h, MAX_STRIDE * 4,
+                         MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+                call_new(src, dst1_0, dst1_1, w, h, MAX_STRIDE * 4,
+                         MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+                checkasm_check(uint16_t, dst0_0, MAX_STRIDE * 2, dst1_0, MAX_STRIDE * 2,
+                               MAX_STRIDE, h, "dst1");
+                checkasm_check(uint16_t, dst0_1, MAX_STRIDE * 2, dst1_1, MAX_STRIDE * 2,
+                               MAX_STRIDE, h, "dst2");
+            }
+            bench_new(src, dst1_0, dst1_1, MAX_STRIDE, MAX_HEIGHT, MAX_STRIDE * 4,
+                      MAX_STRIDE * 2, MAX_STRIDE * 2, word_shifts[s]);
+        }
+    }
+}
+
 void checkasm_check_sw_rgb(void)
 {
     ff_sws_rgb2rgb_init();
@@ -203,4 +312,13 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    check_shift_words();
+    report("shift_words");
+
+    check_interleave_words();
+    report("interleave_words");
+
+    check_deinterleave_words();
+    report("deinterleave_words");
 }
@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define LEN 256
+#define MAX_IN 8
+
+static void randomize_input(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    for (i = 0; i < LEN; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_FLTP:
+            ((float *)buf)[i]   = (int32_t)rnd() / (float)INT32_MAX;
+            break;
+        case AV_SAMPLE_FMT_S16P:
+            ((int16_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_S32P:
+            ((int32_t *)buf)[i] = rnd();
+            break;
+        }
+    }
+}
+
+static void check_mix_n_1(enum AVSampleFormat fmt, uint64_t out_layout)
+{
+    static const int lens[] = { 16, 64, LEN };
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_IN * LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LEN * 4]);
+    const uint8_t *in[MAX_IN];
+    const int bps = av_get_bytes_per_sample(fmt);
+    struct SwrContext *s;
+    int i, nb_in, li;
+
+    declare_func(void, void *out, const uint8_t **in, void *coeffp,
+                 integer nb_in, integer len);
+
+    s = swr_alloc_set_opts(NULL, out_layout, fmt, 48000,
+                           AV_CH_LAYOUT_7POINT1, fmt, 48000, 0, NULL);
+    if (!s)
+        return;
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0);
+    if (swr_init(s) < 0 || !s->native_n_matrix) {
+        fail();
+        goto end;
+    }
+
+    for (i = 0; i < MAX_IN; i++) {
+        randomize_input(src + i * LEN * 4, fmt);
+        in[i] = src + i * LEN * 4;
+    }
+
+    if (check_func(s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f,
+                   "mix_n_1_%s_%dch", av_get_sample_fmt_name(fmt),
+                   av_get_channel_layout_nb_channels(out_layout))) {
+        for (nb_in = 3; nb_in <= MAX_IN; nb_in++) {
+            for (li = 0; li < FF_ARRAY_ELEMS(lens); li++) {
+                memset(dst0, 0, LEN * bps);
+                memset(dst1, 0, LEN * bps);
+                call_ref(dst0, in, s->native_n_matrix, nb_in, lens[li]);
+                call_new(dst1, in, s->native_n_matrix, nb_in, lens[li]);
+                if (memcmp(dst0, dst1, LEN * bps)) {
+                    fprintf(stderr, "mix_n_1: nb_in %d len %d mismatch\n",
+                            nb_in, lens[li]);
+                    fail();
+                    goto end;
+                }
+            }
+        }
+        bench_new(dst1, in, s->native_n_matrix, MAX_IN, LEN);
+    }
+
+end:
+    swr_free(&s);
+}
+
+void checkasm_check_swr_rematrix(void)
+{
+    check_mix_n_1(AV_SAMPLE_FMT_FLTP, AV_CH_LAYOUT_MONO);
+    check_mix_n_1(AV_SAMPLE_FMT_S16P, AV_CH_LAYOUT_MONO);
+    check_mix_n_1(AV_SAMPLE_FMT_S32P, AV_CH_LAYOUT_MONO);
+    report("mix_n_1");
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define DST_LEN 256
+#define MAX_FILTER 160
+#define SRC_LEN (DST_LEN + MAX_FILTER + 16)
+
+static void randomize_input(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    for (i = 0; i < SRC_LEN; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P:
+            ((int16_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            ((float *)buf)[i]   = (int32_t)rnd() / (float)INT32_MAX;
+            break;
+        case AV_SAMPLE_FMT_DBLP:
+            ((double *)buf)[i]  = (int32_t)rnd() / (double)INT32_MAX;
+            break;
+        }
+    }
+}
+
+static int compare_output(const uint8_t *a, const uint8_t *b,
+                          enum AVSampleFormat fmt)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)a, (const float *)b,
+                                         FLT_EPSILON * 64, DST_LEN);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)a, (const double *)b,
+                                          DBL_EPSILON * 16, DST_LEN);
+    default:
+        return memcmp(a, b, DST_LEN * av_get_bytes_per_sample(fmt));
+    }
+}
+
+static void check_resample(enum AVSampleFormat fmt, int filter_size, int linear)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [SRC_LEN * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_LEN * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_LEN * 8]);
+    ResampleContext *c;
+    struct SwrContext *s;
+    int ret0, ret1, index0, frac0;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_MONO, fmt, 48000,
+                           AV_CH_LAYOUT_MONO, fmt, 44100, 0, NULL);
+    if (!s)
+        return;
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0);
+    av_opt_set_int(s, "filter_size", filter_size, 0);
+    av_opt_set_int(s, "linear_interp", linear, 0);
+    if (swr_init(s) < 0 || !s->resample) {
+        fail();
+        goto end;
+    }
+    c = s->resample;
+    if (c->filter_length > MAX_FILTER) {
+        fail();
+        goto end;
+    }
+    /* the initial negative phase is normally resolved by the first convert */
+    c->index = c->frac = 0;
+
+    randomize_input(src, fmt);
+
+    if (check_func(linear ? c->dsp.resample_linear : c->dsp.resample_common,
+                   "resample_%s_%s_%d", linear ? "linear" : "common",
+                   av_get_sample_fmt_name(fmt), c->filter_length)) {
+        memset(dst0, 0, DST_LEN * 8);
+        memset(dst1, 0, DST_LEN * 8);
+        /* the return value is only set when the context is updated */
+        ret0 = call_ref(c, dst0, src, DST_LEN, 1);
+        index0 = c->index;
+        frac0  = c->frac;
+        c->index = c->frac = 0;
+        ret1 = call_new(c, dst1, src, DST_LEN, 1);
+        if (ret0 != ret1 || index0 != c->index || frac0 != c->frac ||
+            compare_output(dst0, dst1, fmt))
+            fail();
+        bench_new(c, dst1, src, DST_LEN, 0);
+    }
+
+end:
+    swr_free(&s);
+}
+
+void checkasm_check_swr_resample(void)
+{
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    static const int filter_sizes[] = { 16, 32, 100, 150 };
+    int i, j;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++)
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++)
+            check_resample(fmts[i], filter_sizes[j], 0);
+    report("resample_common");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++)
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++)
+            check_resample(fmts[i], filter_sizes[j], 1);
+    report("resample_linear");
+}
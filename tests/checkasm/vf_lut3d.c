@@ -0,0 +1,133 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavfilter/lut3d.h"
+
+#include "checkasm.h"
+
+#define WIDTH 256
+#define WIDTH_PADDED (WIDTH + 8)
+#define LUT_SIZE 33
+
+static void randomize_input(uint8_t *buf, int depth, int isfloat)
+{
+    int i;
+
+    for (i = 0; i < WIDTH_PADDED; i++) {
+        if (isfloat) {
+            /* slightly out of range values are clipped to the LUT */
+            ((float *)buf)[i] = (rnd() & 0xFFFF) / 54000.0f - 0.1f;
+        } else if (depth == 8) {
+            buf[i] = rnd();
+        } else {
+            ((uint16_t *)buf)[i] = rnd() & ((1 << depth) - 1);
+        }
+    }
+    if (isfloat) {
+        ((float *)buf)[1] = NAN;
+        ((float *)buf)[2] = INFINITY;
+        ((float *)buf)[3] = 1.0f;
+        ((float *)buf)[4] = 0.0f;
+        ((float *)buf)[5] = -INFINITY;
+        ((float *)buf)[6] = -0.0f;
+    }
+}
+
+static void check_interp(LUT3DContext *s, const char *name, int depth, int isfloat)
+{
+    LOCAL_ALIGNED_32(uint8_t, src_buf,  [3 * WIDTH_PADDED * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_buf, [3 * WIDTH_PADDED * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_buf, [3 * WIDTH_PADDED * 4]);
+    const uint8_t *src[3];
+    uint8_t *dst0[3], *dst1[3];
+    const float lut_max = LUT_SIZE - 1;
+    const float scale[4] = { lut_max, lut_max, lut_max, lut_max };
+    const int bps = isfloat ? 4 : depth > 8 ? 2 : 1;
+    int i;
+
+    declare_func(void, uint8_t *const *dst, const uint8_t *const *src,
+                 const struct rgbvec *lut, const float *scale,
+                 int lutsize, int w);
+
+    ff_lut3d_init(s, depth, isfloat);
+
+    for (i = 0; i < 3; i++) {
+        randomize_input(src_buf + i * WIDTH_PADDED * 4, depth, isfloat);
+        src[i]  = src_buf  + i * WIDTH_PADDED * 4;
+        dst0[i] = dst0_buf + i * WIDTH_PADDED * 4;
+        dst1[i] = dst1_buf + i * WIDTH_PADDED * 4;
+    }
+
+    if (check_func(s->interp_line, "interp_%s_%s%d", name,
+                   isfloat ? "pf" : "p", isfloat ? 32 : depth)) {
+        memset(dst0_buf, 0, 3 * WIDTH_PADDED * 4);
+        memset(dst1_buf, 0, 3 * WIDTH_PADDED * 4);
+        call_ref(dst0, src, s->lut, scale, LUT_SIZE, WIDTH);
+        call_new(dst1, src, s->lut, scale, LUT_SIZE, WIDTH);
+        for (i = 0; i < 3; i++) {
+            /* bitexact, and nothing may be written past the end of the line */
+            if (memcmp(dst0[i], dst1[i], WIDTH_PADDED * bps)) {
+                fail();
+                break;
+            }
+        }
+        bench_new(dst1, src, s->lut, scale, LUT_SIZE, WIDTH);
+    }
+}
+
+void checkasm_check_vf_lut3d(void)
+{
+    static const struct {
+        int interpolation;
+        const char *name;
+    } modes[] = {
+        { INTERPOLATE_TRILINEAR,   "trilinear"   },
+        { INTERPOLATE_TETRAHEDRAL, "tetrahedral" },
+    };
+    static const int depths[] = { 8, 10, 12, 16 };
+    LUT3DContext s = { 0 };
+    struct rgbvec *lut;
+    int i, j;
+
+    lut = av_malloc_array(LUT_SIZE * LUT_SIZE * LUT_SIZE, sizeof(*lut));
+    if (!lut)
+        return;
+    for (i = 0; i < LUT_SIZE * LUT_SIZE * LUT_SIZE; i++) {
+        lut[i].r = (rnd() & 0xFFFF) / 65535.0f;
+        lut[i].g = (rnd() & 0xFFFF) / 65535.0f;
+        lut[i].b = (rnd() & 0xFFFF) / 65535.0f;
+    }
+    s.lut      = lut;
+    s.lutsize  = LUT_SIZE;
+    s.lutsize2 = LUT_SIZE * LUT_SIZE;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(modes); i++) {
+        s.interpolation = modes[i].interpolation;
+        for (j = 0; j < FF_ARRAY_ELEMS(depths); j++)
+            check_interp(&s, modes[i].name, depths[j], 0);
+        check_interp(&s, modes[i].name, 32, 1);
+        report("%s", modes[i].name);
+    }
+
+    av_free(lut);
+}
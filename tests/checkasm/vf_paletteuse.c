@@ -0,0 +1,83 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixfmt.h"
+#include "libavfilter/paletteuse.h"
+
+#include "checkasm.h"
+
+#define NB_TESTS 64
+
+static void randomize_palette(uint32_t *palette, int opaque, int few_colors)
+{
+    int i;
+
+    for (i = 0; i < AVPALETTE_COUNT; i++) {
+        /* few distinct colors to get ties between entries */
+        palette[i] = few_colors ? (rnd() & 0xff000000) | (rnd() & 3) * 0x010101 : rnd();
+        if (opaque)
+            palette[i] |= 0xff000000;
+    }
+}
+
+static void check_nearest_bruteforce(void)
+{
+    static const int thresholds[] = { 0, 1, 128, 255 };
+    LOCAL_ALIGNED_32(uint32_t, palette, [AVPALETTE_COUNT]);
+    PaletteUseDSPContext dsp;
+    int i, j, k;
+
+    declare_func(int, const uint32_t *palette, const uint8_t *argb, int trans_thresh);
+
+    ff_paletteuse_init(&dsp);
+
+    if (check_func(dsp.nearest_bruteforce, "nearest_bruteforce")) {
+        for (i = 0; i < 3; i++) {
+            randomize_palette(palette, i == 0, i == 2);
+            for (j = 0; j < FF_ARRAY_ELEMS(thresholds); j++) {
+                for (k = 0; k < NB_TESTS; k++) {
+                    uint8_t argb[4];
+                    int ref, new;
+
+                    argb[0] = k & 1 ? 0xff : rnd();
+                    argb[1] = i == 2 ? rnd() & 3 : rnd();
+                    argb[2] = i == 2 ? rnd() & 3 : rnd();
+                    argb[3] = i == 2 ? rnd() & 3 : rnd();
+                    ref = call_ref(palette, argb, thresholds[j]);
+                    new = call_new(palette, argb, thresholds[j]);
+                    if (ref != new) {
+                        fprintf(stderr, "nearest_bruteforce: %08x thresh %d: %d != %d\n",
+                                AV_RB32(argb), thresholds[j], ref, new);
+                        fail();
+                        return;
+                    }
+                }
+            }
+        }
+        bench_new(palette, (const uint8_t[]){ 0xff, 0x12, 0x34, 0x56 }, 128);
+    }
+}
+
+void checkasm_check_vf_paletteuse(void)
+{
+    check_nearest_bruteforce();
+    report("nearest_bruteforce");
+}
@@ -122,6 +122,20 @@ FATE_FILTER-$(call ALLYES, FRAMERATE_FILTER TESTSRC2_FILTER FORMAT_FILTER) += fa
 fate-filter-framerate-12bit-up: CMD = framecrc -lavfi testsrc2=r=50:d=1,format=pix_fmts=yuv422p12le,framerate=fps=60 -t 1 -pix_fmt yuv422p12le
 fate-filter-framerate-12bit-down: CMD = framecrc -lavfi testsrc2=r=60:d=1,format=pix_fmts=yuv422p12le,framerate=fps=50 -t 1 -pix_fmt yuv422p12le
 
+DRAWTEXT_GRAPH = testsrc2=r=25:d=1:s=96x48,format=yuv420p,drawtext=fontfile=$(SRC_PATH)/tests/drawtext.bdf:fontsize=12:text=FATE:x=3:y=5:shadowx=2:shadowy=1:box=1:boxborderw=2:boxcolor=blue,drawtext=fontfile=$(SRC_PATH)/tests/drawtext.bdf:fontsize=12:text=%{n}:x=w-tw-1:y=h-th-3:fontcolor=yellow:shadowx=1:shadowy=1
+
+FATE_FILTER-$(call ALLYES, LIBFREETYPE DRAWTEXT_FILTER TESTSRC2_FILTER FORMAT_FILTER) += fate-filter-drawtext fate-filter-drawtext-threads
+fate-filter-drawtext: CMD = framecrc -lavfi $(DRAWTEXT_GRAPH) -pix_fmt yuv420p
+fate-filter-drawtext-threads: CMD = framecrc -filter_complex_threads 4 -lavfi $(DRAWTEXT_GRAPH) -pix_fmt yuv420p
+fate-filter-drawtext-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-drawtext
+
+LUT3D_GRAPH = testsrc2=r=5:d=1:s=100x50,format=$(1),lut3d=file=$(SRC_PATH)/tests/lut3d.cube:interp=$(2)
+
+FATE_FILTER-$(call ALLYES, LUT3D_FILTER TESTSRC2_FILTER FORMAT_FILTER) += fate-filter-lut3d-trilinear fate-filter-lut3d-tetrahedral fate-filter-lut3d-tetrahedral-16bit
+fate-filter-lut3d-trilinear: CMD = framecrc -lavfi $(call LUT3D_GRAPH,gbrp,trilinear) -pix_fmt gbrp
+fate-filter-lut3d-tetrahedral: CMD = framecrc -lavfi $(call LUT3D_GRAPH,gbrp,tetrahedral) -pix_fmt gbrp
+fate-filter-lut3d-tetrahedral-16bit: CMD = framecrc -lavfi $(call LUT3D_GRAPH,gbrp16le,tetrahedral) -pix_fmt gbrp16le
+
 FATE_FILTER-$(call ALLYES, MINTERPOLATE_FILTER TESTSRC2_FILTER) += fate-filter-minterpolate-up fate-filter-minterpolate-down
 fate-filter-minterpolate-up: CMD = framecrc -lavfi testsrc2=r=2:d=10,framerate=fps=10 -t 1
 fate-filter-minterpolate-down: CMD = framecrc -lavfi testsrc2=r=2:d=10,framerate=fps=1 -t 1
@@ -445,6 +459,10 @@ fate-filter-concat: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/d
 fate-filter-concat-vfr: tests/data/filtergraphs/concat-vfr
 fate-filter-concat-vfr: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/concat-vfr
 
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER SPLIT_FILTER HSTACK_FILTER) += fate-filter-split-null-chains
+fate-filter-split-null-chains: tests/data/filtergraphs/split-null-chains
+fate-filter-split-null-chains: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/split-null-chains
+
 FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER FPS_FILTER MPDECIMATE_FILTER) += fate-filter-mpdecimate
 fate-filter-mpdecimate: CMD = framecrc -lavfi testsrc2=r=2:d=10,fps=3,mpdecimate -r 3 -pix_fmt yuv420p
 
@@ -1094,5 +1094,12 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+FATE_SWR_REMATRIX-$(call FILTERDEMDECENCMUX, ARESAMPLE AFORMAT, WAV, PCM_S16LE, PCM_S32LE, FRAMECRC) += fate-swr-rematrix-s32p
+fate-swr-rematrix-s32p: tests/data/asynth-22050-6.wav
+fate-swr-rematrix-s32p: SRC = $(TARGET_PATH)/tests/data/asynth-22050-6.wav
+fate-swr-rematrix-s32p: CMD = framecrc -i $(SRC) -af aformat=s32p,aresample=ocl=mono:internal_sample_fmt=s32p -c:a pcm_s32le
+
+FATE_SWR += $(FATE_SWR_REMATRIX-yes)
 FATE_FFMPEG += $(FATE_SWR)
 fate-swr: $(FATE_SWR)